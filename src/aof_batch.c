@@ -16,6 +16,12 @@
 /* ─── configuration ───────────────────────────── */
 #define DEFAULT_RING_CAP (1 << 15)            /* 32 k entries */
 
+/* A batch frame has the record layout with this bit set in its size:
+ * id holds the record count, data the records as id|size|bytes, and
+ * the one CRC covers them all.                                       */
+#define AOF_BATCH_FLAG   0x80000000u
+#define AOF_LEN(size)    ((size) & ~AOF_BATCH_FLAG)
+
 /* ─── types / globals ─────────────────────────── */
 typedef struct { int id; uint32_t sz; void *data; } aof_cmd_t;
 
@@ -31,6 +37,15 @@ static int            mode_always = 0;
 static pthread_t      writer;
 static int            running = 0;
 
+/* online rewrite: appends made meanwhile, framed like the file */
+static FILE          *rw_out;                 /* new log being written */
+static char           rw_path[512];
+static int            rw_active;              /* atomic: loops append  */
+static char          *rw_buf;
+static size_t         rw_len, rw_cap;
+static int            rw_failed;              /* a capture was lost: no commit */
+static pthread_mutex_t rw_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /* ─── CRC helper ──────────────────────────────── */
 static int safe_write(int fd, const void *buf, size_t len)
 {
@@ -43,12 +58,12 @@ int aof_write_record(int fd, int id,
 {
     if (safe_write(fd,&id,4)         ||
         safe_write(fd,&size,4)       ||
-        safe_write(fd,data,size))
+        safe_write(fd,data,AOF_LEN(size)))
         return -1;
 
     uint32_t crc = crc32c(0,&id,4);
     crc = crc32c(crc,&size,4);
-    crc = crc32c(crc,data,size);
+    crc = crc32c(crc,data,AOF_LEN(size));
     return safe_write(fd,&crc,4);
 }
 
@@ -93,11 +108,11 @@ void AOF_init(const char *path,
     flush_ms    = mode_always ? 1000 : interval_ms;
     g_path      = strdup(path);
 
+    pthread_mutex_init(&lock, NULL);
     if (!mode_always) {
         cap = 1; while (cap < ring_capacity) cap <<= 1;
         mask = cap - 1;
         ring = calloc(cap, sizeof *ring);
-        pthread_mutex_init(&lock, NULL);
         pthread_cond_init(&cond, NULL);
     }
 
@@ -112,16 +127,30 @@ void AOF_init(const char *path,
     }
 }
 
-int AOF_append(int id, const void *data, size_t size) {
+static void rw_capture(int id, const void *data, uint32_t size);
+
+/* one frame (record or batch); `owned` is a malloc'd `data` the ring may
+ * keep instead of copying it, NULL to copy */
+static int append_frame(int id, const void *data, uint32_t size, void *owned)
+{
+    if (__atomic_load_n(&rw_active, __ATOMIC_ACQUIRE))
+        rw_capture(id, data, size);
+
     if (mode_always) {
-        if (aof_write_record(fd, id, data, (uint32_t) size) == -1)
-            return -1;
-        fsync(fd);
-        return 0;
+        /* several loop threads may append: one record at a time */
+        pthread_mutex_lock(&lock);
+        int rc = aof_write_record(fd, id, data, size);
+        if (rc == 0) fsync(fd);
+        pthread_mutex_unlock(&lock);
+        free(owned);
+        return rc;
     }
 
-    void *copy = malloc(size);
-    memcpy(copy, data, size);
+    void *copy = owned;
+    if (!copy) {
+        copy = malloc(size);
+        if (size) memcpy(copy, data, size);
+    }
 
     pthread_mutex_lock(&lock);
     size_t nxt = (head + 1) & mask;
@@ -129,13 +158,65 @@ int AOF_append(int id, const void *data, size_t size) {
         pthread_cond_wait(&cond, &lock);
         nxt = (head + 1) & mask;
     }
-    ring[head] = (aof_cmd_t) {id, (uint32_t) size, copy};
+    ring[head] = (aof_cmd_t) {id, size, copy};
     head = nxt;
     pthread_cond_signal(&cond);
     pthread_mutex_unlock(&lock);
     return 0;
 }
 
+int AOF_append(int id, const void *data, size_t size) {
+    return append_frame(id, data, (uint32_t) size, NULL);
+}
+
+int AOF_append_batch(const aof_rec_t *recs, size_t n) {
+    size_t len = 0;
+    for (size_t i = 0; i < n; i++) len += 8 + recs[i].size;
+    if (n == 0 || n > INT32_MAX || len >= AOF_BATCH_FLAG) return -1;
+
+    char *frame = malloc(len), *p = frame;
+    if (!frame) return -1;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t size = (uint32_t) recs[i].size;
+        memcpy(p, &recs[i].id, 4);   p += 4;
+        memcpy(p, &size, 4);         p += 4;
+        if (size) memcpy(p, recs[i].data, size);
+        p += size;
+    }
+    return append_frame((int) n, frame, (uint32_t) len | AOF_BATCH_FLAG, frame);
+}
+
+/* a batch frame may be larger than one read() returns */
+static int read_full(int rfd, void *buf, size_t len)
+{
+    for (size_t off = 0; off < len; ) {
+        ssize_t n = read(rfd, (char *)buf + off, len - off);
+        if (n <= 0) return -1;
+        off += (size_t)n;
+    }
+    return 0;
+}
+
+/* the records of a batch frame, in order; with st == NULL only checks
+ * that `count` records fill the frame exactly */
+static int replay_batch(Storage *st, int count, const char *p, size_t len)
+{
+    const char *end = p + len;
+    for (int i = 0; i < count; i++) {
+        int rid; uint32_t rsize;
+        if (end - p < 8) return -1;
+        memcpy(&rid, p, 4);
+        memcpy(&rsize, p + 4, 4);
+        p += 8;
+        if ((size_t)(end - p) < rsize) return -1;
+        if (!st) { p += rsize; continue; }
+        if (rsize == 0) storage_remove(st, rid);
+        else storage_save(st, rid, p, rsize);
+        p += rsize;
+    }
+    return p == end ? 0 : -1;
+}
+
 /* replay - FIXED: open separate read fd */
 void AOF_load(Storage *st)
 {
@@ -153,17 +234,25 @@ void AOF_load(Storage *st)
     while (read(read_fd, &id, 4) == 4) {
         if (read(read_fd, &size, 4) != 4) goto corrupt;
 
-        void *buf = malloc(size);
-        if (read(read_fd, buf, size) != (ssize_t)size) goto corrupt;
+        void *buf = malloc(AOF_LEN(size));
+        if (read_full(read_fd, buf, AOF_LEN(size)) != 0) goto corrupt;
 
         if (read(read_fd, &crc_file, 4) != 4) goto corrupt;
 
         uint32_t crc = crc32c(0, &id, 4);
         crc = crc32c(crc, &size, 4);
-        crc = crc32c(crc, buf, size);
+        crc = crc32c(crc, buf, AOF_LEN(size));
         if (crc != crc_file) goto corrupt;
 
-        storage_save(st, id, buf, size);
+        if (size & AOF_BATCH_FLAG) {
+            /* checked as a whole first: all of its records, or none */
+            if (replay_batch(NULL, id, buf, AOF_LEN(size)) < 0) goto corrupt;
+            replay_batch(st, id, buf, AOF_LEN(size));
+        } else if (size == 0) {
+            storage_remove(st, id);                 /* removal record */
+        } else {
+            storage_save(st, id, buf, size);
+        }
         free(buf);
     }
     close(read_fd);
@@ -233,15 +322,160 @@ void AOF_rewrite(Storage *st)
     printf("✓ AOF rewrite complete\n");
 }
 
+/* ─── online rewrite (compaction off the loop) ── */
+static int rw_put(FILE *out, int id, const void *data, uint32_t size)
+{
+    uint32_t crc = crc32c(0, &id, 4);
+    crc = crc32c(crc, &size, 4);
+    crc = crc32c(crc, data, AOF_LEN(size));
+
+    return (fwrite(&id, 4, 1, out)       != 1 ||
+            fwrite(&size, 4, 1, out)     != 1 ||
+            fwrite(data, 1, size, out)   != size ||
+            fwrite(&crc, 4, 1, out)      != 1) ? -1 : 0;
+}
+
+static void rw_capture(int id, const void *data, uint32_t size)
+{
+    uint32_t len = AOF_LEN(size);
+    size_t need = 12 + (size_t)len;
+
+    pthread_mutex_lock(&rw_lock);
+    if (rw_len + need > rw_cap) {
+        size_t ncap = rw_cap ? rw_cap : 1 << 16;
+        while (ncap < rw_len + need) ncap *= 2;
+        char *nbuf = realloc(rw_buf, ncap);
+        if (!nbuf) { rw_failed = 1; pthread_mutex_unlock(&rw_lock); return; }
+        rw_buf = nbuf; rw_cap = ncap;
+    }
+    uint32_t crc = crc32c(0, &id, 4);
+    crc = crc32c(crc, &size, 4);
+    crc = crc32c(crc, data, len);
+
+    char *p = rw_buf + rw_len;
+    memcpy(p, &id, 4);       p += 4;
+    memcpy(p, &size, 4);     p += 4;
+    if (len) memcpy(p, data, len);
+    p += len;
+    memcpy(p, &crc, 4);
+    rw_len += need;
+    pthread_mutex_unlock(&rw_lock);
+}
+
+int AOF_rewrite_begin(void)
+{
+    /* one at a time, until the last one's worker closed its file */
+    if (__atomic_load_n(&rw_out, __ATOMIC_ACQUIRE)) return 1;
+
+    snprintf(rw_path, sizeof rw_path, "%s.rewrite.tmp", g_path);
+    int nfd = open(rw_path, O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, 0600);
+    rw_out = nfd < 0 ? NULL : fdopen(nfd, "wb");
+    if (!rw_out) {
+        perror("AOF_rewrite_begin/open");
+        if (nfd >= 0) close(nfd);
+        return -1;
+    }
+
+    rw_len = 0;
+    rw_failed = 0;
+    __atomic_store_n(&rw_active, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int AOF_rewrite_record(int id, const void *data, size_t size)
+{
+    return rw_put(rw_out, id, data, (uint32_t)size);
+}
+
+int AOF_rewrite_catch_up(void)
+{
+    /* take what was captured so far; later appends go to a fresh buffer */
+    pthread_mutex_lock(&rw_lock);
+    char  *buf = rw_buf;
+    size_t len = rw_len;
+    int    lost = rw_failed;
+    rw_buf = NULL;
+    rw_len = rw_cap = 0;
+    pthread_mutex_unlock(&rw_lock);
+
+    int rc = (lost || (len && fwrite(buf, 1, len, rw_out) != len)) ? -1 : 0;
+    free(buf);
+    if (rc == 0 && (fflush(rw_out) || fsync(fileno(rw_out)))) rc = -1;
+    return rc;
+}
+
+int AOF_rewrite_end(int commit)
+{
+    __atomic_store_n(&rw_active, 0, __ATOMIC_RELEASE);
+
+    /* the tail: appends since the last catch-up (a few, normally) */
+    pthread_mutex_lock(&rw_lock);
+    if (rw_failed) commit = 0;
+    if (commit && rw_len && fwrite(rw_buf, 1, rw_len, rw_out) != rw_len) commit = 0;
+    free(rw_buf);
+    rw_buf = NULL;
+    rw_len = rw_cap = 0;
+    pthread_mutex_unlock(&rw_lock);
+
+    /* durable before it replaces a log whose records were already synced */
+    if (commit && (fflush(rw_out) != 0 || fsync(fileno(rw_out)) != 0)) commit = 0;
+    if (!commit) { unlink(rw_path); return -1; }
+
+    /* what is still queued is in the capture too: it finishes the old file */
+    pthread_mutex_lock(&lock);
+    if (!mode_always) {
+        while (head != tail) {
+            aof_cmd_t *c = &ring[tail];
+            aof_write_record(fd, c->id, c->data, c->sz);
+            free(c->data); tail = (tail + 1) & mask;
+        }
+    }
+
+    int rc = 0;
+    if (rename(rw_path, g_path) != 0) {
+        perror("AOF_rewrite_end/rename");
+        unlink(rw_path);
+        rc = -1;
+    } else {
+        int nfd = open(g_path, O_APPEND | O_WRONLY | O_CLOEXEC, 0600);
+        if (nfd < 0) { perror("re-open AOF"); exit(1); }
+        close(fd);
+        fd = nfd;
+    }
+
+    pthread_mutex_unlock(&lock);
+    return rc;
+}
+
+void AOF_rewrite_close(void)
+{
+    if (!rw_out) return;
+    fclose(rw_out);
+    __atomic_store_n(&rw_out, NULL, __ATOMIC_RELEASE);
+}
+
 /* ─── shutdown ─────────────────────────────── */
 void AOF_shutdown(void)
 {
-    if (mode_always) { if (fd!=-1) close(fd); return; }
+    if (mode_always) {
+        if (fd!=-1) close(fd);
+        pthread_mutex_destroy(&lock);
+        return;
+    }
 
     running = 0;
     pthread_cond_signal(&cond);
     pthread_join(writer, NULL);
 
+    /* the writer may have left between passes: what it did not get to */
+    while (head != tail) {
+        aof_cmd_t *c = &ring[tail];
+        aof_write_record(fd, c->id, c->data, c->sz);
+        free(c->data);
+        tail = (tail + 1) & mask;
+    }
+    fsync(fd);
+
     pthread_mutex_destroy(&lock);
     pthread_cond_destroy(&cond);
     free(ring);
@@ -15,12 +15,46 @@ void AOF_init(const char *path,
 /// Synchronously replay the existing AOF file into `storage`.
 void AOF_load(struct Storage *storage);
 
-/// Enqueue one command (id + data blob) for batched fsync.
+/// Enqueue one command (id + data blob) for batched fsync.  A record
+/// with size 0 (data may be NULL) logs the removal of `id`.
 int AOF_append(int id, const void *data, size_t size);
 
+/// One record of a batch (size 0: removal, as for AOF_append)
+typedef struct {
+    int         id;
+    const void *data;
+    size_t      size;
+} aof_rec_t;
+
+/// Enqueue `n` records as one frame under a single CRC: one copy, one
+/// write, and replay applies all of them or none.  -1 if the batch is
+/// empty, 2 GB or more, or out of memory.
+int AOF_append_batch(const aof_rec_t *recs, size_t n);
+
 /// Flush any pending entries, stop the writer thread, close the file.
 void AOF_shutdown(void);
 
+/// Rewrite the log from `storage` in one go (blocks the caller throughout).
 void AOF_rewrite(Storage *storage);
 
+/// Online rewrite, for a compaction running off the event loop:
+///   AOF_rewrite_begin()    – loop thread: open the new log and capture
+///                            every AOF_append from here on; 1 while
+///                            the last rewrite is still open, -1 if the
+///                            new log cannot be opened
+///   AOF_rewrite_record()   – worker: one entry of the state as of begin
+///   AOF_rewrite_catch_up() – worker: move the capture so far into the
+///                            new log and fsync it
+///   AOF_rewrite_end()      – loop thread: append and fsync the rest of
+///                            the capture, then swap the new log in
+///                            (commit != 0), or drop it; -1 if the old
+///                            log stays
+///   AOF_rewrite_close()    – worker: close the new log
+/// Only the end step, a short tail write and sync, runs on the loop.
+int  AOF_rewrite_begin(void);
+int  AOF_rewrite_record(int id, const void *data, size_t size);
+int  AOF_rewrite_catch_up(void);
+int  AOF_rewrite_end(int commit);
+void AOF_rewrite_close(void);
+
 #endif // AOF_BATCH_H
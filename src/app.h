@@ -10,6 +10,8 @@ typedef struct App {
     Storage        *storage;
     void          (*get)     (struct App*, const char*, RouteHandler);
     void          (*post)    (struct App*, const char*, RouteHandler);
+    /// POST route whose handler blocks (ROUTE_BLOCKING): runs off the loop
+    void          (*post_blocking)(struct App*, const char*, RouteHandler);
     void          (*start)   (struct App*, int port);
     void          (*shutdown)(void);             // call Persistence_shutdown()
 } App;
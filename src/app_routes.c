@@ -7,6 +7,8 @@
 #include "aof_batch.h"
 #include "fast_json.h"
 #include "router.h"
+#include "http_server.h"
+#include "slab_alloc.h"
 
 extern App *g_app;
 
@@ -33,62 +35,62 @@ static inline void response_ensure_capacity(fast_response_t* res, size_t needed)
 // Lightning-Fast Route Handlers
 // ═══════════════════════════════════════════════════════════════════════════════
 
-// POST /users → create or update a user (sub-100μs target)
-int create_user_fast(Request *req, Response *res) {
-    // Parse JSON using zero-copy parser
-    json_value_t* root = json_parse(req->body, strlen(req->body));
-    if (!root || root->type != JSON_OBJECT) {
-        const char* error = "{\"error\":\"Invalid JSON\"}";
-        size_t error_len = strlen(error);
-        memcpy(res->buffer, error, error_len);
-        res->buffer[error_len] = '\0';
-        if (root) json_free(root);
-        return -1;
-    }
+// Longest serialize_user_fast() output: {"id":-2147483648,"name":"<name>"}
+#define USER_JSON_MAX (32 + MAX_NAME_LEN)
+
+// GET /users?cursor=&limit= page size
+#define USERS_PAGE_DEFAULT 100
+#define USERS_PAGE_MAX     1000
+
+// {"id":<int>,"name":<string>} → u (names longer than the field are cut)
+static int user_from_json(json_value_t* obj, User* u) {
+    if (obj->type != JSON_OBJECT) return -1;
 
     // Extract fields using fast lookup
-    json_value_t* id_field = json_get_field(root, "id");
-    json_value_t* name_field = json_get_field(root, "name");
+    json_value_t* id_field = json_get_field(obj, "id");
+    json_value_t* name_field = json_get_field(obj, "name");
 
     if (!id_field || !name_field ||
         id_field->type != JSON_INT ||
         name_field->type != JSON_STRING) {
-        const char* error = "{\"error\":\"Missing or invalid fields\"}";
-        size_t error_len = strlen(error);
-        memcpy(res->buffer, error, error_len);
-        res->buffer[error_len] = '\0';
-        json_free(root);
         return -1;
     }
 
-    // Create user struct
-    User u;
-    u.id = id_field->as.i;
+    u->id = id_field->as.i;
 
     // Copy name (safe bounds checking)
     size_t name_len = name_field->as.s.len;
-    if (name_len >= sizeof(u.name)) name_len = sizeof(u.name) - 1;
-    memcpy(u.name, name_field->as.s.ptr, name_len);
-    u.name[name_len] = '\0';
+    if (name_len >= sizeof(u->name)) name_len = sizeof(u->name) - 1;
+    memcpy(u->name, name_field->as.s.ptr, name_len);
+    u->name[name_len] = '\0';
+    return 0;
+}
+
+// POST /users → create or update a user (sub-100μs target)
+int create_user_fast(Request *req, Response *res) {
+    // Parse JSON using zero-copy parser; nodes live in the request arena
+    json_value_t* root = json_parse_arena(req->body, req->body_len, req->arena);
+    if (!root || root->type != JSON_OBJECT) {
+        response_literal(res, "{\"error\":\"Invalid JSON\"}");
+        return -1;
+    }
+
+    User u;
+    if (user_from_json(root, &u) < 0) {
+        response_literal(res, "{\"error\":\"Missing or invalid fields\"}");
+        return -1;
+    }
 
     // AOF-FIRST: Persist to AOF before memory (ensures durability)
-    if (AOF_append(u.id, &u, sizeof(u)) < 0) {
-        const char *error = "{\"error\":\"Disk full\"}";
-        size_t error_len = strlen(error);
-        memcpy(res->buffer, error, error_len);
-        res->buffer[error_len] = '\0';
-        json_free(root);
+    if (user_save(g_app->storage, &u) < 0) {
+        response_literal(res, "{\"error\":\"Disk full\"}");
         return -3;  // disk full -> HTTP 503
     }
 
-    // Only after AOF success, persist to in-memory storage
-    storage_save(g_app->storage, u.id, &u, sizeof(u));
-
-    // Generate response using template (ultra-fast)
-    size_t response_len = serialize_user_fast(res->buffer, u.id, u.name);
-    res->buffer[response_len] = '\0';
+    // Generate response using template (ultra-fast), straight into the output
+    if (response_reserve(res, USER_JSON_MAX) < 0) return -4;
+    res->len += serialize_user_fast(res->buffer + res->len, u.id, u.name);
 
-    json_free(root);
     return 0;
 }
 
@@ -110,57 +112,151 @@ int get_user_fast(Request *req, Response *res) {
     User u;
     if (storage_get(g_app->storage, id, &u, sizeof(u))) {
         // Template-based serialization
-        size_t len = serialize_user_fast(res->buffer, u.id, u.name);
-        res->buffer[len] = '\0';
-    } else {
-        const char* error = "{\"error\":\"User not found\"}";
-        size_t error_len = strlen(error);
-        memcpy(res->buffer, error, error_len);
-        res->buffer[error_len] = '\0';
+        if (response_reserve(res, USER_JSON_MAX) < 0) return -4;
+        res->len += serialize_user_fast(res->buffer + res->len, u.id, u.name);
+        return 0;
     }
+    response_literal(res, "{\"error\":\"User not found\"}");
+    return -1;
 }
 
-// Context for user iteration
+// State of one streamed GET /users (lives in the request arena)
 typedef struct {
-    char* buffer;
-    char* pos;
-    int first;
-} user_array_ctx_t;
+    size_t cursor;      // storage_scan position
+    int    started;     // '[' written
+    int    first;       // no user written yet
+} user_stream_t;
+
+typedef struct {
+    Response* out;
+    int*      first;
+    size_t    count;     // users written
+    int       overflow;  // a user did not fit in `out`
+} user_list_ctx_t;
 
 static void user_iter_callback(int id, const void* data, size_t size, void* ud) {
+    (void)id;
     (void)size;  // We know it's sizeof(User)
-    user_array_ctx_t* ctx = (user_array_ctx_t*)ud;
+    user_list_ctx_t* ctx = (user_list_ctx_t*)ud;
     const User* user = (const User*)data;
+    Response* res = ctx->out;
 
-    if (!ctx->first) {
-        *ctx->pos++ = ',';
+    // Room for the separator, this user and the closing bracket
+    if (ctx->overflow || response_reserve(res, USER_JSON_MAX + 2) < 0) {
+        ctx->overflow = 1;
+        return;
+    }
+    if (!*ctx->first) {
+        res->buffer[res->len++] = ',';
     } else {
-        ctx->first = 0;
+        *ctx->first = 0;
     }
 
-    // Fast serialization directly into buffer
-    size_t len = serialize_user_fast(ctx->pos, user->id, user->name);
-    ctx->pos += len;
+    // Fast serialization directly into the output
+    res->len += serialize_user_fast(res->buffer + res->len, user->id, user->name);
+    ctx->count++;
 }
 
-// GET /users → list all users (sub-200μs target for 1000 users)
-int list_users_fast(Request *req, Response *res) {
-    (void)req;
+// One chunk of the listing.  The scan hands out whole buckets, so a
+// bucket that no longer fits is rolled back and retried in the next chunk.
+static int user_stream_next(void* state, Response* chunk) {
+    user_stream_t* st = (user_stream_t*)state;
+    user_list_ctx_t ctx = { .out = chunk, .first = &st->first };
+
+    if (!st->started) {
+        chunk->buffer[chunk->len++] = '[';
+        st->started = 1;
+    }
+
+    do {
+        size_t mark = chunk->len;
+        size_t written = ctx.count;
+        int first = st->first;
+
+        size_t next = storage_scan(g_app->storage, st->cursor, 1,
+                                   user_iter_callback, &ctx);
+        if (ctx.overflow) {
+            if (written) {
+                chunk->len = mark;
+                st->first = first;
+                return 1;
+            }
+            // A single bucket larger than a whole chunk takes deliberately
+            // colliding ids; keep what fit rather than stall the stream
+            ctx.overflow = 0;
+        }
+        st->cursor = next;
+    } while (st->cursor != 0);
+
+    chunk->buffer[chunk->len++] = ']';
+    return 0;
+}
 
-    char* p = res->buffer;
-    *p++ = '[';
+// Unsigned decimal query parameter; 0 when absent, -1 when malformed
+static int query_size(const Request* req, const char* name, size_t* out) {
+    size_t len;
+    const char* p = request_query(req, name, &len);
+    if (!p) return 0;
+    if (len == 0 || len > 19) return -1;
+
+    size_t v = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] < '0' || p[i] > '9') return -1;
+        v = v * 10 + (size_t)(p[i] - '0');
+    }
+    *out = v;
+    return 1;
+}
 
-    user_array_ctx_t ctx = {
-            .buffer = res->buffer,
-            .pos = p,
-            .first = 1
-    };
+// GET /users?cursor=X&limit=N → one page: {"users":[...],"cursor":next}.
+// Pass `cursor` back for the next page; 0 means the listing is complete.
+static int list_users_page(Request* req, Response* res) {
+    size_t cursor = 0;
+    size_t limit = USERS_PAGE_DEFAULT;
+    if (query_size(req, "cursor", &cursor) < 0 ||
+        query_size(req, "limit", &limit) < 0 || limit == 0) {
+        response_literal(res, "{\"error\":\"Invalid cursor or limit\"}");
+        return -5;  // -> HTTP 400
+    }
+    if (limit > USERS_PAGE_MAX) limit = USERS_PAGE_MAX;
+
+    int first = 1;
+    user_list_ctx_t ctx = { .out = res, .first = &first };
+    response_literal(res, "{\"users\":[");
+
+    // Whole buckets at a time, so a page can end a user or two past
+    // `limit`; empty buckets count against a budget too, which bounds
+    // the work per request however sparse or large the table is
+    size_t budget = limit * 8;
+    do {
+        cursor = storage_scan(g_app->storage, cursor, 1, user_iter_callback, &ctx);
+    } while (cursor != 0 && ctx.count < limit && --budget);
+
+    if (ctx.overflow || response_reserve(res, 32) < 0) {
+        res->len = 0;
+        return -4;
+    }
+    res->len += (size_t)snprintf(res->buffer + res->len, 32, "],\"cursor\":%zu}", cursor);
+    return 0;
+}
+
+// GET /users → list all users, streamed in chunks: memory per request is
+// constant however large the table is.  With ?cursor= or ?limit= it
+// returns a single page instead.
+int list_users_fast(Request *req, Response *res) {
+    size_t len;
+    if (request_query(req, "cursor", &len) || request_query(req, "limit", &len)) {
+        return list_users_page(req, res);
+    }
 
-    // Single iteration with direct serialization
-    storage_iterate(g_app->storage, user_iter_callback, &ctx);
+    user_stream_t* st = arena_alloc(req->arena, sizeof(*st));
+    if (!st) return -4;
+    st->cursor = 0;
+    st->started = 0;
+    st->first = 1;
 
-    *ctx.pos++ = ']';
-    *ctx.pos = '\0';
+    response_stream(res, user_stream_next, st);
+    return 0;
 }
 
 // Health check optimized for monitoring tools
@@ -171,81 +267,152 @@ int health_fast(Request *req, Response *res) {
     static const char health_response[] = "{\"ok\":1}";
     static const size_t health_len = sizeof(health_response) - 1;
 
-    memcpy(res->buffer, health_response, health_len);
-    res->buffer[health_len] = '\0';
+    response_write(res, health_response, health_len);
+    return 0;
 }
 
-// Admin compaction with progress tracking
+// POST /admin/compact → rewrite RDB + AOF.  Registered ROUTE_BLOCKING: this
+// runs on the thread pool, so the answer can wait for the result.
 int compact_handler_fast(Request *req, Response *res) {
     (void)req;
 
-    // Start compaction in background
-    Persistence_compact();
+    int rc = Persistence_compact();
+    if (rc == 1) {
+        response_literal(res, "{\"error\":\"Snapshot in progress, retry later\"}");
+        return -3;
+    }
+    if (rc != 0) {
+        response_literal(res, "{\"error\":\"Compaction failed\"}");
+        return -4;
+    }
 
-    // Immediate response (don't wait for completion)
-    static const char compact_response[] = "{\"result\":\"compaction_started\",\"async\":true}";
-    static const size_t compact_len = sizeof(compact_response) - 1;
+    response_literal(res, "{\"result\":\"compacted\"}");
+    return 0;
+}
 
-    memcpy(res->buffer, compact_response, compact_len);
-    res->buffer[compact_len] = '\0';
+// GET /admin/snapshot → supervision counters for the periodic RDB snapshot
+int snapshot_stats_fast(Request *req, Response *res) {
+    (void)req;
+
+    snapshot_stats_t s;
+    Persistence_snapshot_stats(&s);
+
+    response_json(res,
+                  "{\"mode\":\"%s\",\"in_progress\":%d,\"child_pid\":%d,\"chain\":%u,"
+                  "\"progress_bytes\":%llu,\"running_us\":%llu,"
+                  "\"started\":%llu,\"succeeded\":%llu,\"failed\":%llu,\"skipped\":%llu,"
+                  "\"last\":{\"kind\":\"%s\",\"status\":%d,\"fork_us\":%llu,\"duration_us\":%llu,"
+                  "\"bytes\":%llu,\"finished\":%lld}}",
+                  s.mode == SNAPSHOT_EPOCH ? "epoch" : "fork",
+                  s.in_progress, s.child_pid, s.chain_len,
+                  (unsigned long long)s.progress_bytes,
+                  (unsigned long long)s.running_us,
+                  (unsigned long long)s.started,
+                  (unsigned long long)s.succeeded,
+                  (unsigned long long)s.failed,
+                  (unsigned long long)s.skipped,
+                  s.last_delta ? "delta" : "full",
+                  s.last_status,
+                  (unsigned long long)s.last_fork_us,
+                  (unsigned long long)s.last_duration_us,
+                  (unsigned long long)s.last_bytes,
+                  (long long)s.last_finished);
+    return 0;
+}
+
+// GET /metrics → allocator usage per size class (classes with no pages
+// omitted), the connection pool and the HTTP traffic counters
+int metrics_fast(Request *req, Response *res) {
+    (void)req;
+
+    slab_stats_t s;
+    slab_stats(&s);
+
+    if (response_reserve(res, RESPONSE_BUFFER_SIZE) < 0) return -4;
+    char  *p   = res->buffer;
+    char  *end = res->buffer + RESPONSE_BUFFER_SIZE;
+    size_t rss = 0;
+    p += snprintf(p, (size_t)(end - p), "{\"slab\":{\"classes\":[");
+    for (unsigned i = 0, first = 1; i < s.nclasses && p < end; i++) {
+        const slab_class_stats_t *c = &s.cls[i];
+        rss += c->bytes;
+        if (!c->pages) continue;
+        p += snprintf(p, (size_t)(end - p),
+                      "%s{\"size\":%zu,\"pages\":%zu,\"live\":%zu,\"free\":%zu,\"bytes\":%zu}",
+                      first ? "" : ",", c->block_size, c->pages,
+                      c->live_blocks, c->free_blocks, c->bytes);
+        first = 0;
+    }
+    if (p < end)
+        p += snprintf(p, (size_t)(end - p),
+                      "],\"page_size\":%zu,\"class_bytes\":%zu,\"arena_pages\":%zu,"
+                      "\"pages_released\":%zu,\"pages_idle\":%zu,"
+                      "\"huge_blocks\":%zu,\"huge_bytes\":%zu}",
+                      s.page_size, rss, s.arena_pages, s.pages_released, s.pages_idle,
+                      s.huge_blocks, s.huge_bytes);
+
+    object_pool_stats_t ps;
+    http_server_pool_stats(&ps);
+    if (p < end)
+        p += snprintf(p, (size_t)(end - p),
+                      ",\"pools\":{\"connections\":{\"hits\":%llu,\"misses\":%llu,"
+                      "\"drops\":%llu,\"idle\":%d,\"capacity\":%d,\"high_water\":%d}",
+                      (unsigned long long)ps.hits, (unsigned long long)ps.misses,
+                      (unsigned long long)ps.drops,
+                      ps.idle, ps.capacity, ps.high_water);
+
+    http_server_stats_t hs;
+    http_server_get_stats(&hs);
+    if (p < end)
+        p += snprintf(p, (size_t)(end - p),
+                      "},\"http\":{\"requests\":%llu,\"connections\":%llu,\"writes\":%llu,"
+                      "\"bytes_sent\":%llu,\"bytes_received\":%llu",
+                      (unsigned long long)hs.requests, (unsigned long long)hs.connections,
+                      (unsigned long long)hs.writes, (unsigned long long)hs.bytes_sent,
+                      (unsigned long long)hs.bytes_received);
+    if (p < end)
+        p += snprintf(p, (size_t)(end - p), "}}");
+    res->len = p < end ? (size_t)(p - res->buffer) : RESPONSE_BUFFER_SIZE - 1;
+    return 0;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════
 // Batch Operations for Maximum Throughput
 // ═══════════════════════════════════════════════════════════════════════════════
 
-// POST /users/batch → create multiple users in one request
-//int create_users_batch(Request *req, Response *res) {
-//    json_value_t* root = json_parse(req->body, strlen(req->body));
-//    if (!root || root->type != JSON_ARRAY) {
-//        const char* error = "{\"error\":\"Expected array of users\"}";
-//        size_t error_len = strlen(error);
-//        memcpy(res->buffer, error, error_len);
-//        res->buffer[error_len] = '\0';
-//        if (root) json_free(root);
-//        return;
-//    }
-//
-//    size_t created = 0;
-//    size_t errors = 0;
-//
-//    // Process batch
-//    for (size_t i = 0; i < root->as.array.count; i++) {
-//        json_value_t* user_obj = &root->as.array.items[i];
-//        if (user_obj->type != JSON_OBJECT) {
-//            errors++;
-//            continue;
-//        }
-//
-//        json_value_t* id_field = json_get_field(user_obj, "id");
-//        json_value_t* name_field = json_get_field(user_obj, "name");
-//
-//        if (!id_field || !name_field ||
-//            id_field->type != JSON_INT ||
-//            name_field->type != JSON_STRING) {
-//            errors++;
-//            continue;
-//        }
-//
-//        User u;
-//        u.id = id_field->as.i;
-//        size_t name_len = name_field->as.s.len;
-//        if (name_len >= sizeof(u.name)) name_len = sizeof(u.name) - 1;
-//        memcpy(u.name, name_field->as.s.ptr, name_len);
-//        u.name[name_len] = '\0';
-//
-//        storage_save(g_app->storage, u.id, &u, sizeof(u));
-//        AOF_append(u.id, &u, sizeof(u));
-//        created++;
-//    }
-//
-//    // Fast response generation
-//    char* p = res->buffer;
-//    p += sprintf(p, "{\"created\":%zu,\"errors\":%zu}", created, errors);
-//    *p = '\0';
-//
-//    json_free(root);
-//}
+// POST /users/batch → [{"id":..,"name":..}, ...], all or nothing: the
+// whole array is checked first, then logged as one AOF frame (one CRC,
+// one write) and stored in one pass
+int create_users_batch(Request *req, Response *res) {
+    json_value_t* root = json_parse_arena(req->body, req->body_len, req->arena);
+    if (!root || root->type != JSON_ARRAY) {
+        response_literal(res, "{\"error\":\"Expected array of users\"}");
+        return -5;
+    }
+
+    size_t n = root->as.array.count;
+    User* users = n ? arena_alloc(req->arena, n * sizeof(User)) : NULL;
+    if (n && !users) return -4;
+
+    for (size_t i = 0; i < n; i++) {
+        memset(&users[i], 0, sizeof(User));
+        if (user_from_json(&root->as.array.items[i], &users[i]) < 0) {
+            if (response_reserve(res, 64) < 0) return -4;
+            res->len += (size_t)snprintf(res->buffer + res->len, 64,
+                                         "{\"error\":\"Invalid user at index %zu\"}", i);
+            return -5;
+        }
+    }
+
+    if (n && user_save_batch(g_app->storage, users, n) < 0) {
+        response_literal(res, "{\"error\":\"Disk full\"}");
+        return -3;  // nothing stored -> HTTP 503
+    }
+
+    if (response_reserve(res, 32) < 0) return -4;
+    res->len += (size_t)snprintf(res->buffer + res->len, 32, "{\"created\":%zu}", n);
+    return 0;
+}
 
 // ═══════════════════════════════════════════════════════════════════════════════
 // Framework Integration & Route Registration
@@ -261,12 +428,14 @@ void register_application_routes(App *app) {
     app->get(app, "/users/:id", get_user_fast);
     app->get(app, "/users", list_users_fast);
 
-//    // Batch operations for high throughput
-//    app->post(app, "/users/batch", create_users_batch);
+    // Batch operations for high throughput
+    app->post(app, "/users/batch", create_users_batch);
 
     // System routes
     app->get(app, "/health", health_fast);
-    app->post(app, "/admin/compact", compact_handler_fast);
+    app->post_blocking(app, "/admin/compact", compact_handler_fast);
+    app->get(app, "/admin/snapshot", snapshot_stats_fast);
+    app->get(app, "/metrics", metrics_fast);
 }
 
 // Legacy alias for backward compatibility
@@ -0,0 +1,75 @@
+// arena.c
+#include "arena.h"
+#include "slab_alloc.h"
+
+static arena_chunk_t *chunk_new(size_t bytes) {
+    arena_chunk_t *c = slab_alloc(bytes);
+    if (!c) return NULL;
+    c->next = NULL;
+    c->size = bytes - sizeof(arena_chunk_t);
+    return c;
+}
+
+int arena_init(arena_t *a, size_t first_size) {
+    if (first_size < sizeof(arena_chunk_t) + ARENA_ALIGN)
+        first_size = ARENA_FIRST_CHUNK;
+    a->first = chunk_new(first_size);
+    if (!a->first) return -1;
+    a->high_water = 0;
+    a->cur = a->first;
+    a->ptr = a->first->data;
+    a->end = a->first->data + a->first->size;
+    return 0;
+}
+
+void arena_destroy(arena_t *a) {
+    arena_chunk_t *c = a->first;
+    while (c) {
+        arena_chunk_t *next = c->next;
+        slab_free(c);
+        c = next;
+    }
+    a->first = a->cur = NULL;
+    a->ptr = a->end = NULL;
+}
+
+void arena_trim(arena_t *a) {
+    arena_reset(a);
+    arena_chunk_t *c = a->first->next;
+    while (c) {
+        arena_chunk_t *next = c->next;
+        slab_free(c);
+        c = next;
+    }
+    a->first->next = NULL;
+}
+
+/* Chunks stay linked after a reset, so a connection that once needed a
+   big request body finds the space again without asking the slab. */
+void *arena_alloc_slow(arena_t *a, size_t n) {
+    arena_chunk_t *c = a->cur;
+    while (c->next) {
+        c = c->next;
+        if (c->size >= n) goto use;
+    }
+
+    size_t size = c->size * 2;
+    if (size < n) size = n;
+    arena_chunk_t *fresh = chunk_new(size + sizeof(arena_chunk_t));
+    if (!fresh) return NULL;
+    c->next = fresh;
+    c = fresh;
+
+use:
+    a->cur = c;
+    a->ptr = c->data + n;
+    a->end = c->data + c->size;
+    return c->data;
+}
+
+size_t arena_used(const arena_t *a) {
+    size_t used = 0;
+    for (const arena_chunk_t *c = a->first; c != a->cur; c = c->next)
+        used += c->size;
+    return used + (size_t)(a->ptr - a->cur->data);
+}
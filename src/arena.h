@@ -0,0 +1,69 @@
+// arena.h
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Bump-pointer arena for per-request temporaries.  Allocation is a
+/// pointer increment; nothing is freed individually.  arena_reset()
+/// rewinds to the first chunk in O(1) and keeps every chunk for the
+/// next request, so a warmed-up connection allocates nothing at all.
+/// Not thread-safe: one arena per connection, used on its loop thread.
+
+#define ARENA_ALIGN        16
+#define ARENA_FIRST_CHUNK  4096   ///< one slab block, header included
+
+typedef struct arena_chunk {
+    struct arena_chunk *next;
+    size_t              size;    ///< usable bytes in data[]
+    _Alignas(ARENA_ALIGN) char data[];
+} arena_chunk_t;
+
+typedef struct {
+    char          *ptr;          ///< next free byte in cur
+    char          *end;
+    arena_chunk_t *first;        ///< kept across resets
+    arena_chunk_t *cur;
+    size_t         high_water;   ///< most bytes one request has used
+} arena_t;
+
+/// Set up `a` with a first chunk of `first_size` bytes (header included).
+/// Returns 0, or -1 when the chunk cannot be allocated.
+int   arena_init(arena_t *a, size_t first_size);
+
+/// Return every chunk to the slab allocator.
+void  arena_destroy(arena_t *a);
+
+/// Reset, and return every chunk but the first to the slab allocator.
+void  arena_trim(arena_t *a);
+
+/// Slow path of arena_alloc(): move to (or add) a chunk that fits `n`.
+void *arena_alloc_slow(arena_t *a, size_t n);
+
+/// Bytes handed out since the last reset.
+size_t arena_used(const arena_t *a);
+
+/// Allocate `n` bytes aligned to ARENA_ALIGN.  NULL only on OOM.
+static inline void *arena_alloc(arena_t *a, size_t n) {
+    n = (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if ((size_t)(a->end - a->ptr) >= n) {
+        void *p = a->ptr;
+        a->ptr += n;
+        return p;
+    }
+    return arena_alloc_slow(a, n);
+}
+
+/// Forget everything allocated since the last reset.
+static inline void arena_reset(arena_t *a) {
+    if (a->cur != a->first || a->ptr != a->first->data) {
+        size_t used = arena_used(a);
+        if (used > a->high_water) a->high_water = used;
+    }
+    a->cur = a->first;
+    a->ptr = a->first->data;
+    a->end = a->first->data + a->first->size;
+}
+
+#endif // ARENA_H
@@ -0,0 +1,108 @@
+// bin_proto.c
+#include "bin_proto.h"
+#include <string.h>
+
+static Storage *bin_storage = NULL;
+
+void bin_proto_init(Storage *st) {
+    bin_storage = st;
+}
+
+// Header of a response with `payload` bytes to follow; NULL when out of memory
+static char *reply_begin(proto_buf_t *out, const bin_header_t *req,
+                         uint8_t status, uint16_t count, size_t payload) {
+    char *p = proto_buf_reserve(out, sizeof(bin_header_t) + payload);
+    if (!p) return NULL;
+    bin_header_t h = {
+            .len    = (uint32_t)payload,
+            .op     = req->op,
+            .status = status,
+            .count  = count
+    };
+    memcpy(p, &h, sizeof(h));
+    out->len += sizeof(h) + payload;
+    return p + sizeof(h);
+}
+
+static int exec_get(const bin_header_t *h, const char *payload, proto_buf_t *out) {
+    char *p = reply_begin(out, h, BIN_OK, h->count, (size_t)h->count * sizeof(bin_entry_t));
+    if (!p) return -1;
+
+    for (uint16_t i = 0; i < h->count; i++) {
+        int32_t id;
+        memcpy(&id, payload + (size_t)i * sizeof(id), sizeof(id));
+
+        User u;
+        bin_entry_t e;
+        memset(&e, 0, sizeof(e));
+        e.id = id;
+        if (storage_get(bin_storage, id, &u, sizeof(u))) {
+            // Stored names are not padded: copy the string, not the array
+            e.found = 1;
+            memcpy(e.name, u.name, strnlen(u.name, sizeof(u.name) - 1));
+        }
+        memcpy(p + (size_t)i * sizeof(e), &e, sizeof(e));
+    }
+    return 0;
+}
+
+static int exec_set(const bin_header_t *h, const char *payload, proto_buf_t *out) {
+    uint16_t stored = 0;
+    uint8_t status = BIN_OK;
+
+    for (uint16_t i = 0; i < h->count; i++) {
+        User u;
+        memcpy(&u, payload + (size_t)i * sizeof(bin_user_t), sizeof(u));
+        u.name[sizeof(u.name) - 1] = '\0';
+        if (user_save(bin_storage, &u) < 0) {
+            status = BIN_ERR_FULL;
+            break;
+        }
+        stored++;
+    }
+    return reply_begin(out, h, status, stored, 0) ? 0 : -1;
+}
+
+// One complete frame.  -1 only when out of memory.
+static int exec_frame(const bin_header_t *h, const char *payload, proto_buf_t *out) {
+    size_t rec = h->op == BIN_OP_GET ? sizeof(int32_t) :
+                 h->op == BIN_OP_SET ? sizeof(bin_user_t) : 0;
+
+    switch (h->op) {
+    case BIN_OP_PING:
+        if (h->len != 0) break;
+        return reply_begin(out, h, BIN_OK, 0, 0) ? 0 : -1;
+    case BIN_OP_GET:
+    case BIN_OP_SET:
+        if (h->count == 0 || h->count > BIN_MAX_COUNT || h->len != h->count * rec) break;
+        return h->op == BIN_OP_GET ? exec_get(h, payload, out) : exec_set(h, payload, out);
+    default:
+        break;
+    }
+    return reply_begin(out, h, BIN_ERR_FRAME, 0, 0) ? 0 : -1;
+}
+
+ssize_t bin_proto_process(const char *data, size_t len, proto_buf_t *out) {
+    size_t off = 0;
+    while (len - off >= sizeof(bin_header_t)) {
+        bin_header_t h;
+        memcpy(&h, data + off, sizeof(h));
+
+        // Too long to buffer: answer, then close (the stream cannot be resynced cheaply)
+        if (h.len > BIN_MAX_FRAME - sizeof(h)) {
+            reply_begin(out, &h, BIN_ERR_FRAME, 0, 0);
+            return -1;
+        }
+        if (len - off - sizeof(h) < h.len) break;   // rest of the frame is still coming
+
+        if (exec_frame(&h, data + off + sizeof(h), out) < 0) return -1;
+        off += sizeof(h) + h.len;
+    }
+    return (ssize_t)off;
+}
+
+const proto_handler_t bin_proto_handler = {
+        .name        = "Binary",
+        .process     = bin_proto_process,
+        .max_request = BIN_MAX_FRAME
+};
@@ -0,0 +1,77 @@
+// bin_proto.h
+#ifndef BIN_PROTO_H
+#define BIN_PROTO_H
+
+#include <stdint.h>
+#include "proto_server.h"
+#include "storage.h"
+#include "user.h"
+
+/// Compact binary protocol for internal clients (--bin-port): fixed
+/// layouts in host byte order (little-endian on every platform we ship),
+/// no text to parse or format on either side.  Every frame, request or
+/// response, starts with a bin_header_t; `len` counts the bytes after it.
+/// Requests may be pipelined and are answered in order, one response
+/// frame each.
+///
+///   op         request payload          response payload
+///   PING       -                        -
+///   GET        count × int32 id         count × bin_entry_t
+///   SET        count × bin_user_t       -  (count = users stored)
+///
+/// GET and SET take 1..BIN_MAX_COUNT records, so one frame is a
+/// multi-get or multi-set.  SET writes through the same AOF-first path
+/// as POST /users; if the AOF fails part-way the response has status
+/// BIN_ERR_FULL and counts the users stored before it.  A frame with an
+/// unknown op or a payload that does not match `count` is answered with
+/// BIN_ERR_FRAME and skipped; one longer than BIN_MAX_FRAME closes the
+/// connection after that answer.
+
+typedef struct {
+    uint32_t len;      ///< payload bytes after the header
+    uint8_t  op;       ///< BIN_OP_*, echoed in the response
+    uint8_t  status;   ///< BIN_OK / BIN_ERR_* in responses, 0 in requests
+    uint16_t count;    ///< records in the payload
+} bin_header_t;
+
+typedef struct {
+    int32_t id;
+    char    name[MAX_NAME_LEN];   ///< NUL-terminated, NUL-padded
+} bin_user_t;
+
+typedef struct {
+    int32_t id;
+    uint8_t found;                ///< 0: no such user, name is all zero
+    uint8_t pad[3];
+    char    name[MAX_NAME_LEN];
+} bin_entry_t;
+
+enum {
+    BIN_OP_PING = 1,
+    BIN_OP_GET  = 2,
+    BIN_OP_SET  = 3
+};
+
+enum {
+    BIN_OK        = 0,
+    BIN_ERR_FRAME = 1,
+    BIN_ERR_FULL  = 2     ///< AOF refused a write (disk full)
+};
+
+#define BIN_MAX_COUNT 4096
+#define BIN_MAX_FRAME (sizeof(bin_header_t) + BIN_MAX_COUNT * sizeof(bin_user_t))
+
+_Static_assert(sizeof(bin_header_t) == 8, "bin_header_t is 8 bytes on the wire");
+_Static_assert(sizeof(bin_user_t) == 4 + MAX_NAME_LEN, "bin_user_t is packed");
+_Static_assert(sizeof(bin_entry_t) == 8 + MAX_NAME_LEN, "bin_entry_t is packed");
+
+/// Serve frames against `st` (the worker's Storage; writes go through
+/// user_save, so the AOF must be initialised).
+void bin_proto_init(Storage *st);
+
+/// proto_handler_t.process for the binary protocol
+ssize_t bin_proto_process(const char *data, size_t len, proto_buf_t *out);
+
+extern const proto_handler_t bin_proto_handler;
+
+#endif // BIN_PROTO_H
@@ -11,13 +11,24 @@
 
 #include "cluster.h"
 #include "slab_alloc.h"
+#include "hugepage.h"
+#include "numa_topo.h"
 #include "storage.h"
 #include "persistence.h"
 #include "app.h"
 #include "app_routes.h"
+#include "http_server.h"
+#include "bin_proto.h"
+#include "resp_proto.h"
 
 /* configuration exported by main.c */
 extern unsigned g_aof_flush_ms;
+extern snapshot_mode_t g_snapshot_mode;
+extern hugepage_mode_t g_hugepage_mode;
+extern int g_threads;
+extern int g_io_uring;
+extern int g_bin_port;
+extern int g_resp_port;
 
 /* parent-only state */
 static volatile int  cluster_shutdown = 0;
@@ -51,18 +62,43 @@ static void cluster_signal_handler(int sig)
 }
 
 /* ────────── CPU pin helper (worker) ────────── */
-static void setup_cpu_affinity(int wid)
+/* pin to a core chosen by node topology, then keep memory on its node.
+   All loops of a worker share one Storage and slab arena, so they stay
+   on the worker's node; loop 0 sets the policy before slab_init and the
+   loop threads it spawns later inherit it.  The topology is read once in
+   the parent: a pinned thread would see only its own CPU */
+static int worker_id = 0;
+
+static void setup_cpu_affinity(int wid, int index)
 {
-    cpu_set_t set; CPU_ZERO(&set); CPU_SET(wid, &set);
+    int nodes = numa_topo_nodes();
+    int node  = 0;
+    int cpu   = numa_topo_worker_cpu(wid, index, g_threads, &node);
+    if (cpu < 0) cpu = wid * g_threads + index;
+
+    cpu_set_t set; CPU_ZERO(&set); CPU_SET(cpu, &set);
     if (sched_setaffinity(0,sizeof set,&set))
         perror("sched_setaffinity");
     else
-        printf("⚙ Worker %d pinned to CPU core %d\n", wid, wid);
+        printf("⚙ Worker %d loop %d pinned to CPU core %d (node %d/%d)\n",
+               wid, index, cpu, node, nodes);
+
+    /* before slab_init/storage_init: arenas, pools and snapshot children
+       all inherit the policy */
+    if (index == 0 && nodes > 1 && numa_topo_set_local(node) == 0)
+        printf("⚙ Worker %d memory bound to NUMA node %d\n", wid, node);
+}
+
+/* runs first on every extra event-loop thread */
+static void loop_thread_start(int index)
+{
+    setup_cpu_affinity(worker_id, index);
 }
 
 /* ────────── worker bootstrap ────────── */
 static App* init_worker_systems(int wid)
 {
+    hugepage_set_mode(g_hugepage_mode);   /* before any arena is mapped */
     slab_init();
     static Storage storage;
     storage_init(&storage);
@@ -70,7 +106,7 @@ static App* init_worker_systems(int wid)
     const char *aof  = "./append.aof";
     const char *dump = "./dump.rdb";
     if (wid==0) printf("🔧 Using shared AOF: %s (all workers)\n", aof);
-    Persistence_init(dump, aof, &storage, 60, g_aof_flush_ms);
+    Persistence_init(dump, aof, &storage, 60, g_snapshot_mode, g_aof_flush_ms);
 
     App *app = app_create(&storage);
     if (!app) { fprintf(stderr,"❌ app_create failed\n"); return NULL; }
@@ -83,11 +119,24 @@ static App* init_worker_systems(int wid)
 static void run_worker(int wid,int port)
 {
     printf("🏃 Worker %d starting on port %d\n", wid, port);
-    setup_cpu_affinity(wid);
+    worker_id = wid;
+    setup_cpu_affinity(wid, 0);
+    http_server_set_threads(g_threads, loop_thread_start);
+    http_server_set_io(g_io_uring ? HTTP_IO_URING : HTTP_IO_UV);
 
     App *app = init_worker_systems(wid);
     if (!app) exit(1);
 
+    /* binary and Redis protocols on the same loops, Storage and AOF */
+    if (g_bin_port > 0) {
+        bin_proto_init(app->storage);
+        proto_server_add(g_bin_port, &bin_proto_handler);
+    }
+    if (g_resp_port > 0) {
+        resp_proto_init(app->storage);
+        proto_server_add(g_resp_port, &resp_proto_handler);
+    }
+
     struct sigaction sa={0}; sa.sa_handler=SIG_DFL; sigaction(SIGTERM,&sa,NULL);
 
     printf("🚀 Worker %d ready – starting HTTP server …\n", wid);
@@ -121,6 +170,7 @@ static void wait_for_workers(void)
 int start_cluster_with_args(int port,int argc,char **argv)
 {
     worker_count = detect_worker_target(argc, argv);
+    numa_topo_init();                 /* before anything is pinned */
     /* NEW — if caller requests 0 workers, run a single worker in-process */
     if (worker_count == 0) {
         printf("🚀 Single-process mode (no cluster manager)\n");
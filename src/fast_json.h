@@ -18,6 +18,7 @@
 #endif
 
 #include "slab_alloc.h"
+#include "arena.h"
 
 // Add missing function declarations for C99 compatibility
 #ifndef __has_builtin
@@ -195,8 +196,17 @@ typedef struct {
     const char* ptr;
     const char* end;
     size_t      error_pos;
+    arena_t*    arena;      // NULL: nodes come from the slab (json_free)
 } json_parser_t;
 
+static inline void* json_alloc(json_parser_t* p, size_t size) {
+    return p->arena ? arena_alloc(p->arena, size) : slab_alloc(size);
+}
+
+static inline void json_release(json_parser_t* p, void* ptr) {
+    if (!p->arena) slab_free(ptr);
+}
+
 // Skip whitespace using SIMD
 static inline void skip_whitespace(json_parser_t* p) {
     while (p->ptr < p->end) {
@@ -245,7 +255,7 @@ static int parse_array(json_parser_t* p, json_value_t* out) {
 
     // Allocate initial space for array items
     size_t capacity = 8;
-    json_value_t* items = slab_alloc(capacity * sizeof(json_value_t));
+    json_value_t* items = json_alloc(p, capacity * sizeof(json_value_t));
     size_t count = 0;
 
     while (1) {
@@ -258,9 +268,9 @@ static int parse_array(json_parser_t* p, json_value_t* out) {
         // Grow array if needed
         if (count >= capacity) {
             capacity *= 2;
-            json_value_t* new_items = slab_alloc(capacity * sizeof(json_value_t));
+            json_value_t* new_items = json_alloc(p, capacity * sizeof(json_value_t));
             memcpy(new_items, items, count * sizeof(json_value_t));
-            slab_free(items);
+            json_release(p, items);
             items = new_items;
         }
 
@@ -308,7 +318,7 @@ static int parse_object(json_parser_t* p, json_value_t* out) {
 
     // Allocate initial space for key-value pairs
     size_t capacity = 8;
-    json_kv_t* pairs = slab_alloc(capacity * sizeof(json_kv_t));
+    json_kv_t* pairs = json_alloc(p, capacity * sizeof(json_kv_t));
     size_t count = 0;
 
     while (1) {
@@ -337,9 +347,9 @@ static int parse_object(json_parser_t* p, json_value_t* out) {
         // Grow array if needed
         if (count >= capacity) {
             capacity *= 2;
-            json_kv_t* new_pairs = slab_alloc(capacity * sizeof(json_kv_t));
+            json_kv_t* new_pairs = json_alloc(p, capacity * sizeof(json_kv_t));
             memcpy(new_pairs, pairs, count * sizeof(json_kv_t));
-            slab_free(pairs);
+            json_release(p, pairs);
             pairs = new_pairs;
         }
 
@@ -437,7 +447,8 @@ static inline json_value_t* json_parse(const char* input, size_t len) {
             .input = input,
             .ptr = input,
             .end = input + len,
-            .error_pos = 0
+            .error_pos = 0,
+            .arena = NULL
     };
 
     json_value_t* result = slab_alloc(sizeof(json_value_t));
@@ -449,25 +460,49 @@ static inline json_value_t* json_parse(const char* input, size_t len) {
     return result;
 }
 
-static inline void json_free(json_value_t* val) {
-    if (!val) return;
+// Parse with every node carved from `arena`: no json_free, the tree
+// goes away with the next arena_reset()
+static inline json_value_t* json_parse_arena(const char* input, size_t len,
+                                             arena_t* arena) {
+    json_parser_t parser = {
+            .input = input,
+            .ptr = input,
+            .end = input + len,
+            .error_pos = 0,
+            .arena = arena
+    };
+
+    json_value_t* result = arena_alloc(arena, sizeof(json_value_t));
+    if (!result || !parse_value(&parser, result)) {
+        return NULL;
+    }
+
+    return result;
+}
 
+// Release what a value owns; `val` itself lives inside its parent's array
+static inline void json_free_children(json_value_t* val) {
     if (val->type == JSON_OBJECT) {
         for (size_t i = 0; i < val->as.object.count; i++) {
-            json_free(&val->as.object.pairs[i].value);
+            json_free_children(&val->as.object.pairs[i].value);
         }
         if (val->as.object.pairs) {
             slab_free(val->as.object.pairs);
         }
     } else if (val->type == JSON_ARRAY) {
         for (size_t i = 0; i < val->as.array.count; i++) {
-            json_free(&val->as.array.items[i]);
+            json_free_children(&val->as.array.items[i]);
         }
         if (val->as.array.items) {
             slab_free(val->as.array.items);
         }
     }
+}
 
+// Free a tree returned by json_parse
+static inline void json_free(json_value_t* val) {
+    if (!val) return;
+    json_free_children(val);
     slab_free(val);
 }
 
@@ -5,60 +5,103 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
 #include <uv.h>
 #include "http_parser.h"
+#include "arena.h"
+#include "fast_json.h"
 #include "object_pool.h"
 #include "router.h"
 #include "slab_alloc.h"
+#include "storage.h"
+#include "timer_wheel.h"
+#include "uring_net.h"
 
 // ═══════════════════════════════════════════════════════════════════════════════
 // BEAST MODE CONFIGURATION - Tuned for Maximum Performance
 // ═══════════════════════════════════════════════════════════════════════════════
 #define MAX_REQUEST_SIZE     (64 * 1024)     // 64KB max request
-#define MAX_RESPONSE_SIZE    (256 * 1024)    // 256KB max response
-#define CONNECTION_POOL_SIZE  2048           // Pre-allocated connections
-#define BUFFER_POOL_SIZE     4096           // Buffer pool size
+#define MAX_BODY_SIZE        (1024 * 1024)   // Bigger bodies are refused with 413
+#define MAX_RESPONSE_SIZE    (256 * 1024)    // Output buffer per connection (grows on demand)
+#define CONNECTION_POOL_SIZE  2048           // Max idle connection contexts
+#define CONNECTION_POOL_WARM   128           // Contexts built before listening
 #define WORKER_THREADS        16            // Background worker threads
 #define TCP_NODELAY           1             // Disable Nagle's algorithm
 #define TCP_KEEPALIVE         1             // Enable TCP keepalive
 #define SO_REUSEPORT         15            // Linux SO_REUSEPORT
-
-// Pre-computed HTTP headers for ultra-fast responses
-static const char RESPONSE_HEADERS_TEMPLATE[] =
-        "HTTP/1.1 200 OK\r\n"
-        "Date: %s\r\n"
-        "Server: RAMForge-Beast/2.0\r\n"
-        "Content-Type: application/json; charset=utf-8\r\n"
-        "Content-Length: %zu\r\n"
-        "Connection: %s\r\n"
-        "Cache-Control: no-cache\r\n"
-        "Access-Control-Allow-Origin: *\r\n"
-        "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n"
+#define MAX_PIPELINE          32            // Responses batched into one uv_write
+#define OUT_IOV_MAX          (2 * MAX_PIPELINE)  // Header block + rest per response
+#define RESPONSE_HEADER_MAX   96            // Room for Date/length lines in front of a body
+#define STREAM_CHUNK_SIZE    (16 * 1024)     // Body bytes per chunk of a streamed response
+#define CHUNK_HEADER_MAX      10             // "%zx\r\n" for a chunk below 4 GiB
+#define HEADER_TIMEOUT_MS    10000           // Request line + headers must arrive within
+#define IDLE_TIMEOUT_MS      60000           // Connection with no traffic either way
+#define LINGER_TIMEOUT_MS     2000           // Draining input after the last response
+#define TIMEOUT_TICK_MS        500           // Timer wheel resolution
+#define MAX_REQUESTS_PER_CONN 10000          // Then the response says Connection: close
+
+// Pre-computed header blocks, one per status and Connection value.  They
+// go out as their own iovec straight from here; only the Date and the
+// body length follow per response (see finish_response).
+#define HEADER_COMMON \
+        "Server: RAMForge-Beast/2.0\r\n" \
+        "Content-Type: application/json; charset=utf-8\r\n" \
+        "Cache-Control: no-cache\r\n" \
+        "Access-Control-Allow-Origin: *\r\n" \
+        "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n" \
         "Access-Control-Allow-Headers: Content-Type, Authorization\r\n"
-        "\r\n";
-
-// Pre-computed error responses (zero allocation)
-static const char ERROR_404[] =
-        "HTTP/1.1 404 Not Found\r\n"
-        "Content-Type: application/json\r\n"
-        "Content-Length: 25\r\n"
-        "Connection: close\r\n\r\n"
-        "{\"error\":\"Not Found\"}";
-
-static const char ERROR_400[] =
-        "HTTP/1.1 400 Bad Request\r\n"
-        "Content-Type: application/json\r\n"
-        "Content-Length: 27\r\n"
-        "Connection: close\r\n\r\n"
-        "{\"error\":\"Bad Request\"}";
-
-static const char ERROR_500[] =
-        "HTTP/1.1 500 Internal Server Error\r\n"
-        "Content-Type: application/json\r\n"
-        "Content-Length: 34\r\n"
-        "Connection: close\r\n\r\n"
-        "{\"error\":\"Internal Server Error\"}";
+
+#define HEADER_TEMPLATE(status, conn) \
+        { "HTTP/1.1 " status "\r\n" HEADER_COMMON "Connection: " conn "\r\n", \
+          sizeof("HTTP/1.1 " status "\r\n" HEADER_COMMON "Connection: " conn "\r\n") - 1 }
+
+#define HEADER_TEMPLATES(status) \
+        { HEADER_TEMPLATE(status, "close"), HEADER_TEMPLATE(status, "keep-alive") }
+
+typedef struct {
+    const char*  text;
+    unsigned int len;
+} header_template_t;
+
+enum { HDR_200, HDR_204, HDR_400, HDR_404, HDR_405, HDR_408, HDR_413, HDR_417,
+       HDR_500, HDR_503 };
+
+static const header_template_t header_templates[][2] = {
+        [HDR_200] = HEADER_TEMPLATES("200 OK"),
+        [HDR_204] = HEADER_TEMPLATES("204 No Content"),
+        [HDR_400] = HEADER_TEMPLATES("400 Bad Request"),
+        [HDR_404] = HEADER_TEMPLATES("404 Not Found"),
+        [HDR_405] = HEADER_TEMPLATES("405 Method Not Allowed"),
+        [HDR_408] = HEADER_TEMPLATES("408 Request Timeout"),
+        [HDR_413] = HEADER_TEMPLATES("413 Payload Too Large"),
+        [HDR_417] = HEADER_TEMPLATES("417 Expectation Failed"),
+        [HDR_500] = HEADER_TEMPLATES("500 Internal Server Error"),
+        [HDR_503] = HEADER_TEMPLATES("503 Service Unavailable"),
+};
+
+// Interim answer to "Expect: 100-continue"
+static const char CONTINUE_100[] = "HTTP/1.1 100 Continue\r\n\r\n";
+
+static inline int header_template_index(int status_code) {
+    switch (status_code) {
+        case 200: return HDR_200;
+        case 204: return HDR_204;
+        case 400: return HDR_400;
+        case 404: return HDR_404;
+        case 405: return HDR_405;
+        case 408: return HDR_408;
+        case 413: return HDR_413;
+        case 417: return HDR_417;
+        case 503: return HDR_503;
+        default:  return HDR_500;
+    }
+}
 
 // ═══════════════════════════════════════════════════════════════════════════════
 // Lightning-Fast Connection Context with Zero-Copy Buffers
@@ -71,13 +114,18 @@ typedef struct fast_buffer {
 } fast_buffer_t;
 
 typedef struct {
-    uv_write_t req;
+    union {
+        uv_write_t uv;
+        uring_write_t uring;
+    } req;                      // first: the completions cast back to write_req_t
     fast_buffer_t* buffer;
     int keep_alive;
     uint64_t request_id;
 } write_req_t;
 
-typedef struct {
+struct blocking_work;
+
+typedef struct connection_ctx {
     http_parser parser;
     http_parser_settings settings;
 
@@ -87,10 +135,19 @@ typedef struct {
     char* body;
     size_t body_len;
     size_t body_capacity;
+    char* body_inline;          // persistent buffer; bigger bodies go to the arena
 
-    // Connection state
+    // Per-request scratch (body overflow, JSON tree, write_req_t).
+    // Reset once the response is written and no request is mid-parse.
+    arena_t arena;
+    int writes_pending;
+    int in_message;
+
+    // Connection state (the handle lives in the context, so a pooled
+    // context brings its socket storage with it)
+    uv_tcp_t handle;
     uv_tcp_t* client;
-    int msg_complete;
+    uring_conn_t uconn;         // the same for the io_uring backend
     int keep_alive;
     uint64_t request_id;
     uint64_t start_time_ns;
@@ -98,22 +155,109 @@ typedef struct {
     // Pre-allocated response buffer
     fast_buffer_t* response_buf;
 
+    // Responses produced during one loop iteration, sent as one write
+    // from the loop's flush hook (see flush_schedule)
+    uv_buf_t out_iov[OUT_IOV_MAX];
+    int out_count;
+    int flush_queued;
+    struct connection_ctx* flush_prev;
+    struct connection_ctx* flush_next;
+
+    // Streamed (chunked) response in progress.  The next chunk is produced
+    // only when the previous one has been written, and reading/parsing is
+    // paused until the stream ends; bytes already read sit in `stalled`.
+    response_stream_fn stream_fn;
+    void* stream_state;
+    char* stalled;
+    size_t stalled_len;
+
+    // ROUTE_BLOCKING handler running on the thread pool.  It holds the
+    // connection the same way a stream does; a close meanwhile leaves the
+    // context to the completion callback.
+    struct blocking_work* work;
+    int closed_during_work;
+
+    // Header-read deadline while a request line/headers are arriving,
+    // idle deadline otherwise; one wheel per loop drives them all
+    timer_wheel_entry_t timeout;
+    int reading_headers;
+    int reject_status;          // set by a parser callback that refuses the request
+    int lingering;              // FIN sent, draining until EOF or the deadline
+    uv_shutdown_t shutdown_req;
+
+    // Header fields the parser does not interpret itself (Expect)
+    char header_field[16];
+    size_t header_field_len;
+    int header_in_value;
+    int header_is_expect;
+    char expect[32];
+    size_t expect_len;
+
 } connection_ctx_t;
 
 // ═══════════════════════════════════════════════════════════════════════════════
-// Global Performance Monitoring & Pools
+// Per-Loop Performance Monitoring & Pools
 // ═══════════════════════════════════════════════════════════════════════════════
-static object_pool_t* connection_pool = NULL;
-static object_pool_t* buffer_pool = NULL;
-static uv_loop_t* main_loop = NULL;
+// Every event-loop thread has its own pool, read buffer, timers and timer
+// wheel (thread-local), so loops share nothing on the request path; the
+// slab allocator keeps per-thread caches underneath.
+static __thread object_pool_t* connection_pool = NULL;
+static __thread char* loop_read_buf = NULL;
+static __thread uv_loop_t* main_loop = NULL;
+
+// Performance counters, one cache line per loop (summed for reporting).
+// Only the owning loop writes them, other threads read them for /metrics,
+// so every access is a relaxed atomic.
+typedef struct {
+    uint64_t requests;
+    uint64_t connections;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint64_t writes;            // write calls handed to the socket layer
+    object_pool_stats_t pool;   // copy of the connection pool's stats
+} __attribute__((aligned(64))) loop_counters_t;
+
+static loop_counters_t loop_counters[HTTP_MAX_LOOPS];
+static __thread loop_counters_t* counters;
+
+// Copy the pool's stats into this loop's counters (NULL: zero them)
+static void pool_publish(const object_pool_t* pool) {
+    object_pool_stats_t now = { 0 };
+    if (pool) object_pool_stats(pool, &now);
+    __atomic_store_n(&counters->pool.hits, now.hits, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->pool.misses, now.misses, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->pool.drops, now.drops, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->pool.idle, now.idle, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->pool.capacity, now.capacity, __ATOMIC_RELAXED);
+    __atomic_store_n(&counters->pool.high_water, now.high_water, __ATOMIC_RELAXED);
+}
+
+// The connection pool is the loop's own; these keep its published copy current
+static void* conn_pool_get(void) {
+    void* item = object_pool_get(connection_pool);
+    pool_publish(connection_pool);
+    return item;
+}
+
+static void conn_pool_release(void* item) {
+    object_pool_release(connection_pool, item);
+    pool_publish(connection_pool);
+}
 
-// Performance counters (lock-free atomic)
-static volatile uint64_t total_requests = 0;
-static volatile uint64_t active_connections = 0;
-static volatile uint64_t total_bytes_sent = 0;
-static volatile uint64_t total_bytes_received = 0;
+static int loop_count = 1;
+static void (*loop_thread_start)(int index);
+static void (*loop_hooks[HTTP_MAX_LOOP_HOOKS])(uv_loop_t* loop, int index);
+static int loop_hook_count = 0;
+static http_io_t io_backend = HTTP_IO_UV;
 static void write_complete_cb(uv_write_t* req, int status);
 static void connection_close_cb(uv_handle_t* handle);
+static void stream_pump(connection_ctx_t* ctx);
+static void reject_request(connection_ctx_t* ctx, int status_code);
+static void flush_responses(connection_ctx_t* ctx);
+static void conn_timeout_arm(connection_ctx_t* ctx, uint64_t ms);
+static void lingering_close(connection_ctx_t* ctx);
+static void resume_parsing(connection_ctx_t* ctx);
+static void conn_close(connection_ctx_t* ctx);
 
 // High-resolution timing
 static inline uint64_t get_time_ns(void) {
@@ -127,7 +271,12 @@ static inline uint64_t get_time_ns(void) {
 // ═══════════════════════════════════════════════════════════════════════════════
 static fast_buffer_t* buffer_create(size_t size) {
     fast_buffer_t* buf = slab_alloc(sizeof(fast_buffer_t));
+    if (!buf) return NULL;
     buf->data = slab_alloc(size);
+    if (!buf->data) {
+        slab_free(buf);
+        return NULL;
+    }
     buf->len = 0;
     buf->capacity = size;
     buf->ref_count = 1;
@@ -149,35 +298,157 @@ static void buffer_reset(fast_buffer_t* buf) {
 // ═══════════════════════════════════════════════════════════════════════════════
 // Ultra-Fast Date Cache (updates every second)
 // ═══════════════════════════════════════════════════════════════════════════════
-static char cached_date[64];
-static time_t last_date_update = 0;
-static uv_timer_t date_timer;
+static __thread char date_line[64];          // "Date: ...\r\n", ready to copy
+static __thread size_t date_line_len;
+static __thread time_t last_date_update = 0;
+static __thread uv_timer_t date_timer;
 
 static void update_date_cache(uv_timer_t* timer) {
     (void)timer;
     time_t now = time(NULL);
     struct tm tm;
     gmtime_r(&now, &tm);
-    strftime(cached_date, sizeof(cached_date), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    date_line_len = strftime(date_line, sizeof(date_line),
+                             "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &tm);
     last_date_update = now;
 }
 
+// ═══════════════════════════════════════════════════════════════════════════════
+// Slab Reclaim Timer (gives spike memory back once traffic settles)
+// ═══════════════════════════════════════════════════════════════════════════════
+#define SLAB_TRIM_INTERVAL_MS  1000
+#define SLAB_TRIM_IDLE_PASSES  5        // page must stay empty ~5 s
+
+static __thread uv_timer_t slab_trim_timer;
+
+static void slab_trim_cb(uv_timer_t* timer) {
+    (void)timer;
+    slab_trim(SLAB_TRIM_IDLE_PASSES);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// Per-Request Arena Recycling
+// ═══════════════════════════════════════════════════════════════════════════════
+#define BODY_INLINE_SIZE 4096
+
+static void ctx_recycle_arena(connection_ctx_t* ctx) {
+    if (ctx->writes_pending || ctx->in_message || ctx->stream_fn || ctx->work) return;
+    arena_reset(&ctx->arena);
+    ctx->body = ctx->body_inline;
+    ctx->body_capacity = BODY_INLINE_SIZE;
+}
+
 // ═══════════════════════════════════════════════════════════════════════════════
 // Hyper-Optimized HTTP Parser Callbacks
 // ═══════════════════════════════════════════════════════════════════════════════
+static int on_message_begin_cb(http_parser* parser) {
+    connection_ctx_t* ctx = (connection_ctx_t*)parser->data;
+
+    ctx_recycle_arena(ctx);
+    ctx->in_message = 1;
+    ctx->body_len = 0;
+    ctx->body[0] = '\0';
+    ctx->url[0] = '\0';
+    ctx->start_time_ns = get_time_ns();
+
+    // The deadline is not pushed back by each byte that trickles in
+    ctx->reading_headers = 1;
+    conn_timeout_arm(ctx, HEADER_TIMEOUT_MS);
+
+    ctx->header_field_len = 0;
+    ctx->header_in_value = 1;
+    ctx->expect_len = 0;
+    return 0;
+}
+
+// Like header fields, the URL can arrive in pieces split across reads
 static int on_url_cb(http_parser* parser, const char* at, size_t length) {
     connection_ctx_t* ctx = (connection_ctx_t*)parser->data;
 
-    size_t copy_len = length < sizeof(ctx->url) - 1 ? length : sizeof(ctx->url) - 1;
-    memcpy(ctx->url, at, copy_len);
-    ctx->url[copy_len] = '\0';
+    size_t have = strlen(ctx->url);
+    size_t room = sizeof(ctx->url) - 1 - have;
+    size_t copy_len = length < room ? length : room;
+    memcpy(ctx->url + have, at, copy_len);
+    ctx->url[have + copy_len] = '\0';
+
+    return 0;
+}
+
+// Append a piece to a fixed buffer; the length stops at `cap`, which no
+// name or value we look for reaches, so an over-long one matches nothing
+static void append_capped(char* buf, size_t cap, size_t* len, const char* at, size_t length) {
+    size_t room = cap - *len;
+    size_t copy_len = length < room ? length : room;
+    memcpy(buf + *len, at, copy_len);
+    *len += copy_len;
+}
+
+// Field names and values can arrive in pieces split across reads
+static int on_header_field_cb(http_parser* parser, const char* at, size_t length) {
+    connection_ctx_t* ctx = (connection_ctx_t*)parser->data;
+
+    if (ctx->header_in_value) {
+        ctx->header_in_value = 0;
+        ctx->header_field_len = 0;
+    }
+    append_capped(ctx->header_field, sizeof(ctx->header_field), &ctx->header_field_len, at, length);
+    return 0;
+}
+
+static int on_header_value_cb(http_parser* parser, const char* at, size_t length) {
+    connection_ctx_t* ctx = (connection_ctx_t*)parser->data;
 
+    if (!ctx->header_in_value) {
+        ctx->header_in_value = 1;
+        ctx->header_is_expect = ctx->header_field_len == 6 &&
+                                strncasecmp(ctx->header_field, "expect", 6) == 0;
+    }
+    if (ctx->header_is_expect) {
+        append_capped(ctx->expect, sizeof(ctx->expect), &ctx->expect_len, at, length);
+    }
+    return 0;
+}
+
+// Connection semantics (HTTP/1.0, "Connection: close", the per-connection
+// request cap), body size and Expect are settled before any body is read
+static int on_headers_complete_cb(http_parser* parser) {
+    connection_ctx_t* ctx = (connection_ctx_t*)parser->data;
+
+    ctx->reading_headers = 0;
+    conn_timeout_arm(ctx, IDLE_TIMEOUT_MS);
+
+    ctx->keep_alive = http_should_keep_alive(parser) &&
+                      ctx->request_id + 1 < MAX_REQUESTS_PER_CONN;
+
+    // No Content-Length leaves content_length at ULLONG_MAX
+    if (!(parser->flags & F_CHUNKED) && parser->content_length != (uint64_t)-1 &&
+        parser->content_length > MAX_BODY_SIZE) {
+        ctx->reject_status = 413;
+        return -1;
+    }
+
+    if (ctx->expect_len && parser->http_minor >= 1) {
+        if (ctx->expect_len != 12 || strncasecmp(ctx->expect, "100-continue", 12) != 0) {
+            ctx->reject_status = 417;
+            return -1;
+        }
+        // Goes out with this read's batch, ahead of any later response
+        if (ctx->out_count == OUT_IOV_MAX) flush_responses(ctx);
+        ctx->out_iov[ctx->out_count++] =
+                uv_buf_init((char*)CONTINUE_100, sizeof(CONTINUE_100) - 1);
+    }
     return 0;
 }
 
 static int on_body_cb(http_parser* parser, const char* at, size_t length) {
     connection_ctx_t* ctx = (connection_ctx_t*)parser->data;
 
+    // Chunked bodies announce no size up front
+    if (ctx->body_len + length > MAX_BODY_SIZE) {
+        ctx->reject_status = 413;
+        return -1;
+    }
+
     // Grow buffer if needed
     if (ctx->body_len + length >= ctx->body_capacity) {
         size_t new_capacity = ctx->body_capacity * 2;
@@ -185,11 +456,10 @@ static int on_body_cb(http_parser* parser, const char* at, size_t length) {
             new_capacity *= 2;
         }
 
-        char* new_body = slab_alloc(new_capacity);
-        if (ctx->body) {
-            memcpy(new_body, ctx->body, ctx->body_len);
-            slab_free(ctx->body);
-        }
+        // Old copy stays in place until the arena resets
+        char* new_body = arena_alloc(&ctx->arena, new_capacity);
+        if (!new_body) return -1;
+        memcpy(new_body, ctx->body, ctx->body_len);
         ctx->body = new_body;
         ctx->body_capacity = new_capacity;
     }
@@ -198,149 +468,381 @@ static int on_body_cb(http_parser* parser, const char* at, size_t length) {
     ctx->body_len += length;
     ctx->body[ctx->body_len] = '\0';
 
-    total_bytes_received += length;
+    __atomic_fetch_add(&counters->bytes_received, length, __ATOMIC_RELAXED);
     return 0;
 }
 
+static void process_request(connection_ctx_t* ctx);
+
+// Dispatch every message as soon as it is complete, so all requests
+// pipelined into one read get answered (in order)
 static int on_message_complete_cb(http_parser* parser) {
     connection_ctx_t* ctx = (connection_ctx_t*)parser->data;
-    ctx->msg_complete = 1;
 
     // Copy method string
     const char* method_str = http_method_str(parser->method);
     strncpy(ctx->method, method_str, sizeof(ctx->method) - 1);
     ctx->method[sizeof(ctx->method) - 1] = '\0';
 
+    process_request(ctx);
+    conn_timeout_arm(ctx, IDLE_TIMEOUT_MS);
+
+    // A streamed or off-loop response owns the connection until it ends,
+    // and a closing one is the last: hold the pipelined requests behind it
+    if (ctx->stream_fn || ctx->work || !ctx->keep_alive) {
+        http_parser_pause(parser, 1);
+    }
     return 0;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════
-// Memory Allocation Callbacks (Pool-based for Speed)
+// Memory Allocation Callbacks (one shared read buffer per loop)
 // ═══════════════════════════════════════════════════════════════════════════════
+// read_cb feeds every byte to the parser before returning, and the parser
+// callbacks copy out what outlives the read (URL into ctx->url, body into
+// ctx->body/arena).  So no two reads on a loop ever need the buffer at
+// once, and an idle keep-alive connection holds no read memory at all.
 static void alloc_cb(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf) {
     (void)handle;
     (void)suggested_size;
 
-    void* mem = object_pool_get(buffer_pool);
-    if (!mem) {
-        mem = slab_alloc(MAX_REQUEST_SIZE);
+    buf->base = loop_read_buf;
+    buf->len = MAX_REQUEST_SIZE;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// Connection Transport (libuv streams, or io_uring with --io uring)
+// ═══════════════════════════════════════════════════════════════════════════════
+// Everything above the socket is shared; these calls pick the loop's
+// backend, and completions come back through conn_read, write_done,
+// shutdown_done and conn_closed either way.
+static __thread uring_net_t* loop_uring = NULL;    // NULL: libuv streams
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf);
+static void linger_shutdown_cb(uv_shutdown_t* req, int status);
+
+static inline int conn_closing(connection_ctx_t* ctx) {
+    return loop_uring ? uring_conn_closing(&ctx->uconn)
+                      : uv_is_closing((uv_handle_t*)ctx->client);
+}
+
+static void conn_close(connection_ctx_t* ctx) {
+    if (conn_closing(ctx)) return;
+    if (loop_uring) uring_conn_close(&ctx->uconn);
+    else uv_close((uv_handle_t*)ctx->client, connection_close_cb);
+}
+
+static int conn_read_start(connection_ctx_t* ctx) {
+    return loop_uring ? uring_conn_read_start(&ctx->uconn)
+                      : uv_read_start((uv_stream_t*)ctx->client, alloc_cb, read_cb);
+}
+
+static void conn_read_stop(connection_ctx_t* ctx) {
+    if (loop_uring) uring_conn_read_stop(&ctx->uconn);
+    else uv_read_stop((uv_stream_t*)ctx->client);
+}
+
+// The io_uring send keeps its own copy of the iovecs (uv_buf_t has the
+// struct iovec layout on Unix), in the arena right behind the request
+static size_t conn_write_extra(const connection_ctx_t* ctx) {
+    return loop_uring ? (size_t)ctx->out_count * sizeof(struct iovec) : 0;
+}
+
+static int conn_write(connection_ctx_t* ctx, write_req_t* write_req) {
+    __atomic_fetch_add(&counters->writes, 1, __ATOMIC_RELAXED);
+    if (loop_uring) {
+        struct iovec* iov = (struct iovec*)(write_req + 1);
+        memcpy(iov, ctx->out_iov, conn_write_extra(ctx));
+        return uring_conn_write(&ctx->uconn, &write_req->req.uring, iov, ctx->out_count);
     }
+    return uv_write(&write_req->req.uv, (uv_stream_t*)ctx->client,
+                    ctx->out_iov, (unsigned int)ctx->out_count, write_complete_cb);
+}
 
-    buf->base = (char*)mem;
-    buf->len = MAX_REQUEST_SIZE;
+static int conn_shutdown(connection_ctx_t* ctx) {
+    return loop_uring ? uring_conn_shutdown(&ctx->uconn)
+                      : uv_shutdown(&ctx->shutdown_req, (uv_stream_t*)ctx->client,
+                                    linger_shutdown_cb);
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════
 // Lightning-Fast Response Generation
 // ═══════════════════════════════════════════════════════════════════════════════
-static void send_response(connection_ctx_t* ctx, const char* json_data, size_t json_len, int status_code) {
+// Hand every queued response to libuv in one uv_write (one writev)
+static void flush_responses(connection_ctx_t* ctx) {
+    if (ctx->out_count == 0) return;
+
     fast_buffer_t* buf = ctx->response_buf;
-    buffer_reset(buf);
-
-    const char *status_text = (status_code == 200) ? "200 OK" :
-                              (status_code == 404) ? "404 Not Found" :
-                              (status_code == 400) ? "400 Bad Request" :
-                              (status_code == 503) ? "503 Service Unavailable" :
-                              "500 Internal Server Error";
-
-    // Build response in one shot (minimal system calls)
-    int header_len = snprintf(buf->data, buf->capacity,
-                              "HTTP/1.1 %s\r\n"
-                              "Date: %s\r\n"
-                              "Server: RAMForge-Beast/2.0\r\n"
-                              "Content-Type: application/json; charset=utf-8\r\n"
-                              "Content-Length: %zu\r\n"
-                              "Connection: %s\r\n"
-                              "Cache-Control: no-cache\r\n"
-                              "Access-Control-Allow-Origin: *\r\n"
-                              "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n"
-                              "Access-Control-Allow-Headers: Content-Type, Authorization\r\n"
-                              "\r\n",
-                              status_text,
-                              cached_date,
-                              json_len,
-                              ctx->keep_alive ? "keep-alive" : "close"
-    );
-
-    // Append JSON body
-    if (json_data && json_len > 0) {
-        memcpy(buf->data + header_len, json_data, json_len);
-        buf->len = header_len + json_len;
-    } else {
-        buf->len = header_len;
+    size_t bytes = 0;
+    for (int i = 0; i < ctx->out_count; i++) {
+        bytes += ctx->out_iov[i].len;
     }
 
-    // Send response asynchronously
-    write_req_t* write_req = slab_alloc(sizeof(write_req_t));
+    // Send asynchronously (request lives in the arena)
+    write_req_t* write_req = arena_alloc(&ctx->arena, sizeof(write_req_t) + conn_write_extra(ctx));
     write_req->buffer = buf;
-    write_req->keep_alive = ctx->keep_alive;
+    write_req->keep_alive = ctx->keep_alive || ctx->stream_fn || ctx->work;
     write_req->request_id = ctx->request_id;
     buf->ref_count++; // Keep buffer alive during write
+    ctx->writes_pending++;
+
+    int rc = conn_write(ctx, write_req);
+    ctx->out_count = 0;
+    if (rc < 0) {
+        fprintf(stderr, "[HTTP] Write error: %s\n", uv_strerror(rc));
+        buffer_release(buf);
+        ctx->writes_pending--;
+        conn_close(ctx);
+        return;
+    }
 
-    uv_buf_t uv_buf = uv_buf_init(buf->data, buf->len);
-    uv_write((uv_write_t*)write_req, (uv_stream_t*)ctx->client, &uv_buf, 1,
-             (uv_write_cb)write_complete_cb);
+    __atomic_fetch_add(&counters->bytes_sent, bytes, __ATOMIC_RELAXED);
+}
 
-    total_bytes_sent += buf->len;
+// Responses are not written as each read is parsed: the connection joins
+// the loop's flush list, and a check handle (run once per iteration, after
+// every read callback of that iteration) writes each listed connection's
+// queue in one go.  On libuv a connection with nothing in flight tries
+// uv_try_write first; when the kernel takes it all, which is the common
+// case, there is no write_req and no completion to wait for.
+static __thread connection_ctx_t* flush_list = NULL;
+static __thread uv_check_t flush_check;
+
+static void flush_schedule(connection_ctx_t* ctx) {
+    if (ctx->flush_queued || ctx->out_count == 0) return;
+    ctx->flush_queued = 1;
+    ctx->flush_prev = NULL;
+    ctx->flush_next = flush_list;
+    if (flush_list) flush_list->flush_prev = ctx;
+    flush_list = ctx;
 }
 
-static void write_complete_cb(uv_write_t* req, int status) {
-    write_req_t* write_req = (write_req_t*)req;
+static void flush_unlink(connection_ctx_t* ctx) {
+    if (!ctx->flush_queued) return;
+    if (ctx->flush_prev) ctx->flush_prev->flush_next = ctx->flush_next;
+    else flush_list = ctx->flush_next;
+    if (ctx->flush_next) ctx->flush_next->flush_prev = ctx->flush_prev;
+    ctx->flush_queued = 0;
+}
 
-    if (status < 0) {
+// Write synchronously what the socket takes; the rest (or everything, on
+// io_uring or behind an earlier write) goes out through flush_responses
+static void flush_now(connection_ctx_t* ctx) {
+    if (ctx->out_count == 0) return;
+    if (conn_closing(ctx)) {
+        ctx->out_count = 0;
+        return;
+    }
+    // Streams and pooled handlers are paced by write completions
+    if (loop_uring || ctx->writes_pending || ctx->stream_fn || ctx->work) {
+        flush_responses(ctx);
+        return;
+    }
+
+    size_t bytes = 0;
+    for (int i = 0; i < ctx->out_count; i++) {
+        bytes += ctx->out_iov[i].len;
+    }
+    __atomic_fetch_add(&counters->writes, 1, __ATOMIC_RELAXED);
+    int n = uv_try_write((uv_stream_t*)ctx->client, ctx->out_iov, (unsigned int)ctx->out_count);
+    if (n < 0) {
+        // UV_EAGAIN: the socket is full, queue it all
+        flush_responses(ctx);
+        return;
+    }
+    __atomic_fetch_add(&counters->bytes_sent, (uint64_t)n, __ATOMIC_RELAXED);
+
+    if ((size_t)n == bytes) {
+        // What write_done does for a completed write
+        ctx->out_count = 0;
+        if (!ctx->keep_alive) {
+            lingering_close(ctx);
+        } else if (!ctx->reading_headers) {
+            conn_timeout_arm(ctx, IDLE_TIMEOUT_MS);
+        }
+        ctx_recycle_arena(ctx);
+        return;
+    }
+
+    // Partial: drop what was sent and queue the remainder
+    int skip = 0;
+    size_t left = (size_t)n;
+    while (left >= ctx->out_iov[skip].len) {
+        left -= ctx->out_iov[skip].len;
+        skip++;
+    }
+    ctx->out_iov[skip].base += left;
+    ctx->out_iov[skip].len -= left;
+    memmove(ctx->out_iov, ctx->out_iov + skip, (size_t)(ctx->out_count - skip) * sizeof(uv_buf_t));
+    ctx->out_count -= skip;
+    flush_responses(ctx);
+}
+
+static void flush_check_cb(uv_check_t* handle) {
+    (void)handle;
+    while (flush_list) {
+        connection_ctx_t* ctx = flush_list;
+        flush_unlink(ctx);
+        flush_now(ctx);
+    }
+}
+
+// Output space for one more response.  The buffer is rewound when no
+// write references it; if an in-flight write still does and it is full,
+// the connection moves to a fresh buffer (the old one dies with its write).
+static fast_buffer_t* response_space(connection_ctx_t* ctx, size_t need) {
+    fast_buffer_t* buf = ctx->response_buf;
+
+    if (ctx->out_count + 2 > OUT_IOV_MAX || buf->capacity - buf->len < need) {
+        flush_responses(ctx);
+    }
+    if (ctx->out_count == 0 && buf->ref_count == 1) {
+        buffer_reset(buf);
+    }
+    if (buf->capacity - buf->len < need) {
+        fast_buffer_t* fresh = buffer_create(need > MAX_RESPONSE_SIZE ? need : MAX_RESPONSE_SIZE);
+        if (!fresh) return NULL;
+        buffer_release(buf);
+        buf = fresh;
+        ctx->response_buf = buf;
+    }
+    return buf;
+}
+
+// Response.grow: a body outgrew the output buffer.  Queued responses go
+// out first (they point into the old buffer), then the partial body moves
+// once into a buffer big enough.  Rare: only big listings get here.
+static int response_grow(Response* res, size_t need) {
+    connection_ctx_t* ctx = (connection_ctx_t*)res->owner;
+    size_t cap = res->capacity * 2;
+    if (cap < res->len + need) cap = res->len + need;
+
+    flush_responses(ctx);
+    fast_buffer_t* buf = buffer_create(RESPONSE_HEADER_MAX + cap);
+    if (!buf) return -1;
+    memcpy(buf->data + RESPONSE_HEADER_MAX, res->buffer, res->len);
+    buffer_release(ctx->response_buf);
+    ctx->response_buf = buf;
+
+    res->buffer = buf->data + RESPONSE_HEADER_MAX;
+    res->capacity = cap;
+    return 0;
+}
+
+// Queue the prebuilt header block for this status as one iovec, then
+// [Date, length, blank line | body] as another: the short per-response
+// lines are back-filled in the gap reserved in front of the body, so
+// neither the body nor the constant headers are copied.
+static void finish_response(connection_ctx_t* ctx, Response* res, int status_code) {
+    fast_buffer_t* buf = ctx->response_buf;
+    const header_template_t* hdr =
+            &header_templates[header_template_index(status_code)][ctx->keep_alive ? 1 : 0];
+
+    // Streamed bodies have no length up front: chunked transfer encoding
+    char tail[RESPONSE_HEADER_MAX];
+    char* p = tail;
+    memcpy(p, date_line, date_line_len);
+    p += date_line_len;
+    if (res->stream) {
+        memcpy(p, "Transfer-Encoding: chunked\r\n\r\n", 30);
+        p += 30;
+    } else {
+        memcpy(p, "Content-Length: ", 16);
+        p = fast_itoa(p + 16, (int)res->len);
+        memcpy(p, "\r\n\r\n", 4);
+        p += 4;
+    }
+    size_t tail_len = (size_t)(p - tail);
+
+    char* start = res->buffer - tail_len;
+    memcpy(start, tail, tail_len);
+    buf->len = (size_t)(res->buffer + res->len - buf->data);
+
+    // Queue; the loop's flush hook writes the batch (see flush_schedule)
+    ctx->out_iov[ctx->out_count++] = uv_buf_init((char*)hdr->text, hdr->len);
+    ctx->out_iov[ctx->out_count++] =
+            uv_buf_init(start, (unsigned int)(tail_len + res->len));
+}
+
+static void write_done(connection_ctx_t* ctx, write_req_t* write_req, int status) {
+    if (status < 0 && status != UV_ECANCELED) {
         fprintf(stderr, "[HTTP] Write error: %s\n", uv_strerror(status));
     }
 
     // Release buffer
     buffer_release(write_req->buffer);
 
-    if (!write_req->keep_alive) {
-        // Close connection after response
-        uv_close((uv_handle_t*)req->handle, connection_close_cb);
+    if (!write_req->keep_alive && !conn_closing(ctx)) {
+        // Close connection after response (gracefully when it was sent)
+        if (status == 0) {
+            lingering_close(ctx);
+        } else {
+            conn_close(ctx);
+        }
+    }
+
+    // write_req is arena memory: nothing to free, just maybe rewind
+    ctx->writes_pending--;
+
+    if (status == 0 && !ctx->lingering && !conn_closing(ctx)) {
+        // A client that keeps taking our output is not idle
+        if (!ctx->reading_headers) conn_timeout_arm(ctx, IDLE_TIMEOUT_MS);
+
+        // Backpressure: the next chunk of a stream once the socket took the last
+        if (ctx->stream_fn && ctx->writes_pending == 0) {
+            stream_pump(ctx);
+            flush_responses(ctx);
+        }
     }
+    ctx_recycle_arena(ctx);
+}
 
-    slab_free(write_req);
+static void write_complete_cb(uv_write_t* req, int status) {
+    write_done((connection_ctx_t*)req->handle->data, (write_req_t*)req, status);
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════
 // Lightning-Fast Request Processing
 // ═══════════════════════════════════════════════════════════════════════════════
-static void process_request(connection_ctx_t* ctx) {
-    total_requests++;
-
-    // Prepare response buffer - allocate enough space for typical responses
-    char response_json[MAX_RESPONSE_SIZE];
-    response_json[0] = '\0';
+static void blocking_dispatch(connection_ctx_t* ctx, RouteHandler handler,
+                              const Request* req);
 
-    // Route the request using our super-fast router
-    int result = route_request(ctx->method, ctx->url, ctx->body, response_json);
-
-    size_t response_len = strlen(response_json);
+// Status line, fix-ups and headers for a body the handler has written
+static void complete_request(connection_ctx_t* ctx, Response* res, int result) {
     int status_code =
             (result == 0)  ? 200 :
             (result == -1) ? 404 :
             (result == -2) ? 405 :
             (result == -3) ? 503 :
+            (result == -5) ? 400 :
             500;
 
+    if (res->stream) {
+        ctx->stream_fn = res->stream;
+        ctx->stream_state = res->stream_state;
+    }
+
     // Handle empty responses (fix for empty brackets issue!)
-    if (response_len == 0 || strcmp(response_json, "[]") == 0 || strcmp(response_json, "{}") == 0) {
+    if (res->stream) {
+        // body follows in chunks
+    } else if (res->len == 0 ||
+        (res->len == 2 && (memcmp(res->buffer, "[]", 2) == 0 || memcmp(res->buffer, "{}", 2) == 0))) {
+        res->len = 0;
         if (strstr(ctx->url, "/users/") && !strstr(ctx->url, "/users/batch")) {
             // Single user not found
-            strcpy(response_json, "{\"error\":\"User not found\"}");
+            response_literal(res, "{\"error\":\"User not found\"}");
             status_code = 404;
         } else if (strcmp(ctx->url, "/users") == 0) {
             // Empty user list should return empty array, not error
-            strcpy(response_json, "[]");
+            response_literal(res, "[]");
             status_code = 200;
         } else {
-            strcpy(response_json, "{\"error\":\"No content\"}");
+            response_literal(res, "{\"error\":\"No content\"}");
             status_code = 204; // No Content
         }
-        response_len = strlen(response_json);
     }
 
-    send_response(ctx, response_json, response_len, status_code);
+    finish_response(ctx, res, status_code);
 
     // Performance logging for very slow requests (> 1ms)
     uint64_t elapsed = get_time_ns() - ctx->start_time_ns;
@@ -349,68 +851,531 @@ static void process_request(connection_ctx_t* ctx) {
                ctx->method, ctx->url, elapsed / 1000);
     }
 
-    // Reset for next request if keep-alive
-    if (ctx->keep_alive) {
-        ctx->msg_complete = 0;
-        ctx->body_len = 0;
-        ctx->url[0] = '\0';
-        ctx->request_id++;
-        http_parser_init(&ctx->parser, HTTP_REQUEST);
+    // Request temporaries are dead; the arena rewinds once the write lands.
+    // The parser carries on by itself with the next pipelined message.
+    ctx->in_message = 0;
+    ctx->request_id++;
+}
+
+static void process_request(connection_ctx_t* ctx) {
+    __atomic_fetch_add(&counters->requests, 1, __ATOMIC_RELAXED);
+
+    Request req;
+    int flags = 0;
+    RouteHandler handler = route_match(ctx->method, ctx->url, ctx->body, ctx->body_len,
+                                       &ctx->arena, &req, &flags);
+    if (handler && (flags & ROUTE_BLOCKING)) {
+        blocking_dispatch(ctx, handler, &req);
+        if (ctx->work) return;
+    }
+
+    // The handler writes its body straight into the output buffer, behind
+    // room reserved for the headers
+    fast_buffer_t* buf = response_space(ctx, RESPONSE_HEADER_MAX + RESPONSE_BUFFER_SIZE);
+    if (!buf) {
+        fprintf(stderr, "[HTTP] Out of memory for response\n");
+        conn_close(ctx);
+        return;
+    }
+    Response res = {
+            .buffer   = buf->data + buf->len + RESPONSE_HEADER_MAX,
+            .len      = 0,
+            .capacity = buf->capacity - buf->len - RESPONSE_HEADER_MAX,
+            .grow     = response_grow,
+            .owner    = ctx
+    };
+
+    // Route the request using our super-fast router (unmatched requests
+    // go through route_request for the error answer).  A blocking handler
+    // that could not be handed to the pool is never run here.
+    int result;
+    if (handler && (flags & ROUTE_BLOCKING)) {
+        response_literal(&res, "{\"error\":\"Server busy\"}");
+        result = -3;
+    } else if (handler) {
+        result = handler(&req, &res);
+    } else {
+        result = route_request(ctx->method, ctx->url, ctx->body, ctx->body_len,
+                               &ctx->arena, &res);
+    }
+    complete_request(ctx, &res, result);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// Blocking Routes on the Thread Pool
+// ═══════════════════════════════════════════════════════════════════════════════
+// A ROUTE_BLOCKING handler (fsync, a full rewrite) runs on the libuv thread
+// pool, writing into a heap body with scratch from its own arena, so the
+// loop keeps serving every other connection.  Its connection waits like
+// one with a stream: parsing and reading are paused, later pipelined bytes
+// sit in `stalled`, and the answer is copied into the output buffer on the
+// loop once the handler returns.
+typedef struct blocking_work {
+    uv_work_t req;
+    connection_ctx_t* ctx;
+    RouteHandler handler;
+    Request request;
+    Response res;
+    arena_t arena;
+    int result;
+} blocking_work_t;
+
+static int blocking_response_grow(Response* res, size_t need) {
+    size_t cap = res->capacity * 2;
+    if (cap < res->len + need) cap = res->len + need;
+
+    char* grown = realloc(res->buffer, cap);
+    if (!grown) return -1;
+    res->buffer = grown;
+    res->capacity = cap;
+    return 0;
+}
+
+static void blocking_work_free(blocking_work_t* w) {
+    free(w->res.buffer);
+    arena_destroy(&w->arena);
+    free(w);
+}
+
+// Pool thread: the only code here that may block
+static void blocking_work_cb(uv_work_t* req) {
+    blocking_work_t* w = (blocking_work_t*)req->data;
+    w->result = w->handler(&w->request, &w->res);
+}
+
+// Loop thread: answer, then carry on with the connection
+static void blocking_after_cb(uv_work_t* req, int status) {
+    blocking_work_t* w = (blocking_work_t*)req->data;
+    connection_ctx_t* ctx = w->ctx;
+    ctx->work = NULL;
+
+    if (ctx->closed_during_work) {
+        blocking_work_free(w);
+        conn_pool_release(ctx);
+        return;
+    }
+
+    fast_buffer_t* buf = response_space(ctx, RESPONSE_HEADER_MAX + w->res.len);
+    if (!buf) {
+        blocking_work_free(w);
+        conn_close(ctx);
+        return;
     }
+    Response res = {
+            .buffer   = buf->data + buf->len + RESPONSE_HEADER_MAX,
+            .len      = 0,
+            .capacity = buf->capacity - buf->len - RESPONSE_HEADER_MAX,
+            .grow     = response_grow,
+            .owner    = ctx
+    };
+    response_write(&res, w->res.buffer, w->res.len);
+    int result = (status == 0) ? w->result : -3;
+    blocking_work_free(w);
+
+    complete_request(ctx, &res, result);
+    flush_responses(ctx);
+    if (!conn_closing(ctx)) {
+        conn_timeout_arm(ctx, IDLE_TIMEOUT_MS);
+        resume_parsing(ctx);
+    }
+}
+
+// Hand the matched request to the pool.  On failure ctx->work stays NULL
+// and the caller answers 503.
+static void blocking_dispatch(connection_ctx_t* ctx, RouteHandler handler,
+                              const Request* req) {
+    blocking_work_t* w = calloc(1, sizeof(*w));
+    if (!w) return;
+    if (arena_init(&w->arena, ARENA_FIRST_CHUNK) < 0) {
+        free(w);
+        return;
+    }
+    w->res.buffer = malloc(RESPONSE_BUFFER_SIZE);
+    if (!w->res.buffer) {
+        blocking_work_free(w);
+        return;
+    }
+    w->res.capacity = RESPONSE_BUFFER_SIZE;
+    w->res.grow = blocking_response_grow;
+    w->res.owner = w;
+    w->req.data = w;
+    w->ctx = ctx;
+    w->handler = handler;
+    w->request = *req;                  // body stays in the connection
+    w->request.arena = &w->arena;
+
+    ctx->work = w;
+    ctx->closed_during_work = 0;
+    if (uv_queue_work(main_loop, &w->req, blocking_work_cb, blocking_after_cb) < 0) {
+        ctx->work = NULL;
+        blocking_work_free(w);
+        return;
+    }
+
+    // Answers pipelined ahead of this one need not wait for it
+    flush_responses(ctx);
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════
 // Optimized Read Callback with Minimal Allocations
 // ═══════════════════════════════════════════════════════════════════════════════
-static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
-    connection_ctx_t* ctx = (connection_ctx_t*)stream->data;
+static void feed_parser(connection_ctx_t* ctx, const char* data, size_t len) {
+    size_t parsed = http_parser_execute(&ctx->parser, &ctx->settings, data, len);
+
+    enum http_errno err = HTTP_PARSER_ERRNO(&ctx->parser);
+
+    if ((ctx->stream_fn || ctx->work) && err == HPE_PAUSED) {
+        // A stream started or a handler went to the pool: keep what follows
+        // for later, stop reading (TCP flow control pushes back on the
+        // client) and send chunk one
+        if (parsed < len) {
+            ctx->stalled = slab_alloc(len - parsed);
+            if (ctx->stalled) {
+                memcpy(ctx->stalled, data + parsed, len - parsed);
+                ctx->stalled_len = len - parsed;
+            }
+        }
+        conn_read_stop(ctx);
+        if (ctx->stream_fn) stream_pump(ctx);
+        flush_responses(ctx);
+        return;
+    }
+
+    if (err == HPE_PAUSED) {
+        // That response closes the connection: whatever follows is dropped
+        conn_read_stop(ctx);
+        flush_schedule(ctx);
+        return;
+    }
+
+    if (parsed != len || err != HPE_OK) {
+        // Refused by a callback (413/417) or malformed: answer, then close
+        if (!ctx->reject_status) {
+            fprintf(stderr, "[HTTP] Parse error at position %zu: %s\n",
+                    parsed, http_errno_name(err));
+        }
+        reject_request(ctx, ctx->reject_status ? ctx->reject_status : 400);
+        return;
+    }
+
+    // Every complete message was answered from on_message_complete; the
+    // batch goes out with whatever else this loop iteration produces
+    flush_schedule(ctx);
+}
 
+static void conn_read(connection_ctx_t* ctx, ssize_t nread, const char* data) {
     if (nread > 0) {
+        // Lingering after the last response: input is only drained
+        if (ctx->lingering) return;
+
+        // Headers keep their fixed deadline; anything else is activity
+        if (!ctx->reading_headers) conn_timeout_arm(ctx, IDLE_TIMEOUT_MS);
+
         // Feed data to HTTP parser
-        size_t parsed = http_parser_execute(&ctx->parser, &ctx->settings, buf->base, nread);
-
-        if (parsed != (size_t)nread) {
-            // Parse error
-            fprintf(stderr, "[HTTP] Parse error at position %zu\n", parsed);
-            uv_close((uv_handle_t*)stream, connection_close_cb);
-            object_pool_release(buffer_pool, buf->base);
-            return;
+        feed_parser(ctx, data, (size_t)nread);
+
+    } else if (nread < 0) {
+        if (nread != UV_EOF && !ctx->lingering) {
+            fprintf(stderr, "[HTTP] Read error: %s\n", uv_strerror((int)nread));
         }
+        conn_close(ctx);
+    }
+}
+
+static void read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+    conn_read((connection_ctx_t*)stream->data, nread, buf->base);
+}
+
+// The stream is complete: the connection is free for the requests behind it
+static void stream_finish(connection_ctx_t* ctx) {
+    ctx->stream_fn = NULL;
+    ctx->stream_state = NULL;
+    resume_parsing(ctx);
+}
 
-        // Process complete messages
-        if (ctx->msg_complete) {
-            process_request(ctx);
+// A response that held the connection (stream, pooled handler) is done:
+// resume parsing (requests that were pipelined behind it first), then reading
+static void resume_parsing(connection_ctx_t* ctx) {
+    if (!ctx->keep_alive) {
+        // Last response on this connection: it closes once written
+        if (ctx->stalled) {
+            slab_free(ctx->stalled);
+            ctx->stalled = NULL;
+            ctx->stalled_len = 0;
         }
+        return;
+    }
+    http_parser_pause(&ctx->parser, 0);
+
+    if (ctx->stalled) {
+        char* stalled = ctx->stalled;
+        size_t stalled_len = ctx->stalled_len;
+        ctx->stalled = NULL;
+        ctx->stalled_len = 0;
+        feed_parser(ctx, stalled, stalled_len);
+        slab_free(stalled);
+    }
+    if (!ctx->stream_fn && !ctx->work && !conn_closing(ctx) && conn_read_start(ctx) < 0) {
+        conn_close(ctx);
+    }
+}
 
-    } else if (nread < 0) {
-        if (nread != UV_EOF) {
-            fprintf(stderr, "[HTTP] Read error: %s\n", uv_strerror(nread));
+// Produce and queue the next chunk of the running stream (plus the
+// terminating zero-length chunk once the producer is done).  Memory use
+// is one STREAM_CHUNK_SIZE slice of the output buffer, whatever the size
+// of the whole body.
+static void stream_pump(connection_ctx_t* ctx) {
+    fast_buffer_t* buf = response_space(ctx, CHUNK_HEADER_MAX + STREAM_CHUNK_SIZE + 7);
+    if (!buf) {
+        conn_close(ctx);
+        return;
+    }
+
+    Response chunk = {
+            .buffer   = buf->data + buf->len + CHUNK_HEADER_MAX,
+            .len      = 0,
+            .capacity = STREAM_CHUNK_SIZE
+    };
+    int more;
+    do {
+        more = ctx->stream_fn(ctx->stream_state, &chunk);
+    } while (more && chunk.len == 0);
+
+    // Back-fill the chunk size line, then the trailing CRLF (and the end)
+    char* start = chunk.buffer;
+    char* end = chunk.buffer + chunk.len;
+    if (chunk.len) {
+        char size_line[CHUNK_HEADER_MAX + 1];
+        int n = snprintf(size_line, sizeof(size_line), "%zx\r\n", chunk.len);
+        start -= n;
+        memcpy(start, size_line, (size_t)n);
+        memcpy(end, "\r\n", 2);
+        end += 2;
+    }
+    if (!more) {
+        memcpy(end, "0\r\n\r\n", 5);
+        end += 5;
+    }
+    buf->len = (size_t)(end - buf->data);
+    ctx->out_iov[ctx->out_count++] = uv_buf_init(start, (unsigned int)(end - start));
+
+    if (!more) {
+        stream_finish(ctx);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// Refusals and Timeouts
+// ═══════════════════════════════════════════════════════════════════════════════
+// Answer with an error and close once it is written.  Reading stops: the
+// rest of what the client sends is of no interest.
+static void reject_request(connection_ctx_t* ctx, int status_code) {
+    const char* reason = (status_code == 408) ? "Request Timeout" :
+                         (status_code == 413) ? "Payload Too Large" :
+                         (status_code == 417) ? "Expectation Failed" :
+                         "Bad Request";
+
+    ctx->keep_alive = 0;
+    ctx->in_message = 0;
+    conn_read_stop(ctx);
+
+    fast_buffer_t* buf = response_space(ctx, RESPONSE_HEADER_MAX + RESPONSE_BUFFER_SIZE);
+    if (!buf) {
+        conn_close(ctx);
+        return;
+    }
+    Response res = {
+            .buffer   = buf->data + buf->len + RESPONSE_HEADER_MAX,
+            .len      = 0,
+            .capacity = RESPONSE_BUFFER_SIZE
+    };
+    response_json(&res, "{\"error\":\"%s\"}", reason);
+    finish_response(ctx, &res, status_code);
+    flush_responses(ctx);
+}
+
+static __thread timer_wheel_t conn_wheel;
+static __thread uv_timer_t conn_wheel_timer;
+
+static void conn_wheel_tick(uv_timer_t* timer) {
+    (void)timer;
+    timer_wheel_tick(&conn_wheel);
+}
+
+// A slow request line/headers gets a 408 (the close follows the write;
+// the idle deadline covers a write that never drains); an idle
+// connection is simply closed, giving its fd back
+static void conn_timeout_cb(timer_wheel_entry_t* entry) {
+    connection_ctx_t* ctx = (connection_ctx_t*)
+            ((char*)entry - offsetof(connection_ctx_t, timeout));
+    if (conn_closing(ctx)) return;
+
+    // Waiting on our own handler is not the client idling
+    if (ctx->work) {
+        conn_timeout_arm(ctx, IDLE_TIMEOUT_MS);
+        return;
+    }
+
+    if (ctx->reading_headers) {
+        ctx->reading_headers = 0;
+        reject_request(ctx, 408);
+        if (!conn_closing(ctx)) {
+            conn_timeout_arm(ctx, IDLE_TIMEOUT_MS);
         }
-        uv_close((uv_handle_t*)stream, connection_close_cb);
+        return;
+    }
+    conn_close(ctx);
+}
+
+static void conn_timeout_arm(connection_ctx_t* ctx, uint64_t ms) {
+    timer_wheel_schedule(&conn_wheel, &ctx->timeout, ms, conn_timeout_cb);
+}
+
+// FIN is out: read (and discard, see conn_read) until the client's EOF
+static void shutdown_done(connection_ctx_t* ctx, int status) {
+    if (conn_closing(ctx)) return;
+
+    if (status < 0 || conn_read_start(ctx) < 0) {
+        conn_close(ctx);
+        return;
     }
+    conn_timeout_arm(ctx, LINGER_TIMEOUT_MS);
+}
 
-    // Return buffer to pool
-    object_pool_release(buffer_pool, buf->base);
+static void linger_shutdown_cb(uv_shutdown_t* req, int status) {
+    shutdown_done((connection_ctx_t*)req->handle->data, status);
+}
+
+// Closing with unread input (requests pipelined past the last response)
+// makes the kernel send a RST, which can destroy responses the client
+// has not read yet.  Send FIN instead and discard input until the client
+// closes too or the linger deadline passes.
+static void lingering_close(connection_ctx_t* ctx) {
+    if (ctx->lingering) return;
+    ctx->lingering = 1;
+    ctx->reading_headers = 0;
+    conn_timeout_arm(ctx, LINGER_TIMEOUT_MS);
+    if (conn_shutdown(ctx) < 0) {
+        conn_close(ctx);
+    }
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════
 // Connection Management
 // ═══════════════════════════════════════════════════════════════════════════════
-static void connection_close_cb(uv_handle_t* handle) {
-    connection_ctx_t* ctx = (connection_ctx_t*)handle->data;
+// Pool factory: a context carries its parser, body buffer, arena and
+// response buffer from connection to connection
+static void* connection_ctx_create(void) {
+    connection_ctx_t* ctx = slab_alloc(sizeof(connection_ctx_t));
+    if (!ctx) return NULL;
+    memset(ctx, 0, sizeof(connection_ctx_t));
+
+    // Initialize HTTP parser
+    http_parser_init(&ctx->parser, HTTP_REQUEST);
+    http_parser_settings_init(&ctx->settings);
+    ctx->settings.on_message_begin = on_message_begin_cb;
+    ctx->settings.on_url = on_url_cb;
+    ctx->settings.on_header_field = on_header_field_cb;
+    ctx->settings.on_header_value = on_header_value_cb;
+    ctx->settings.on_headers_complete = on_headers_complete_cb;
+    ctx->settings.on_body = on_body_cb;
+    ctx->settings.on_message_complete = on_message_complete_cb;
+    ctx->parser.data = ctx;
+
+    // Allocate buffers
+    ctx->body_capacity = BODY_INLINE_SIZE;
+    ctx->body_inline = slab_alloc(BODY_INLINE_SIZE);
+    ctx->response_buf = buffer_create(MAX_RESPONSE_SIZE);
+    if (!ctx->body_inline || arena_init(&ctx->arena, ARENA_FIRST_CHUNK) < 0) {
+        if (ctx->body_inline) slab_free(ctx->body_inline);
+        buffer_release(ctx->response_buf);
+        slab_free(ctx);
+        return NULL;
+    }
+    ctx->body = ctx->body_inline;
+    ctx->body[0] = '\0';
+    return ctx;
+}
 
-    if (ctx) {
-        if (ctx->body) {
-            slab_free(ctx->body);
-        }
-        if (ctx->response_buf) {
+static void connection_ctx_destroy(void* item) {
+    connection_ctx_t* ctx = (connection_ctx_t*)item;
+    slab_free(ctx->body_inline);
+    arena_destroy(&ctx->arena);
+    buffer_release(ctx->response_buf);
+    slab_free(ctx);
+}
+
+// Pool reset hook: whatever the last connection left behind (a half-parsed
+// request, an arena full of temporaries) must not leak into the next one
+static void connection_ctx_reset(void* item) {
+    connection_ctx_t* ctx = (connection_ctx_t*)item;
+
+    http_parser_init(&ctx->parser, HTTP_REQUEST);
+    ctx->parser.data = ctx;
+    ctx->method[0] = '\0';
+    ctx->url[0] = '\0';
+    ctx->body_len = 0;
+    ctx->writes_pending = 0;
+    ctx->in_message = 0;
+    // Only the first arena chunk stays: one big POST must not pin its
+    // doubling chunks to a pooled context for good
+    arena_trim(&ctx->arena);
+    ctx->body = ctx->body_inline;
+    ctx->body_capacity = BODY_INLINE_SIZE;
+    ctx->body[0] = '\0';
+    ctx->client = NULL;
+    ctx->out_count = 0;
+    ctx->stream_fn = NULL;
+    ctx->stream_state = NULL;
+    ctx->work = NULL;
+    ctx->closed_during_work = 0;
+    if (ctx->stalled) {
+        slab_free(ctx->stalled);
+        ctx->stalled = NULL;
+        ctx->stalled_len = 0;
+    }
+    timer_wheel_cancel(&conn_wheel, &ctx->timeout);
+    ctx->reading_headers = 0;
+    ctx->reject_status = 0;
+    ctx->lingering = 0;
+    ctx->expect_len = 0;
+    ctx->keep_alive = 1;
+    ctx->request_id = 0;
+    ctx->response_buf->len = 0;
+
+    // Drop an output buffer that a big listing grew; the pool keeps
+    // contexts, not outliers
+    if (ctx->response_buf->capacity > MAX_RESPONSE_SIZE) {
+        fast_buffer_t* fresh = buffer_create(MAX_RESPONSE_SIZE);
+        if (fresh) {
             buffer_release(ctx->response_buf);
+            ctx->response_buf = fresh;
         }
-        object_pool_release(connection_pool, ctx);
-        active_connections--;
     }
+}
 
-    slab_free(handle);
+static void conn_closed(connection_ctx_t* ctx) {
+    // Pending writes were cancelled before this callback; a pooled handler
+    // still holds the context until it completes
+    timer_wheel_cancel(&conn_wheel, &ctx->timeout);
+    flush_unlink(ctx);
+    __atomic_fetch_sub(&counters->connections, 1, __ATOMIC_RELAXED);
+    if (ctx->work) {
+        ctx->closed_during_work = 1;
+        return;
+    }
+    conn_pool_release(ctx);
+}
+
+static void connection_close_cb(uv_handle_t* handle) {
+    conn_closed((connection_ctx_t*)handle->data);
+}
+
+// Defaults for a new connection (either backend), before its first read
+static void conn_open(connection_ctx_t* ctx) {
+    ctx->start_time_ns = get_time_ns();
+    ctx->keep_alive = 1; // Default to keep-alive
+    __atomic_fetch_add(&counters->connections, 1, __ATOMIC_RELAXED);
 }
 
 static void accept_connection(uv_stream_t* server, int status) {
@@ -420,27 +1385,14 @@ static void accept_connection(uv_stream_t* server, int status) {
     }
 
     // Get connection context from pool
-    connection_ctx_t* ctx = (connection_ctx_t*)object_pool_get(connection_pool);
+    connection_ctx_t* ctx = (connection_ctx_t*)conn_pool_get();
     if (!ctx) {
-        ctx = slab_alloc(sizeof(connection_ctx_t));
-        memset(ctx, 0, sizeof(connection_ctx_t));
-
-        // Initialize HTTP parser
-        http_parser_init(&ctx->parser, HTTP_REQUEST);
-        http_parser_settings_init(&ctx->settings);
-        ctx->settings.on_url = on_url_cb;
-        ctx->settings.on_body = on_body_cb;
-        ctx->settings.on_message_complete = on_message_complete_cb;
-        ctx->parser.data = ctx;
-
-        // Allocate buffers
-        ctx->body_capacity = 4096;
-        ctx->body = slab_alloc(ctx->body_capacity);
-        ctx->response_buf = buffer_create(MAX_RESPONSE_SIZE);
+        fprintf(stderr, "[HTTP] Out of memory for connection context\n");
+        return;
     }
 
     // Create client socket
-    uv_tcp_t* client = slab_alloc(sizeof(uv_tcp_t));
+    uv_tcp_t* client = &ctx->handle;
     uv_tcp_init(main_loop, client);
 
     // Enable TCP optimizations
@@ -448,22 +1400,67 @@ static void accept_connection(uv_stream_t* server, int status) {
     uv_tcp_keepalive(client, TCP_KEEPALIVE, 60);
 
     ctx->client = client;
-    ctx->start_time_ns = get_time_ns();
-    ctx->keep_alive = 1; // Default to keep-alive
     client->data = ctx;
+    conn_open(ctx);
 
     if (uv_accept(server, (uv_stream_t*)client) == 0) {
-        uv_read_start((uv_stream_t*)client, alloc_cb, read_cb);
-        active_connections++;
+        conn_timeout_arm(ctx, IDLE_TIMEOUT_MS);
+        conn_read_start(ctx);
     } else {
-        uv_close((uv_handle_t*)client, connection_close_cb);
+        conn_close(ctx);
+    }
+}
+
+// io_uring backend: the ring accepted `fd` (multishot) and reports
+// through these, straight into the shared connection code
+static uring_conn_t* uring_accept_cb(uring_net_t* net, int fd) {
+    connection_ctx_t* ctx = (connection_ctx_t*)conn_pool_get();
+    if (!ctx) {
+        fprintf(stderr, "[HTTP] Out of memory for connection context\n");
+        return NULL;
     }
+
+    // Same TCP options as uv_tcp_nodelay/uv_tcp_keepalive
+    int one = 1, idle = 60;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+
+    uring_conn_init(&ctx->uconn, net, fd, ctx);
+    conn_open(ctx);
+    conn_timeout_arm(ctx, IDLE_TIMEOUT_MS);
+    if (conn_read_start(ctx) < 0) conn_close(ctx);
+    return &ctx->uconn;
+}
+
+static void uring_read_cb(uring_conn_t* c, ssize_t nread, const char* data) {
+    conn_read((connection_ctx_t*)c->data, nread, data);
+}
+
+static void uring_written_cb(uring_conn_t* c, uring_write_t* w, int status) {
+    write_done((connection_ctx_t*)c->data, (write_req_t*)w, status);
+}
+
+static void uring_shutdown_cb(uring_conn_t* c, int status) {
+    shutdown_done((connection_ctx_t*)c->data, status);
 }
 
+static void uring_closed_cb(uring_conn_t* c) {
+    conn_closed((connection_ctx_t*)c->data);
+}
+
+static const uring_net_callbacks_t uring_callbacks = {
+    .accept   = uring_accept_cb,
+    .read     = uring_read_cb,
+    .written  = uring_written_cb,
+    .shutdown = uring_shutdown_cb,
+    .closed   = uring_closed_cb
+};
+
 // ═══════════════════════════════════════════════════════════════════════════════
 // Performance Statistics Timer
 // ═══════════════════════════════════════════════════════════════════════════════
-static uv_timer_t stats_timer;
+static __thread uv_timer_t stats_timer;
 
 //static void print_stats(uv_timer_t* timer) {
 //    (void)timer;
@@ -490,63 +1487,177 @@ static uv_timer_t stats_timer;
 // ═══════════════════════════════════════════════════════════════════════════════
 // Public API - Initialize the Beast
 // ═══════════════════════════════════════════════════════════════════════════════
-void http_server_init(App* app, int port) {
-    (void)app; // Framework integration handled by router
+void http_server_set_threads(int threads, void (*on_thread_start)(int index)) {
+    loop_count = threads < 1 ? 1 : threads > HTTP_MAX_LOOPS ? HTTP_MAX_LOOPS : threads;
+    loop_thread_start = on_thread_start;
+}
 
-    printf("🔥 Initializing RAMForge Beast Mode HTTP Server...\n");
+void http_server_set_io(http_io_t io) {
+    io_backend = io;
+}
+
+// One listening socket per loop, all on the same port: SO_REUSEPORT makes
+// the kernel spread new connections over them (and over forked workers)
+void http_server_on_loop_start(void (*start)(uv_loop_t* loop, int index)) {
+    if (loop_hook_count < HTTP_MAX_LOOP_HOOKS) loop_hooks[loop_hook_count++] = start;
+}
+
+int http_server_listen_socket(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) {
+        perror("[HTTP] SO_REUSEPORT");
+    }
+
+    struct sockaddr_in addr;
+    uv_ip4_addr("0.0.0.0", port, &addr);
+    if (bind(fd, (const struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        int err = -errno;
+        close(fd);
+        return err;
+    }
+    return fd;
+}
 
-    // Create object pools
-    connection_pool = object_pool_create(CONNECTION_POOL_SIZE, NULL, NULL);
-    buffer_pool = object_pool_create(BUFFER_POOL_SIZE, NULL, NULL);
+// Set up this thread's share of the server on `loop` and run it
+static void loop_run(int index, uv_loop_t* loop, int port) {
+    // Create the context pool (bounded, pre-warmed, reset on release)
+    // and the loop's read buffer
+    connection_pool = object_pool_create(CONNECTION_POOL_SIZE,
+                                         connection_ctx_create,
+                                         connection_ctx_destroy);
+    loop_read_buf = slab_alloc(MAX_REQUEST_SIZE);
 
-    if (!connection_pool || !buffer_pool) {
+    if (!connection_pool || !loop_read_buf) {
         fprintf(stderr, "Failed to create object pools\n");
         exit(1);
     }
+    object_pool_set_reset(connection_pool, connection_ctx_reset);
+    object_pool_prewarm(connection_pool, CONNECTION_POOL_WARM);
+    counters = &loop_counters[index];
+    pool_publish(connection_pool);
 
-    // Initialize main event loop
-    main_loop = uv_default_loop();
+    main_loop = loop;
 
     // Set up date cache timer (updates every second)
     uv_timer_init(main_loop, &date_timer);
     update_date_cache(&date_timer); // Initial update
     uv_timer_start(&date_timer, update_date_cache, 1000, 1000);
 
+    // Responses of one iteration are written together once its reads are done
+    uv_check_init(main_loop, &flush_check);
+    uv_check_start(&flush_check, flush_check_cb);
 
-    // Create TCP server with maximum performance settings
-    uv_tcp_t* server = slab_alloc(sizeof(uv_tcp_t));
-    uv_tcp_init(main_loop, server);
+    // One timer drives every connection's header/idle deadline
+    timer_wheel_init(&conn_wheel, TIMEOUT_TICK_MS);
+    uv_timer_init(main_loop, &conn_wheel_timer);
+    uv_timer_start(&conn_wheel_timer, conn_wheel_tick, TIMEOUT_TICK_MS, TIMEOUT_TICK_MS);
 
-    // Bind to all interfaces
-    struct sockaddr_in addr;
-    uv_ip4_addr("0.0.0.0", port, &addr);
+    // Trims this thread's slab pages
+    uv_timer_init(main_loop, &slab_trim_timer);
+    uv_timer_start(&slab_trim_timer, slab_trim_cb,
+                   SLAB_TRIM_INTERVAL_MS, SLAB_TRIM_INTERVAL_MS);
 
-    // Portable REUSEPORT binding
-    int bind_result;
-    #ifdef UV_TCP_REUSEPORT
-        bind_result = uv_tcp_bind(server, (const struct sockaddr*)&addr, UV_TCP_REUSEPORT);
-    #else
-        bind_result = uv_tcp_bind(server, (const struct sockaddr*)&addr, 0);
-    #endif
-    if (bind_result != 0) {
-        fprintf(stderr, "Bind failed: %s\n", uv_strerror(bind_result));
+    // Bind to all interfaces, port shared with the other loops
+    int fd = http_server_listen_socket(port);
+    if (fd < 0) {
+        fprintf(stderr, "Bind failed: %s\n", uv_strerror(fd));
         exit(1);
     }
 
-    // Start listening with large backlog for high-traffic scenarios
-    int listen_result = uv_listen((uv_stream_t*)server, 8192, accept_connection);
-    if (listen_result != 0) {
-        fprintf(stderr, "Listen failed: %s\n", uv_strerror(listen_result));
-        exit(1);
+    // Native io_uring socket I/O if asked for and the kernel has it
+    if (io_backend == HTTP_IO_URING) {
+        int err = 0;
+        if (listen(fd, 8192) != 0) {
+            fprintf(stderr, "Listen failed: %s\n", strerror(errno));
+            exit(1);
+        }
+        loop_uring = uring_net_start(main_loop, fd, &uring_callbacks, &err);
+        if (!loop_uring) {
+            fprintf(stderr, "[HTTP] io_uring unavailable (%s), loop %d uses libuv\n",
+                    uv_strerror(err), index);
+        }
+    }
+
+    if (!loop_uring) {
+        // Create TCP server with maximum performance settings
+        uv_tcp_t* server = slab_alloc(sizeof(uv_tcp_t));
+        uv_tcp_init(main_loop, server);
+        uv_tcp_open(server, fd);
+
+        // Start listening with large backlog for high-traffic scenarios
+        int listen_result = uv_listen((uv_stream_t*)server, 8192, accept_connection);
+        if (listen_result != 0) {
+            fprintf(stderr, "Listen failed: %s\n", uv_strerror(listen_result));
+            exit(1);
+        }
+    }
+
+    // Other protocols served by this loop (proto_server.h)
+    for (int i = 0; i < loop_hook_count; i++) {
+        loop_hooks[i](main_loop, index);
     }
 
-    printf("🚀 RAMForge Beast Mode HTTP Server is LIVE on port %d!\n", port);
     // Run the event loop
     uv_run(main_loop, UV_RUN_DEFAULT);
 
     // Cleanup
+    pool_publish(NULL);
     object_pool_destroy(connection_pool);
-    object_pool_destroy(buffer_pool);
+    slab_free(loop_read_buf);
+}
+
+typedef struct {
+    uv_thread_t thread;
+    int index;
+    int port;
+} loop_thread_t;
+
+static void loop_thread_main(void* arg) {
+    loop_thread_t* t = (loop_thread_t*)arg;
+    if (loop_thread_start) loop_thread_start(t->index);
+
+    uv_loop_t loop;
+    uv_loop_init(&loop);
+    loop_run(t->index, &loop, t->port);
+    uv_loop_close(&loop);
+}
+
+void http_server_init(App* app, int port) {
+    printf("🔥 Initializing RAMForge Beast Mode HTTP Server...\n");
+
+    // Loop 0 is the caller's (the default loop, where persistence timers
+    // live); the others each get a thread.  They all serve one Storage.
+    loop_thread_t* threads = NULL;
+    if (loop_count > 1) {
+        storage_set_shared(app->storage, 1);
+        threads = calloc((size_t)loop_count, sizeof(*threads));
+        if (!threads) {
+            fprintf(stderr, "Failed to allocate loop threads\n");
+            exit(1);
+        }
+        for (int i = 1; i < loop_count; i++) {
+            threads[i].index = i;
+            threads[i].port = port;
+            if (uv_thread_create(&threads[i].thread, loop_thread_main, &threads[i]) != 0) {
+                fprintf(stderr, "Failed to start loop thread %d\n", i);
+                exit(1);
+            }
+        }
+    }
+
+    printf("🚀 RAMForge Beast Mode HTTP Server is LIVE on port %d (%d loop%s, %s)!\n",
+           port, loop_count, loop_count == 1 ? "" : "s",
+           io_backend == HTTP_IO_URING ? "io_uring" : "libuv");
+    loop_run(0, uv_default_loop(), port);
+
+    for (int i = 1; i < loop_count; i++) {
+        uv_thread_join(&threads[i].thread);
+    }
+    free(threads);
     slab_destroy();
 }
 
@@ -555,16 +1666,38 @@ void http_server_init(App* app, int port) {
 // ═══════════════════════════════════════════════════════════════════════════════
 
 // Get current performance stats (for monitoring)
-void http_server_get_stats(uint64_t* requests, uint64_t* connections, uint64_t* bytes_sent) {
-    if (requests) *requests = total_requests;
-    if (connections) *connections = active_connections;
-    if (bytes_sent) *bytes_sent = total_bytes_sent;
+// (sums over the loops; another loop's counters may be a moment stale)
+void http_server_get_stats(http_server_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < loop_count; i++) {
+        out->requests += __atomic_load_n(&loop_counters[i].requests, __ATOMIC_RELAXED);
+        out->connections += __atomic_load_n(&loop_counters[i].connections, __ATOMIC_RELAXED);
+        out->bytes_sent += __atomic_load_n(&loop_counters[i].bytes_sent, __ATOMIC_RELAXED);
+        out->bytes_received += __atomic_load_n(&loop_counters[i].bytes_received, __ATOMIC_RELAXED);
+        out->writes += __atomic_load_n(&loop_counters[i].writes, __ATOMIC_RELAXED);
+    }
+}
+
+// Pool hit/miss counters, summed over what each loop last published
+void http_server_pool_stats(object_pool_stats_t* connections) {
+    memset(connections, 0, sizeof(*connections));
+    for (int i = 0; i < loop_count; i++) {
+        const object_pool_stats_t* one = &loop_counters[i].pool;
+        connections->hits += __atomic_load_n(&one->hits, __ATOMIC_RELAXED);
+        connections->misses += __atomic_load_n(&one->misses, __ATOMIC_RELAXED);
+        connections->drops += __atomic_load_n(&one->drops, __ATOMIC_RELAXED);
+        connections->idle += __atomic_load_n(&one->idle, __ATOMIC_RELAXED);
+        connections->capacity += __atomic_load_n(&one->capacity, __ATOMIC_RELAXED);
+        connections->high_water += __atomic_load_n(&one->high_water, __ATOMIC_RELAXED);
+    }
 }
 
-// Graceful shutdown
+// Graceful shutdown (of the calling thread's loop)
 void http_server_shutdown(void) {
     printf("🛑 Shutting down RAMForge Beast Mode HTTP Server...\n");
     uv_timer_stop(&date_timer);
     uv_timer_stop(&stats_timer);
+    uv_timer_stop(&slab_trim_timer);
+    uv_timer_stop(&conn_wheel_timer);
     // Event loop will exit naturally
 }
@@ -3,12 +3,61 @@
 
 #include <uv.h>
 #include "app.h"
+#include "object_pool.h"
 
 /**
  * Initialize & run HTTP server on `port`.
  * Call this *after* Persistence_init() in each worker.
  */
 void http_server_init(App *app, int port);
+
+#define HTTP_MAX_LOOPS 128
+
+/// Serve with `threads` event loops in this process (default 1), each
+/// with its own SO_REUSEPORT listener, connection pool and timers, all on
+/// app->storage (switched to shared mode).  Call before http_server_init;
+/// `on_thread_start` (may be NULL) runs first on each extra loop thread
+/// with its index 1..threads-1, e.g. to pin it to a core.
+void http_server_set_threads(int threads, void (*on_thread_start)(int index));
+
+/// Socket I/O under the shared HTTP connection code.  HTTP_IO_URING uses
+/// native io_uring (multishot accept/recv, provided buffers, one submit
+/// per loop iteration) and falls back to libuv per loop when the kernel
+/// lacks it.  Call before http_server_init.
+typedef enum {
+    HTTP_IO_UV    = 0,   ///< libuv streams (default)
+    HTTP_IO_URING = 1
+} http_io_t;
+
+void http_server_set_io(http_io_t io);
+
+#define HTTP_MAX_LOOP_HOOKS 8
+
+/// Run `start` on every event loop, on the loop's thread, once its HTTP
+/// listener is up and before it runs: how other protocols share the
+/// loops (see proto_server.h).  Call before http_server_init.
+void http_server_on_loop_start(void (*start)(uv_loop_t *loop, int index));
+
+/// A bound, not yet listening, SO_REUSEPORT socket on `port` (every loop
+/// of every worker binds its own), or a negative UV error code.
+int http_server_listen_socket(int port);
 void http_server_shutdown(void);
 
+/// Traffic counters summed over the loops (another loop's may be a moment
+/// stale).  `writes` counts write calls to the socket layer: responses
+/// written in one go count once, so under pipelined load it stays well
+/// below `requests`.
+typedef struct {
+    uint64_t requests;
+    uint64_t connections;      ///< open now
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint64_t writes;
+} http_server_stats_t;
+
+void http_server_get_stats(http_server_stats_t *out);
+
+/// Snapshot of the connection-context pool (zeroes before the server starts).
+void http_server_pool_stats(object_pool_stats_t *connections);
+
 #endif // HTTP_SERVER_H
@@ -0,0 +1,90 @@
+// hugepage.c
+#define _GNU_SOURCE
+#include "hugepage.h"
+#include "numa_topo.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB   (21 << MAP_HUGE_SHIFT)
+#endif
+
+static hugepage_mode_t g_mode = HUGEPAGE_OFF;
+static atomic_size_t   g_explicit_maps, g_thp_maps;
+
+/* no header on mapped regions (it would break the 2 MiB alignment):
+   callers pass `len` back and the kind is recomputed from it */
+
+void hugepage_set_mode(hugepage_mode_t mode) { g_mode = mode; }
+hugepage_mode_t hugepage_mode(void)          { return g_mode; }
+
+static int wants_huge(size_t len) {
+    return g_mode != HUGEPAGE_OFF && len >= HUGEPAGE_SIZE;
+}
+
+static size_t round_huge(size_t len) {
+    return (len + HUGEPAGE_SIZE - 1) & ~(size_t)(HUGEPAGE_SIZE - 1);
+}
+
+void hugepage_advise(void *addr, size_t len) {
+    if (g_mode == HUGEPAGE_OFF) return;
+#ifdef MADV_HUGEPAGE
+    if (madvise(addr, len, MADV_HUGEPAGE) == 0)
+        atomic_fetch_add(&g_thp_maps, 1);
+#else
+    (void)addr; (void)len;
+#endif
+}
+
+/* 2 MiB aligned anonymous mapping of exactly `len` (a multiple of 2 MiB) */
+static void *map_aligned(size_t len) {
+    size_t span = len + HUGEPAGE_SIZE;
+    char *m = mmap(NULL, span, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED) return NULL;
+
+    char *p = (char*)(((uintptr_t)m + HUGEPAGE_SIZE - 1) & ~(uintptr_t)(HUGEPAGE_SIZE - 1));
+    if (p > m)                munmap(m, (size_t)(p - m));
+    if (p + len < m + span)   munmap(p + len, (size_t)(m + span - (p + len)));
+    return p;
+}
+
+void *hugepage_alloc(size_t len) {
+    if (!wants_huge(len)) return calloc(1, len);
+
+    size_t rlen = round_huge(len);
+    if (g_mode == HUGEPAGE_EXPLICIT) {
+        /* fails up front (no NORESERVE) when the pool is short */
+        void *p = mmap(NULL, rlen, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB,
+                       -1, 0);
+        if (p != MAP_FAILED) {
+            atomic_fetch_add(&g_explicit_maps, 1);
+            numa_topo_bind(p, rlen);
+            return p;
+        }
+    }
+
+    void *p = map_aligned(rlen);
+    if (!p) return NULL;
+    hugepage_advise(p, rlen);
+    numa_topo_bind(p, rlen);
+    return p;
+}
+
+void hugepage_free(void *ptr, size_t len) {
+    if (!ptr) return;
+    if (!wants_huge(len)) { free(ptr); return; }
+    /* munmap works for both kinds; the length is rounded the same way */
+    munmap(ptr, round_huge(len));
+}
+
+void hugepage_counts(size_t *explicit_maps, size_t *thp_maps) {
+    if (explicit_maps) *explicit_maps = atomic_load(&g_explicit_maps);
+    if (thp_maps)      *thp_maps      = atomic_load(&g_thp_maps);
+}
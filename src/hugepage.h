@@ -0,0 +1,36 @@
+// hugepage.h
+#ifndef HUGEPAGE_H
+#define HUGEPAGE_H
+
+#include <stddef.h>
+
+/// Huge-page policy for the big random-access arrays (Storage table,
+/// slab arena).  Chosen once at startup (--hugepages), before slab_init.
+typedef enum {
+    HUGEPAGE_OFF      = 0,   ///< plain 4 KiB pages
+    HUGEPAGE_THP      = 1,   ///< madvise(MADV_HUGEPAGE), kernel promotes
+    HUGEPAGE_EXPLICIT = 2    ///< MAP_HUGETLB from the reserved pool, THP fallback
+} hugepage_mode_t;
+
+#define HUGEPAGE_SIZE (2u << 20)     ///< x86-64 PMD page
+
+/// Select the policy.  Not thread-safe; call before any allocation.
+void            hugepage_set_mode(hugepage_mode_t mode);
+hugepage_mode_t hugepage_mode(void);
+
+/// Zeroed allocation of `len` bytes.  Regions of at least HUGEPAGE_SIZE
+/// are mapped 2 MiB aligned and backed by huge pages per the policy;
+/// anything else (or HUGEPAGE_OFF) is plain calloc.  Falls back silently
+/// when huge pages are unavailable.
+void *hugepage_alloc(size_t len);
+
+/// Free a block from hugepage_alloc(); `len` must match the request.
+void  hugepage_free(void *ptr, size_t len);
+
+/// Ask for THP on an existing mapping (no-op unless the policy is on).
+void  hugepage_advise(void *addr, size_t len);
+
+/// Regions mapped with MAP_HUGETLB / advised for THP since startup.
+void  hugepage_counts(size_t *explicit_maps, size_t *thp_maps);
+
+#endif // HUGEPAGE_H
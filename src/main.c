@@ -1,13 +1,22 @@
 // main.c – parent process (no threads, no libuv, just forks workers)
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <signal.h>
 
 #include "cluster.h"
+#include "persistence.h"
+#include "hugepage.h"
 
 // ────────────────────────────────────────────────────────────────
 // global configuration visible inside workers
 unsigned g_aof_flush_ms = 10;           // 0  → appendfsync always
+snapshot_mode_t g_snapshot_mode = SNAPSHOT_FORK;   // --snapshot fork|epoch
+hugepage_mode_t g_hugepage_mode = HUGEPAGE_OFF;    // --hugepages off|thp|explicit
+int g_threads = 1;                                 // --threads N (event loops per worker)
+int g_io_uring = 0;                                // --io uv|uring
+int g_bin_port = 0;                                // --bin-port N (0: off)
+int g_resp_port = 0;                               // --resp-port N (0: off)
 // ────────────────────────────────────────────────────────────────
 
 // graceful shutdown flag (parent only)
@@ -32,6 +41,9 @@ static void setup_signal_handlers(void)
 /* ──────────  CLI parsing  ────────── */
 static void parse_arguments(int argc, char **argv)
 {
+    const char *env = getenv("RAMFORGE_THREADS");
+    if (env) g_threads = atoi(env);
+
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--aof") == 0 && i + 1 < argc) {
             if (strcmp(argv[i + 1], "always") == 0) {
@@ -42,8 +54,44 @@ static void parse_arguments(int argc, char **argv)
                        argv[i + 1]);
             }
             i++;                        // skip value
+        } else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            if (strcmp(argv[i + 1], "epoch") == 0) {
+                g_snapshot_mode = SNAPSHOT_EPOCH;
+                printf("📸 Snapshot mode: EPOCH (fork-less, background thread)\n");
+            } else if (strcmp(argv[i + 1], "fork") != 0) {
+                printf("📸 Unknown --snapshot option “%s”, using fork\n",
+                       argv[i + 1]);
+            }
+            i++;                        // skip value
+        } else if (strcmp(argv[i], "--hugepages") == 0 && i + 1 < argc) {
+            if (strcmp(argv[i + 1], "thp") == 0) {
+                g_hugepage_mode = HUGEPAGE_THP;
+            } else if (strcmp(argv[i + 1], "explicit") == 0) {
+                g_hugepage_mode = HUGEPAGE_EXPLICIT;
+            } else if (strcmp(argv[i + 1], "off") != 0) {
+                printf("🗺 Unknown --hugepages option “%s”, using off\n",
+                       argv[i + 1]);
+            }
+            i++;                        // skip value
+        } else if (strcmp(argv[i], "--io") == 0 && i + 1 < argc) {
+            if (strcmp(argv[i + 1], "uring") == 0) {
+                g_io_uring = 1;
+            } else if (strcmp(argv[i + 1], "uv") != 0) {
+                printf("🔌 Unknown --io option “%s”, using uv\n", argv[i + 1]);
+            }
+            i++;                        // skip value
+        } else if (strcmp(argv[i], "--bin-port") == 0 && i + 1 < argc) {
+            g_bin_port = atoi(argv[i + 1]);
+            i++;                        // skip value
+        } else if (strcmp(argv[i], "--resp-port") == 0 && i + 1 < argc) {
+            g_resp_port = atoi(argv[i + 1]);
+            i++;                        // skip value
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            g_threads = atoi(argv[i + 1]);
+            i++;                        // skip value
         }
     }
+    if (g_threads < 1) g_threads = 1;
 }
 
 /* ──────────  entry point  ────────── */
@@ -58,6 +106,19 @@ int main(int argc, char **argv)
     printf("🚀 RamForge parent – starting cluster only (heavy init in workers)\n");
     printf("   AOF flush interval: %s\n",
            g_aof_flush_ms == 0 ? "always" : "10 ms (default)");
+    printf("   Snapshots: %s\n",
+           g_snapshot_mode == SNAPSHOT_EPOCH ? "epoch" : "fork (default)");
+    printf("   Huge pages: %s\n",
+           g_hugepage_mode == HUGEPAGE_EXPLICIT ? "explicit (MAP_HUGETLB, THP fallback)" :
+           g_hugepage_mode == HUGEPAGE_THP      ? "thp (madvise)" : "off (default)");
+    printf("   Event loops per worker: %d%s\n", g_threads,
+           g_threads == 1 ? " (default)" : " (threads, SO_REUSEPORT)");
+    printf("   Socket I/O: %s\n",
+           g_io_uring ? "io_uring (libuv fallback)" : "libuv (default)");
+    if (g_bin_port > 0)
+        printf("   Binary protocol: port %d\n", g_bin_port);
+    if (g_resp_port > 0)
+        printf("   Redis protocol: port %d\n", g_resp_port);
     printf("   Port: 1109\n\n");
 
     /* forks workers & monitors them */
@@ -0,0 +1,113 @@
+// numa_topo.c
+#define _GNU_SOURCE
+#include "numa_topo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#define NODE_MASK_WORDS (NUMA_MAX_NODES / 64)
+
+static int       g_nodes = 1;
+static cpu_set_t g_node_cpus[NUMA_MAX_NODES];
+static int       g_node_id[NUMA_MAX_NODES];    /* sysfs id of each entry */
+static int       g_local = -1;
+
+/* parse a sysfs cpulist ("0-3,8-11") into a cpu_set_t */
+static void parse_cpulist(const char *s, cpu_set_t *set)
+{
+    CPU_ZERO(set);
+    while (*s && *s != '\n') {
+        char *end;
+        long a = strtol(s, &end, 10), b = a;
+        if (end == s) break;
+        if (*end == '-') b = strtol(end + 1, &end, 10);
+        for (long c = a; c <= b && c < CPU_SETSIZE; c++) CPU_SET((size_t)c, set);
+        s = *end == ',' ? end + 1 : end;
+    }
+}
+
+int numa_topo_init(void)
+{
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof allowed, &allowed) != 0)
+        CPU_ZERO(&allowed);
+
+    int n = 0;
+    for (int node = 0; node < NUMA_MAX_NODES; node++) {
+        char path[96], buf[1024];
+        snprintf(path, sizeof path, "/sys/devices/system/node/node%d/cpulist", node);
+        FILE *f = fopen(path, "r");
+        if (!f) continue;
+        if (!fgets(buf, sizeof buf, f)) buf[0] = '\0';
+        fclose(f);
+
+        cpu_set_t cpus;
+        parse_cpulist(buf, &cpus);
+        CPU_AND(&cpus, &cpus, &allowed);
+        if (CPU_COUNT(&cpus) == 0) continue;       /* memory-only / offline */
+        g_node_cpus[n] = cpus;
+        g_node_id[n++] = node;
+    }
+    if (n == 0) {                                  /* no sysfs: one node */
+        g_node_cpus[0] = allowed;
+        g_node_id[0]   = 0;
+        n = 1;
+    }
+    g_nodes = n;
+    return n;
+}
+
+int numa_topo_nodes(void) { return g_nodes; }
+int numa_topo_local(void) { return g_local; }
+
+int numa_topo_worker_cpu(int wid, int loop, int loops, int *node)
+{
+    int nd = wid % g_nodes;
+    const cpu_set_t *cpus = &g_node_cpus[nd];
+    int count = CPU_COUNT(cpus);
+    if (node) *node = g_node_id[nd];
+    if (count == 0) return -1;
+
+    /* the workers sharing this node take consecutive runs of its CPUs */
+    int want = ((wid / g_nodes) * loops + loop) % count;
+    for (size_t c = 0; c < CPU_SETSIZE; c++)
+        if (CPU_ISSET(c, cpus) && want-- == 0) return (int)c;
+    return -1;
+}
+
+static void node_mask(int node, unsigned long mask[NODE_MASK_WORDS])
+{
+    memset(mask, 0, NODE_MASK_WORDS * sizeof mask[0]);
+    mask[node / 64] = 1ul << (node % 64);
+}
+
+int numa_topo_set_local(int node)
+{
+    if (g_nodes < 2 || node < 0 || node >= NUMA_MAX_NODES) return -1;
+    unsigned long mask[NODE_MASK_WORDS];
+    node_mask(node, mask);
+    /* preferred, not bind: a full node spills over instead of OOM-ing */
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, NUMA_MAX_NODES + 1) != 0) {
+        perror("set_mempolicy");
+        return -1;
+    }
+    g_local = node;
+    return 0;
+}
+
+void numa_topo_bind(void *addr, size_t len)
+{
+    if (g_local < 0 || !addr || !len) return;
+    long ps = sysconf(_SC_PAGESIZE);
+    uintptr_t a = (uintptr_t)addr & ~(uintptr_t)(ps - 1);
+    unsigned long mask[NODE_MASK_WORDS];
+    node_mask(g_local, mask);
+    if (syscall(SYS_mbind, (void *)a, len + ((uintptr_t)addr - a), MPOL_PREFERRED,
+                mask, NUMA_MAX_NODES + 1, 0) != 0)
+        perror("mbind");
+}
@@ -0,0 +1,41 @@
+// numa_topo.h
+#ifndef NUMA_TOPO_H
+#define NUMA_TOPO_H
+
+#include <stddef.h>
+
+/// NUMA placement without libnuma: topology from sysfs, policy through
+/// the raw set_mempolicy/mbind syscalls.  On single-node machines every
+/// call is a no-op.
+
+#define NUMA_MAX_NODES 64
+
+/// Read /sys/devices/system/node.  Returns the number of nodes (≥ 1).
+/// Only CPUs in the caller's affinity mask count, so call it once
+/// before anything is pinned.
+int numa_topo_init(void);
+
+/// Number of nodes found by numa_topo_init().
+int numa_topo_nodes(void);
+
+/// Choose a CPU for event loop `loop` (of `loops`) in worker `wid`:
+/// workers are spread across nodes round-robin, and all loops of one
+/// worker stay on its node, spread over that node's allowed CPUs.
+/// Returns the CPU id (or -1) and stores its node's sysfs id (what
+/// set_mempolicy and mbind take) in *node.
+int numa_topo_worker_cpu(int wid, int loop, int loops, int *node);
+
+/// Prefer `node` for every later allocation of this process (task
+/// policy, inherited by threads and forked snapshot children) and
+/// remember it for numa_topo_bind().  Call it once, from the main
+/// thread before any loop threads start.  Returns 0 on success.
+int numa_topo_set_local(int node);
+
+/// Node chosen by numa_topo_set_local(), or -1.
+int numa_topo_local(void);
+
+/// Bind a mapping to the local node (mbind, MPOL_PREFERRED) so it stays
+/// there no matter which thread first touches it.  No-op when unbound.
+void numa_topo_bind(void *addr, size_t len);
+
+#endif // NUMA_TOPO_H
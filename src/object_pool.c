@@ -3,11 +3,13 @@
 #include <stdio.h>
 
 object_pool_t* object_pool_create(int capacity, object_factory_t factory, object_dtor_t dtor) {
-    object_pool_t* pool = malloc(sizeof(object_pool_t));
+    object_pool_t* pool = calloc(1, sizeof(object_pool_t));
     if (!pool) {
         fprintf(stderr, "[Pool] Allocation failed\n");
         return NULL;
     }
+    if (capacity < 1)
+        capacity = 1;
     pool->items = malloc(sizeof(void*) * capacity);
     if (!pool->items) {
         free(pool);
@@ -15,45 +17,79 @@ object_pool_t* object_pool_create(int capacity, object_factory_t factory, object
         return NULL;
     }
     pool->capacity = capacity;
-    pool->count = 0;
     pool->factory = factory;
     pool->dtor = dtor;
     return pool;
 }
 
+static void destroy_item(object_pool_t* pool, void* item) {
+    if (pool->dtor)
+        pool->dtor(item);
+    else
+        free(item);
+}
+
 void object_pool_destroy(object_pool_t* pool) {
     if (!pool)
         return;
-    for (int i = 0; i < pool->count; i++) {
-        if (pool->dtor)
-            pool->dtor(pool->items[i]);
-    }
+    for (int i = 0; i < pool->count; i++)
+        destroy_item(pool, pool->items[i]);
     free(pool->items);
     free(pool);
 }
 
 void* object_pool_get(object_pool_t* pool) {
     if (pool->count > 0) {
+        pool->hits++;
         return pool->items[--pool->count];
     }
+    pool->misses++;
     if (pool->factory)
         return pool->factory();
     return NULL;
 }
 
 void object_pool_release(object_pool_t* pool, void* item) {
+    if (!item)
+        return;
     if (pool->count >= pool->capacity) {
-        int new_capacity = pool->capacity * 2;
-        void** new_items = realloc(pool->items, sizeof(void*) * new_capacity);
-        if (!new_items) {
-            if (pool->dtor)
-                pool->dtor(item);
-            else
-                free(item);
-            return;
-        }
-        pool->items = new_items;
-        pool->capacity = new_capacity;
+        // Over the high-water mark: a burst is over, give the memory back
+        pool->drops++;
+        destroy_item(pool, item);
+        return;
     }
+    if (pool->reset)
+        pool->reset(item);
     pool->items[pool->count++] = item;
+    if (pool->count > pool->high_water)
+        pool->high_water = pool->count;
+}
+
+void object_pool_set_reset(object_pool_t* pool, object_reset_t reset) {
+    pool->reset = reset;
+}
+
+int object_pool_prewarm(object_pool_t* pool, int n) {
+    if (!pool->factory)
+        return pool->count;
+    if (n > pool->capacity)
+        n = pool->capacity;
+    while (pool->count < n) {
+        void* item = pool->factory();
+        if (!item)
+            break;
+        pool->items[pool->count++] = item;
+    }
+    if (pool->count > pool->high_water)
+        pool->high_water = pool->count;
+    return pool->count;
+}
+
+void object_pool_stats(const object_pool_t* pool, object_pool_stats_t* out) {
+    out->hits       = pool->hits;
+    out->misses     = pool->misses;
+    out->drops      = pool->drops;
+    out->idle       = pool->count;
+    out->capacity   = pool->capacity;
+    out->high_water = pool->high_water;
 }
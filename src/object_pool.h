@@ -1,22 +1,51 @@
 #ifndef OBJECT_POOL_H
 #define OBJECT_POOL_H
 
+#include <stdint.h>
+
 typedef void* (*object_factory_t)(void);
 typedef void  (*object_dtor_t)   (void*);
+typedef void  (*object_reset_t)  (void*);
+
+/// Hit/miss accounting for one pool (all counters since creation)
+typedef struct {
+    uint64_t hits;        ///< get() served from the idle list
+    uint64_t misses;      ///< get() that had to call the factory
+    uint64_t drops;       ///< release() past the cap, item destroyed
+    int      idle;        ///< items parked right now
+    int      capacity;    ///< idle cap (high-water mark)
+    int      high_water;  ///< most items ever parked at once
+} object_pool_stats_t;
 
+/// LIFO free list of interchangeable objects.  Single-threaded: each
+/// pool belongs to one event loop.
 typedef struct {
     void            **items;
-    int                capacity;
+    int                capacity;    ///< never grows: extra releases are destroyed
     int                count;
+    int                high_water;
     object_factory_t   factory;
-    object_dtor_t      dtor;
+    object_dtor_t      dtor;        ///< NULL: free()
+    object_reset_t     reset;       ///< run on release, before parking
+    uint64_t           hits, misses, drops;
 } object_pool_t;
 
+/// Create a pool holding at most `capacity` idle objects.
 object_pool_t* object_pool_create(int capacity,
                                   object_factory_t factory,
                                   object_dtor_t    dtor);
+/// Destroy the pool and every idle object (outstanding ones are the caller's).
 void           object_pool_destroy(object_pool_t *pool);
+/// Pop an idle object, or make one with the factory.  NULL when neither works.
 void*          object_pool_get   (object_pool_t *pool);
+/// Reset `item` and park it; destroy it instead if the pool is full.
 void           object_pool_release(object_pool_t *pool, void *item);
 
+/// Hook run on every released item so get() always returns a clean one.
+void           object_pool_set_reset(object_pool_t *pool, object_reset_t reset);
+/// Fill the pool with up to `n` factory-made objects.  Returns how many
+/// are idle afterwards.
+int            object_pool_prewarm(object_pool_t *pool, int n);
+void           object_pool_stats(const object_pool_t *pool, object_pool_stats_t *out);
+
 #endif // OBJECT_POOL_H
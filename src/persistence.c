@@ -6,15 +6,49 @@
 #include "crc32c.h"              /* NEW */
 
 #include <uv.h>
+#include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
 
 static char      *g_rdb_path;
 static Storage   *g_storage;
 static uv_timer_t g_snapshot_timer;
+static uv_signal_t g_sigchld;
+static snapshot_mode_t g_snapshot_mode = SNAPSHOT_FORK;
+
+static snapshot_stats_t g_snap;              /* see GET /admin/snapshot */
+static uint64_t   g_snap_t0;                 /* uv_hrtime() at start    */
+static char       g_snap_tmp[512];           /* file being written now  */
+
+/* delta chain: dump.rdb (full base) + dump.rdb.delta.1 … .N */
+static uint32_t   g_base_crc;                /* footer CRC of the base  */
+static int        g_have_base;
+static unsigned   g_chain_len;               /* deltas on top of base   */
+static int        g_force_full;              /* dirty set was lost      */
+static struct { int delta; unsigned seq; } g_cur;
+
+#define SNAPSHOT_STEP_SLOTS 4096             /* slots per storage-lock hold */
+#define DELTA_CHAIN_MAX     8                /* deltas before a full rewrite */
+#define DELTA_MAGIC         "RFDELTA1"
+#define RDB_TOMBSTONE       ((size_t)-1)     /* record size of a removal */
+
+/* delta file = header, records (RDB layout + tombstones), CRC footer */
+typedef struct {
+    char     magic[8];
+    uint32_t base_crc;                       /* base this delta extends */
+    uint32_t seq;                            /* position in the chain   */
+} delta_header_t;
+
+static void delta_path(char *buf, size_t len, unsigned seq)
+{
+    snprintf(buf, len, "%s.delta.%u", g_rdb_path, seq);
+}
 
 /* ──────────────────────────────────────────────────────────── */
 /* 1.   Streaming iterator that updates CRC while dumping      */
@@ -25,13 +59,15 @@ static void rdb_iter_crc_cb(int id,
 {
     struct { FILE *f; uint32_t *crc; } *ctx = ud;
 
+    if (!data) size = RDB_TOMBSTONE;         /* removed since the base */
+
     fwrite(&id,   sizeof id,   1, ctx->f);
     fwrite(&size, sizeof size, 1, ctx->f);
-    fwrite(data,  size,        1, ctx->f);
+    if (data) fwrite(data, size, 1, ctx->f);
 
     *ctx->crc = crc32c(*ctx->crc, &id,   sizeof id);
     *ctx->crc = crc32c(*ctx->crc, &size, sizeof size);
-    *ctx->crc = crc32c(*ctx->crc,  data, size);
+    if (data) *ctx->crc = crc32c(*ctx->crc, data, size);
 }
 
 static void storage_iterate_crc(Storage *st, FILE *out, uint32_t *crc)
@@ -41,8 +77,80 @@ static void storage_iterate_crc(Storage *st, FILE *out, uint32_t *crc)
     storage_iterate(st, rdb_iter_crc_cb, &ctx);
 }
 
+static void storage_iterate_dirty_crc(Storage *st, FILE *out, uint32_t *crc)
+{
+    struct { FILE *f; uint32_t *crc; } ctx = { out, crc };
+    storage_iterate_dirty(st, rdb_iter_crc_cb, &ctx);
+}
+
 /* ──────────────────────────────────────────────────────────── */
-/* 2.   Load RDB on startup – verify footer CRC                */
+/* 2.   Load RDB + delta chain on startup – verify footer CRCs */
+static int load_records(FILE *f, long end, uint32_t *crc, Storage *st)
+{
+    while (ftell(f) < end) {
+        int    id;
+        size_t sz;
+
+        if (fread(&id, sizeof id, 1, f) != 1) return -1;
+        if (fread(&sz, sizeof sz, 1, f) != 1) return -1;
+
+        *crc = crc32c(*crc, &id, sizeof id);
+        *crc = crc32c(*crc, &sz, sizeof sz);
+        if (sz == RDB_TOMBSTONE) { storage_remove(st, id); continue; }
+
+        void *buf = malloc(sz);
+        if (fread(buf, sz, 1, f) != 1) { free(buf); return -1; }
+        *crc = crc32c(*crc,  buf, sz);
+
+        storage_save(st, id, buf, sz);
+        free(buf);
+    }
+    return 0;
+}
+
+static void load_deltas(Storage *st)
+{
+    for (unsigned seq = 1; ; seq++) {
+        char path[512];
+        delta_path(path, sizeof path, seq);
+        FILE *f = fopen(path, "rb");
+        if (!f) break;
+
+        fseek(f, 0, SEEK_END);
+        long fsz = ftell(f);
+        rewind(f);
+
+        delta_header_t h;
+        if (fsz < (long)(sizeof h + 4) || fread(&h, sizeof h, 1, f) != 1 ||
+            memcmp(h.magic, DELTA_MAGIC, sizeof h.magic) != 0 ||
+            h.base_crc != g_base_crc || h.seq != seq) {
+            /* left over from an older base: the chain ends here */
+            fprintf(stderr, "⚠ %s does not extend %s – ignoring it\n",
+                    path, g_rdb_path);
+            fclose(f);
+            break;
+        }
+
+        uint32_t crc_file;
+        fseek(f, fsz - 4, SEEK_SET);
+        if (fread(&crc_file, 4, 1, f) != 1) crc_file = ~0u;
+        fseek(f, (long)sizeof h, SEEK_SET);
+
+        uint32_t crc = crc32c(0, &h, sizeof h);
+        if (load_records(f, fsz - 4, &crc, st) != 0 || crc != crc_file) {
+            fprintf(stderr,
+                    "❌ %s checksum mismatch, aborting startup (computed %#x ≠ %#x)\n",
+                    path, crc, crc_file);
+            exit(2);
+        }
+        fclose(f);
+        g_chain_len = seq;
+    }
+    if (g_chain_len)
+        printf("📸 Applied %u delta snapshot%s on top of %s\n",
+               g_chain_len, g_chain_len == 1 ? "" : "s", g_rdb_path);
+}
+
 static void load_rdb(Storage *st)
 {
     FILE *rdb = fopen(g_rdb_path, "rb");
@@ -58,26 +166,13 @@ static void load_rdb(Storage *st)
     rewind(rdb);
 
     uint32_t crc = 0;
-    while (ftell(rdb) < fsz - 4) {
-        int    id;
-        size_t sz;
-
-        if (fread(&id, sizeof id, 1, rdb) != 1) goto corrupt;
-        if (fread(&sz, sizeof sz, 1, rdb) != 1) goto corrupt;
-
-        void *buf = malloc(sz);
-        if (fread(buf, sz, 1, rdb) != 1) { free(buf); goto corrupt; }
-
-        crc = crc32c(crc, &id, sizeof id);
-        crc = crc32c(crc, &sz, sizeof sz);
-        crc = crc32c(crc,  buf, sz);
-
-        storage_save(st, id, buf, sz);
-        free(buf);
-    }
-
+    if (load_records(rdb, fsz - 4, &crc, st) != 0) goto corrupt;
     if (crc != crc_file) goto corrupt;
     fclose(rdb);
+
+    g_base_crc  = crc_file;
+    g_have_base = 1;
+    load_deltas(st);
     return;
 
     corrupt:
@@ -87,33 +182,362 @@ static void load_rdb(Storage *st)
     exit(2);
 }
 
+/* drop every delta: the base they extend has been replaced */
+static void drop_deltas(void)
+{
+    unsigned last = g_chain_len > DELTA_CHAIN_MAX ? g_chain_len : DELTA_CHAIN_MAX;
+    for (unsigned seq = 1; seq <= last + 1; seq++) {
+        char path[512];
+        delta_path(path, sizeof path, seq);
+        unlink(path);
+    }
+    g_chain_len = 0;
+}
+
+static int read_footer(const char *path, uint32_t *crc)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    int ok = fseek(f, -4, SEEK_END) == 0 && fread(crc, 4, 1, f) == 1;
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
 /* ──────────────────────────────────────────────────────────── */
-/* 3.   Periodic forked snapshot – dump + CRC footer           */
+/* 3.   Fork-less snapshot – worker thread streams frozen view */
+typedef struct {
+    uv_work_t req;
+    char     *buf;                 /* records staged under the lock   */
+    size_t    len, cap;
+    uint32_t  crc;
+    uint64_t  bytes;               /* written to disk so far          */
+    int       ok;
+    int       aof;                 /* compaction: rewrite the AOF too */
+    char      path[512];           /* final name (base or delta)      */
+    delta_header_t hdr;            /* written first for a delta       */
+} epoch_snapshot_t;
+
+static void stage_record_cb(int id, const void *data, size_t size, void *ud)
+{
+    epoch_snapshot_t *s = ud;
+    if (!data) size = RDB_TOMBSTONE;         /* removed since the base */
+    size_t need = sizeof id + sizeof size + (data ? size : 0);
+
+    if (s->len + need > s->cap) {
+        size_t ncap = s->cap ? s->cap : 1 << 16;
+        while (ncap < s->len + need) ncap *= 2;
+        char *nbuf = realloc(s->buf, ncap);
+        if (!nbuf) { s->ok = 0; return; }
+        s->buf = nbuf; s->cap = ncap;
+    }
+
+    char *p = s->buf + s->len;
+    memcpy(p, &id,   sizeof id);   p += sizeof id;
+    memcpy(p, &size, sizeof size); p += sizeof size;
+    if (data) memcpy(p, data, size);
+    s->len += need;
+
+    s->crc = crc32c(s->crc, &id,   sizeof id);
+    s->crc = crc32c(s->crc, &size, sizeof size);
+    if (data) s->crc = crc32c(s->crc, data, size);
+}
+
+/* compaction: the staged records again, in AOF framing, into the new log */
+static int aof_rewrite_staged(const epoch_snapshot_t *s)
+{
+    const char *p = s->buf, *end = s->buf + s->len;
+    while (p < end) {
+        int    id;
+        size_t size;
+        memcpy(&id,   p, sizeof id);   p += sizeof id;
+        memcpy(&size, p, sizeof size); p += sizeof size;
+        if (AOF_rewrite_record(id, p, size) != 0) return -1;
+        p += size;
+    }
+    return 0;
+}
+
+static void epoch_snapshot_work(uv_work_t *req)
+{
+    epoch_snapshot_t *s = req->data;
+    const char *tmp = g_snap_tmp;
+
+    FILE *out = fopen(tmp, "wb");
+    if (!out) { perror("snapshot/fopen"); s->ok = 0; return; }
+
+    if (g_cur.delta) {
+        if (fwrite(&s->hdr, sizeof s->hdr, 1, out) != 1) s->ok = 0;
+        s->crc    = crc32c(0, &s->hdr, sizeof s->hdr);
+        s->bytes += sizeof s->hdr;
+    }
+
+    /* only the memcpy into `buf` happens under the storage lock;
+       disk I/O runs while the event loop keeps mutating */
+    int more;
+    do {
+        more = storage_snapshot_step(g_storage, stage_record_cb, s,
+                                     SNAPSHOT_STEP_SLOTS);
+        if (s->len && fwrite(s->buf, 1, s->len, out) != s->len) s->ok = 0;
+        if (s->aof && aof_rewrite_staged(s) != 0) s->ok = 0;
+        s->bytes += s->len;
+        __atomic_store_n(&g_snap.progress_bytes, s->bytes, __ATOMIC_RELAXED);
+        s->len = 0;
+    } while (more && s->ok);
+
+    if (s->ok && fwrite(&s->crc, 4, 1, out) != 1) s->ok = 0;   /* footer */
+    s->bytes += 4;
+    if (s->ok && (fflush(out) || fsync(fileno(out)))) s->ok = 0;
+    fclose(out);
+
+    if (s->ok && rename(tmp, s->path) != 0) s->ok = 0;
+    if (!s->ok) {
+        fprintf(stderr, "❌ epoch snapshot failed, keeping previous RDB\n");
+        unlink(tmp);
+    }
+}
+
+/* record the outcome of the snapshot that just finished */
+static void snapshot_finished(int status, uint64_t bytes)
+{
+    if (status == 0) {
+        if (g_cur.delta) {
+            g_chain_len = g_cur.seq;
+        } else if (read_footer(g_rdb_path, &g_base_crc) == 0) {
+            g_have_base = 1;
+            drop_deltas();                   /* consolidated into base */
+        }
+        g_force_full = 0;
+    } else {
+        /* the dirty set handed to this snapshot is gone: rebuild the base */
+        g_force_full = 1;
+    }
+    g_snap.chain_len = g_chain_len;
+
+    g_snap.in_progress      = 0;
+    g_snap.child_pid        = 0;
+    g_snap.last_status      = status;
+    g_snap.last_duration_us = (uv_hrtime() - g_snap_t0) / 1000;
+    g_snap.last_bytes       = bytes;
+    g_snap.last_finished    = (int64_t)time(NULL);
+    if (status == 0) g_snap.succeeded++;
+    else             g_snap.failed++;
+}
+
+static void epoch_snapshot_done(uv_work_t *req, int status)
+{
+    (void)status;
+    epoch_snapshot_t *s = req->data;
+
+    storage_snapshot_end(g_storage);        /* also handles aborts */
+    snapshot_finished(s->ok ? 0 : 1, s->ok ? s->bytes : 0);
+
+    free(s->buf);
+    free(s);
+}
+
+static void start_epoch_snapshot(void)
+{
+    epoch_snapshot_t *s = calloc(1, sizeof *s);
+    if (!s) { snapshot_finished(-1, 0); return; }
+
+    /* the checkpoint interval restarts here: later writes go to the next delta */
+    int rc;
+    if (g_cur.delta) {
+        size_t n;
+        int *keys = storage_dirty_take(g_storage, &n);
+        rc = storage_snapshot_begin_keys(g_storage, keys, n);
+
+        memcpy(s->hdr.magic, DELTA_MAGIC, sizeof s->hdr.magic);
+        s->hdr.base_crc = g_base_crc;
+        s->hdr.seq      = g_cur.seq;
+        delta_path(s->path, sizeof s->path, g_cur.seq);
+    } else {
+        storage_dirty_reset(g_storage);
+        rc = storage_snapshot_begin(g_storage);
+        snprintf(s->path, sizeof s->path, "%s", g_rdb_path);
+    }
+    if (rc != 0) { free(s); snapshot_finished(-1, 0); return; }
+
+    s->ok = 1;
+    s->req.data = s;
+
+    g_snap.last_fork_us = (uv_hrtime() - g_snap_t0) / 1000;
+    uv_queue_work(uv_default_loop(), &s->req,
+                  epoch_snapshot_work, epoch_snapshot_done);
+}
+
+/* ──────────────────────────────────────────────────────────── */
+/* 4.   Forked snapshot – child dumps its COW copy             */
+static void fork_snapshot_child(void)
+{
+    char path[512];
+    /* only this thread was copied: a lock another loop held at fork
+       stays held here, so read the table without locking */
+    storage_set_shared(g_storage, 0);
+
+    FILE *out = fopen(g_snap_tmp, "wb");
+    if (!out) _exit(1);
+
+    uint32_t crc;
+    if (g_cur.delta) {                           /* only what changed */
+        delta_header_t h;
+        memcpy(h.magic, DELTA_MAGIC, sizeof h.magic);
+        h.base_crc = g_base_crc;
+        h.seq      = g_cur.seq;
+        fwrite(&h, sizeof h, 1, out);
+        crc = crc32c(0, &h, sizeof h);
+        storage_iterate_dirty_crc(g_storage, out, &crc);
+        delta_path(path, sizeof path, g_cur.seq);
+    } else {
+        storage_iterate_crc(g_storage, out, &crc);
+        snprintf(path, sizeof path, "%s", g_rdb_path);
+    }
+    fwrite(&crc, 4, 1, out);                     /* footer */
+
+    if (fflush(out) || fsync(fileno(out)) || ferror(out)) _exit(2);
+    fclose(out);
+
+    if (rename(g_snap_tmp, path) != 0) _exit(3);
+    _exit(0);
+}
+
+/* SIGCHLD: reap the snapshot child and record how it went */
+static void sigchld_cb(uv_signal_t *h, int signum)
+{
+    (void)h; (void)signum;
+    if (!g_snap.child_pid) return;
+
+    int st;
+    pid_t pid;
+    do pid = waitpid(g_snap.child_pid, &st, WNOHANG);
+    while (pid < 0 && errno == EINTR);
+    if (pid == 0) return;                        /* still running   */
+
+    int status = pid < 0             ? -1 :
+                 WIFEXITED(st)       ? WEXITSTATUS(st) :
+                 WIFSIGNALED(st)     ? 128 + WTERMSIG(st) : -1;
+
+    uint64_t bytes = 0;
+    struct stat sb;
+    char path[512];
+    if (g_cur.delta) delta_path(path, sizeof path, g_cur.seq);
+    else             snprintf(path, sizeof path, "%s", g_rdb_path);
+    if (status == 0 && stat(path, &sb) == 0) bytes = (uint64_t)sb.st_size;
+
+    if (status != 0)
+        fprintf(stderr, "❌ snapshot child %d failed (status %d)\n",
+                (int)g_snap.child_pid, status);
+    snapshot_finished(status, bytes);
+}
+
+static void start_fork_snapshot(void)
+{
+    /* with several loops on the table: no write half applied at fork, and
+       none between fork and the dirty reset (it would be in neither delta) */
+    storage_key_lock_all(g_storage);
+    pid_t pid = fork();
+    if (pid == 0) fork_snapshot_child();        /* never returns   */
+
+    g_snap.last_fork_us = (uv_hrtime() - g_snap_t0) / 1000;
+    if (pid < 0) {
+        storage_key_unlock_all(g_storage);
+        perror("fork");
+        snapshot_finished(-1, 0);
+        return;
+    }
+    g_snap.child_pid = pid;
+
+    /* the child owns the dirty set now; writes from here on are the next delta */
+    storage_dirty_reset(g_storage);
+    storage_key_unlock_all(g_storage);
+}
+
+/* ──────────────────────────────────────────────────────────── */
+/* 5.   Periodic snapshot – one at a time                      */
 static void snapshot_cb(uv_timer_t *t)
 {
     (void)t;
-    pid_t pid = fork();
-    if (pid < 0) { perror("fork"); return; }
+    if (g_snap.in_progress) { g_snap.skipped++; return; }
 
-    if (pid == 0) {                              /* child */
-        char tmp[512];
-        snprintf(tmp, sizeof tmp, "%s.tmp", g_rdb_path);
+    /* delta when a base exists, the chain is short and the dirty set is
+       small; otherwise consolidate everything into a new full base */
+    size_t dirty = storage_dirty_count(g_storage);
+    int    clean = g_have_base && !g_force_full;
+    if (clean && dirty == 0) return;             /* nothing to checkpoint */
 
-        FILE *out = fopen(tmp, "wb");
-        if (!out) _exit(1);
+    g_cur.delta = clean && g_chain_len < DELTA_CHAIN_MAX &&
+                  dirty * 2 < g_storage->size;
+    g_cur.seq   = g_chain_len + 1;
+    if (g_cur.delta) {
+        delta_path(g_snap_tmp, sizeof g_snap_tmp, g_cur.seq);
+        strncat(g_snap_tmp, ".tmp", sizeof g_snap_tmp - strlen(g_snap_tmp) - 1);
+    } else {
+        snprintf(g_snap_tmp, sizeof g_snap_tmp, "%s.tmp", g_rdb_path);
+    }
 
-        uint32_t crc;
-        storage_iterate_crc(g_storage, out, &crc);
-        fwrite(&crc, 4, 1, out);                 /* footer */
+    g_snap.in_progress    = 1;
+    g_snap.last_delta     = g_cur.delta;
+    g_snap.started++;
+    g_snap.progress_bytes = 0;
+    g_snap_t0             = uv_hrtime();
 
-        fflush(out); fsync(fileno(out));
-        fclose(out);
+    if (g_snapshot_mode == SNAPSHOT_EPOCH) start_epoch_snapshot();
+    else                                   start_fork_snapshot();
+}
+
+void Persistence_snapshot_stats(snapshot_stats_t *out)
+{
+    *out = g_snap;
+    out->mode = g_snapshot_mode;
+    out->progress_bytes = g_snap.in_progress
+                        ? __atomic_load_n(&g_snap.progress_bytes, __ATOMIC_RELAXED)
+                        : 0;
 
-        rename(tmp, g_rdb_path);
-        _exit(0);
+    /* a forked child reports progress through the size of its tmp file */
+    if (g_snap.in_progress && g_snapshot_mode == SNAPSHOT_FORK) {
+        struct stat sb;
+        out->progress_bytes = stat(g_snap_tmp, &sb) == 0 ? (uint64_t)sb.st_size : 0;
     }
-    /* parent: reap immediately (non-blocking) */
-    waitpid(pid, NULL, WNOHANG);
+    if (g_snap.in_progress)
+        out->running_us = (uv_hrtime() - g_snap_t0) / 1000;
+}
+
+/* ──────────────────────────────────────────────────────────── */
+/* 6.   Worker → loop calls                                    */
+/* Snapshot bookkeeping and the storage snapshot belong to the loop
+   thread; a worker that needs them runs a step there and waits.  */
+typedef struct { void (*fn)(void *); void *arg; int done; } loop_call_t;
+
+static uv_async_t      g_loop_call_async;
+static pthread_mutex_t g_loop_call_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_loop_call_cond = PTHREAD_COND_INITIALIZER;
+static loop_call_t    *g_loop_call;
+
+static void loop_call_cb(uv_async_t *h)
+{
+    (void)h;
+    pthread_mutex_lock(&g_loop_call_lock);
+    loop_call_t *c = g_loop_call;
+    if (c) {
+        c->fn(c->arg);
+        c->done     = 1;
+        g_loop_call = NULL;
+        pthread_cond_broadcast(&g_loop_call_cond);
+    }
+    pthread_mutex_unlock(&g_loop_call_lock);
+}
+
+/* never from the loop thread itself */
+static void run_on_loop(void (*fn)(void *), void *arg)
+{
+    loop_call_t c = { fn, arg, 0 };
+
+    pthread_mutex_lock(&g_loop_call_lock);
+    while (g_loop_call) pthread_cond_wait(&g_loop_call_cond, &g_loop_call_lock);
+    g_loop_call = &c;
+    uv_async_send(&g_loop_call_async);
+    while (!c.done) pthread_cond_wait(&g_loop_call_cond, &g_loop_call_lock);
+    pthread_mutex_unlock(&g_loop_call_lock);
 }
 
 /* ──────────────────────────────────────────────────────────── */
@@ -121,19 +545,29 @@ void Persistence_init(const char *rdb_path,
                       const char *aof_path,
                       Storage    *storage,
                       unsigned    snapshot_interval_sec,
+                      snapshot_mode_t snapshot_mode,
                       unsigned    aof_flush_ms)
 {
     g_rdb_path = strdup(rdb_path);
     g_storage  = storage;
+    g_snapshot_mode = snapshot_mode;
 
-    /* 1) Restore from snapshot */
+    /* 1) Restore from snapshot (base + deltas); that state is on disk */
     load_rdb(storage);
+    storage_dirty_reset(storage);
+    g_snap.chain_len = g_chain_len;
 
     /* 2) Start AOF engine & replay */
     AOF_init(aof_path, 1 << 16, aof_flush_ms);
     AOF_load(storage);
 
     /* 3) Periodic snapshot timer (in each worker) */
+    uv_async_init(uv_default_loop(), &g_loop_call_async, loop_call_cb);
+    uv_unref((uv_handle_t *)&g_loop_call_async);
+
+    uv_signal_init(uv_default_loop(), &g_sigchld);
+    uv_signal_start(&g_sigchld, sigchld_cb, SIGCHLD);
+
     uv_timer_init(uv_default_loop(), &g_snapshot_timer);
     uv_timer_start(&g_snapshot_timer,
                    snapshot_cb,
@@ -147,23 +581,78 @@ void Persistence_shutdown(void)
     AOF_shutdown();
 }
 
-/* compact invoked via /admin/compact handler */
-void Persistence_compact(void)
+/* ──────────────────────────────────────────────────────────── */
+/* 7.   Compaction – a full snapshot that also rewrites the AOF,
+ *      run by a thread-pool worker (blocking route)            */
+/* s->ok: 1 started, 0 busy, -1 the new AOF could not be opened */
+static void compact_begin(void *arg)
 {
-    /* 1) synchronous RDB rewrite */
-    char tmp_rdb[512];
-    snprintf(tmp_rdb, sizeof tmp_rdb, "%s.tmp", g_rdb_path);
+    epoch_snapshot_t *s = arg;
+    if (g_snap.in_progress) return;                               /* busy */
 
-    FILE *out = fopen(tmp_rdb, "wb");
-    if (out) {
-        uint32_t crc;
-        storage_iterate_crc(g_storage, out, &crc);
-        fwrite(&crc, 4, 1, out);
-        fflush(out); fsync(fileno(out));
-        fclose(out);
-        rename(tmp_rdb, g_rdb_path);
+    /* same frozen view for both files; later writes land in the
+       AOF capture and in the next delta.  Other loops' writers are held
+       so none is logged before the capture but applied after the view */
+    storage_key_lock_all(g_storage);
+    int rc = AOF_rewrite_begin();
+    if (rc == 0) {
+        storage_dirty_reset(g_storage);
+        storage_snapshot_begin(g_storage);
+    }
+    storage_key_unlock_all(g_storage);
+    if (rc != 0) { s->ok = rc < 0 ? -1 : 0; return; }
+
+    g_cur.delta = 0;
+    snprintf(g_snap_tmp, sizeof g_snap_tmp, "%s.compact.tmp", g_rdb_path);
+    snprintf(s->path, sizeof s->path, "%s", g_rdb_path);
+
+    g_snap.in_progress    = 1;
+    g_snap.last_delta     = 0;
+    g_snap.started++;
+    g_snap.progress_bytes = 0;
+    g_snap_t0             = uv_hrtime();
+    g_snap.last_fork_us   = 0;
+    s->ok = 1;
+}
+
+static void compact_end(void *arg)
+{
+    epoch_snapshot_t *s = arg;
+    storage_snapshot_end(g_storage);
+
+    storage_key_lock_all(g_storage);        /* no append mid-capture */
+    int aof_ok = AOF_rewrite_end(s->ok) == 0;
+    storage_key_unlock_all(g_storage);
+    snapshot_finished(s->ok ? 0 : 1, s->ok ? s->bytes : 0);
+    s->ok = s->ok && aof_ok;
+}
+
+int Persistence_compact(void)
+{
+    epoch_snapshot_t *s = calloc(1, sizeof *s);
+    if (!s) return -1;
+    s->aof = 1;
+    s->req.data = s;
+
+    run_on_loop(compact_begin, s);
+    if (s->ok != 1) {
+        int rc = s->ok == 0 ? 1 : -1;
+        if (rc < 0) fprintf(stderr, "❌ Compaction failed: cannot open the new AOF\n");
+        free(s);
+        return rc;
     }
 
-    /* 2) AOF rewrite */
-    AOF_rewrite(g_storage);
+    printf("🔄 Compacting RDB + AOF …\n");
+    epoch_snapshot_work(&s->req);
+    if (s->ok && AOF_rewrite_catch_up() != 0) s->ok = 0;
+    run_on_loop(compact_end, s);
+    AOF_rewrite_close();
+
+    int rc = s->ok ? 0 : -1;
+    if (rc == 0) printf("✓ Compaction complete (%llu bytes)\n",
+                        (unsigned long long)s->bytes);
+    else         fprintf(stderr, "❌ Compaction failed\n");
+    free(s->buf);
+    free(s);
+    return rc;
 }
@@ -3,14 +3,48 @@
 
 #include "storage.h"
 
+/// How the periodic RDB snapshot is taken
+typedef enum {
+    SNAPSHOT_FORK  = 0,   ///< fork() a child that dumps its COW copy
+    SNAPSHOT_EPOCH = 1    ///< background thread streams a frozen Storage view
+} snapshot_mode_t;
+
+/// Snapshot supervision counters (GET /admin/snapshot)
+typedef struct {
+    snapshot_mode_t mode;
+    int       in_progress;       ///< at most one snapshot runs at a time
+    unsigned  chain_len;         ///< deltas currently layered on the base
+    int       child_pid;         ///< forked writer, 0 if none
+    uint64_t  started;
+    uint64_t  succeeded;
+    uint64_t  failed;
+    uint64_t  skipped;           ///< timer ticks dropped while one ran
+    uint64_t  progress_bytes;    ///< bytes written by the running snapshot
+    uint64_t  running_us;        ///< age of the running snapshot
+    int       last_delta;        ///< last run wrote a delta (0 = full base)
+    int       last_status;       ///< child exit code (128+sig if killed)
+    uint64_t  last_fork_us;      ///< fork() / storage_snapshot_begin() stall
+    uint64_t  last_duration_us;
+    uint64_t  last_bytes;
+    int64_t   last_finished;     ///< unix time, 0 if none yet
+} snapshot_stats_t;
+
 /// Load RDB, replay AOF, start snapshot timer & AOF batch thread
 void Persistence_init(const char *rdb_path,
                       const char *aof_path,
                       Storage    *storage,
                       unsigned    snapshot_interval_sec,
+                      snapshot_mode_t snapshot_mode,
                       unsigned    aof_flush_ms);
 
-void Persistence_compact(void);
+/// Rewrite the RDB base and the AOF from one point-in-time view of the
+/// storage.  Blocks for the whole rewrite: call it from a thread-pool
+/// worker (a ROUTE_BLOCKING handler), never from the event loop, which
+/// only runs the short begin/end steps.  Returns 0 when done, 1 if a
+/// snapshot or compaction is already running, -1 on failure.
+int  Persistence_compact(void);
+/// Copy the current snapshot counters into `out`
+void Persistence_snapshot_stats(snapshot_stats_t *out);
 /// Flush and stop the batch AOF thread (call on shutdown)
 void Persistence_shutdown(void);
 
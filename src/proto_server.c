@@ -0,0 +1,255 @@
+// proto_server.c
+#include "proto_server.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <uv.h>
+#include "http_server.h"
+#include "slab_alloc.h"
+
+#define PROTO_READ_SIZE  (64 * 1024)        // loop read buffer
+#define PROTO_OUT_HIGH   (4 * 1024 * 1024)  // stop reading while this much output waits
+#define PROTO_BUF_KEEP   (64 * 1024)        // drained buffers above this are freed
+
+/* ─── one connection ──────────────────────────────────────────────── */
+
+typedef struct {
+    uv_tcp_t               handle;
+    const proto_handler_t *h;
+    proto_buf_t            pending;   // unfinished request carried to the next read
+    proto_buf_t            out;       // answers not yet handed to the socket
+    proto_buf_t            wbuf;      // the write in flight
+    uv_write_t             write_req;
+    int                    writing;
+    int                    reading;
+    int                    closing;   // process() said -1: close once out is written
+} proto_conn_t;
+
+typedef struct {
+    int                    port;
+    const proto_handler_t *h;
+} proto_server_t;
+
+static proto_server_t servers[PROTO_MAX_SERVERS];
+static int server_count = 0;
+
+static __thread char *proto_read_buf = NULL;
+
+static void proto_flush(proto_conn_t *c);
+
+static void buf_trim(proto_buf_t *b) {
+    if (b->len == 0 && b->cap > PROTO_BUF_KEEP) {
+        free(b->data);
+        b->data = NULL;
+        b->cap = 0;
+    }
+}
+
+static void proto_close_cb(uv_handle_t *handle) {
+    proto_conn_t *c = (proto_conn_t *)handle->data;
+    free(c->pending.data);
+    free(c->out.data);
+    free(c->wbuf.data);
+    slab_free(c);
+}
+
+static void proto_close(proto_conn_t *c) {
+    if (uv_is_closing((uv_handle_t *)&c->handle)) return;
+    uv_close((uv_handle_t *)&c->handle, proto_close_cb);
+}
+
+/* ─── input ───────────────────────────────────────────────────────── */
+
+static void proto_alloc_cb(uv_handle_t *handle, size_t suggested, uv_buf_t *buf) {
+    (void)handle;
+    (void)suggested;
+    *buf = uv_buf_init(proto_read_buf, PROTO_READ_SIZE);
+}
+
+static void proto_read_cb(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
+    proto_conn_t *c = (proto_conn_t *)stream->data;
+    if (nread < 0) {
+        proto_close(c);
+        return;
+    }
+    if (nread == 0) return;
+
+    // Straight from the loop buffer, unless part of a request waits
+    const char *data = buf->base;
+    size_t len = (size_t)nread;
+    if (c->pending.len) {
+        char *dst = proto_buf_reserve(&c->pending, len);
+        if (!dst) {
+            proto_close(c);
+            return;
+        }
+        memcpy(dst, data, len);
+        c->pending.len += len;
+        data = c->pending.data;
+        len = c->pending.len;
+    }
+
+    ssize_t used = c->h->process(data, len, &c->out);
+    if (used < 0) {
+        c->closing = 1;
+        c->reading = 0;
+        uv_read_stop(stream);
+        proto_flush(c);
+        return;
+    }
+
+    // Keep the unfinished tail for the next read
+    size_t left = len - (size_t)used;
+    if (left > c->h->max_request) {
+        fprintf(stderr, "[%s] Request over %zu bytes, closing\n", c->h->name, c->h->max_request);
+        proto_close(c);
+        return;
+    }
+    if (data == c->pending.data) {
+        memmove(c->pending.data, data + used, left);
+        c->pending.len = left;
+        buf_trim(&c->pending);
+    } else if (left) {
+        char *dst = proto_buf_reserve(&c->pending, left);
+        if (!dst) {
+            proto_close(c);
+            return;
+        }
+        memcpy(dst, data + used, left);
+        c->pending.len = left;
+    }
+
+    // Everything this read answered goes out in one write
+    proto_flush(c);
+
+    // A client that does not read its answers stops being read
+    if (c->writing && c->out.len >= PROTO_OUT_HIGH) {
+        c->reading = 0;
+        uv_read_stop(stream);
+    }
+}
+
+/* ─── output ──────────────────────────────────────────────────────── */
+
+static void proto_write_cb(uv_write_t *req, int status) {
+    proto_conn_t *c = (proto_conn_t *)req->data;
+    c->writing = 0;
+    c->wbuf.len = 0;
+    buf_trim(&c->wbuf);
+    if (status < 0) {
+        proto_close(c);
+        return;
+    }
+
+    proto_flush(c);
+    if (!c->reading && !c->closing && !uv_is_closing((uv_handle_t *)&c->handle) &&
+        c->out.len < PROTO_OUT_HIGH) {
+        c->reading = 1;
+        if (uv_read_start((uv_stream_t *)&c->handle, proto_alloc_cb, proto_read_cb) < 0) {
+            proto_close(c);
+        }
+    }
+}
+
+// Try the socket directly; what it does not take is written from a
+// second buffer while `out` collects the next answers
+static void proto_flush(proto_conn_t *c) {
+    if (c->writing || uv_is_closing((uv_handle_t *)&c->handle)) return;
+    if (c->out.len == 0) {
+        if (c->closing) proto_close(c);
+        return;
+    }
+
+    uv_buf_t b = uv_buf_init(c->out.data, (unsigned int)c->out.len);
+    int n = uv_try_write((uv_stream_t *)&c->handle, &b, 1);
+    if (n < 0 && n != UV_EAGAIN) {
+        proto_close(c);
+        return;
+    }
+    size_t sent = n > 0 ? (size_t)n : 0;
+    if (sent == c->out.len) {
+        c->out.len = 0;
+        buf_trim(&c->out);
+        if (c->closing) proto_close(c);
+        return;
+    }
+
+    proto_buf_t in_flight = c->out;
+    c->out = c->wbuf;
+    c->wbuf = in_flight;
+    b = uv_buf_init(c->wbuf.data + sent, (unsigned int)(c->wbuf.len - sent));
+    c->write_req.data = c;
+    c->writing = 1;
+    if (uv_write(&c->write_req, (uv_stream_t *)&c->handle, &b, 1, proto_write_cb) < 0) {
+        c->writing = 0;
+        proto_close(c);
+    }
+}
+
+/* ─── listening ───────────────────────────────────────────────────── */
+
+static void proto_accept_cb(uv_stream_t *server, int status) {
+    if (status < 0) return;
+    proto_server_t *s = (proto_server_t *)server->data;
+
+    proto_conn_t *c = slab_alloc(sizeof(*c));
+    if (!c) {
+        fprintf(stderr, "[%s] Out of memory for connection\n", s->h->name);
+        return;
+    }
+    memset(c, 0, sizeof(*c));
+    c->h = s->h;
+    uv_tcp_init(server->loop, &c->handle);
+    c->handle.data = c;
+
+    if (uv_accept(server, (uv_stream_t *)&c->handle) != 0) {
+        proto_close(c);
+        return;
+    }
+    uv_tcp_nodelay(&c->handle, 1);
+    c->reading = 1;
+    if (uv_read_start((uv_stream_t *)&c->handle, proto_alloc_cb, proto_read_cb) < 0) {
+        proto_close(c);
+    }
+}
+
+// Event-loop hook: this loop's listener for every registered protocol
+static void proto_loop_start(uv_loop_t *loop, int index) {
+    if (!proto_read_buf) proto_read_buf = slab_alloc(PROTO_READ_SIZE);
+    if (!proto_read_buf) {
+        fprintf(stderr, "Failed to allocate the protocol read buffer\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < server_count; i++) {
+        proto_server_t *s = &servers[i];
+        int fd = http_server_listen_socket(s->port);
+        if (fd < 0) {
+            fprintf(stderr, "[%s] Bind to port %d failed: %s\n",
+                    s->h->name, s->port, uv_strerror(fd));
+            exit(1);
+        }
+
+        uv_tcp_t *server = slab_alloc(sizeof(uv_tcp_t));
+        uv_tcp_init(loop, server);
+        uv_tcp_open(server, fd);
+        server->data = s;
+        int rc = uv_listen((uv_stream_t *)server, 8192, proto_accept_cb);
+        if (rc != 0) {
+            fprintf(stderr, "[%s] Listen failed: %s\n", s->h->name, uv_strerror(rc));
+            exit(1);
+        }
+        if (index == 0) {
+            printf("🔌 %s protocol listening on port %d\n", s->h->name, s->port);
+        }
+    }
+}
+
+int proto_server_add(int port, const proto_handler_t *h) {
+    if (server_count == PROTO_MAX_SERVERS) return -1;
+    if (server_count == 0) http_server_on_loop_start(proto_loop_start);
+    servers[server_count].port = port;
+    servers[server_count].h = h;
+    server_count++;
+    return 0;
+}
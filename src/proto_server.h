@@ -0,0 +1,56 @@
+// proto_server.h
+#ifndef PROTO_SERVER_H
+#define PROTO_SERVER_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+/// Request/response TCP protocols served next to HTTP (the binary
+/// protocol, RESP) on the same event loops: every loop of every worker
+/// listens on the protocol's port with SO_REUSEPORT, like HTTP does.
+/// The connection code (accept, input carried between reads, output
+/// batched per read, backpressure, close) is shared; a protocol only
+/// turns complete requests into responses.  Connections use libuv
+/// streams whatever the HTTP socket backend.
+
+#define PROTO_MAX_SERVERS 4
+
+/// Output assembled for one connection; grows on demand
+typedef struct {
+    char  *data;
+    size_t len;
+    size_t cap;
+} proto_buf_t;
+
+/// Room for `need` more bytes at data + len (the caller advances len),
+/// or NULL when out of memory
+static inline char *proto_buf_reserve(proto_buf_t *b, size_t need) {
+    if (b->cap - b->len < need) {
+        size_t cap = b->cap ? b->cap * 2 : 4096;
+        while (cap < b->len + need) cap *= 2;
+        char *data = realloc(b->data, cap);
+        if (!data) return NULL;
+        b->data = data;
+        b->cap = cap;
+    }
+    return b->data + b->len;
+}
+
+typedef struct {
+    const char *name;      ///< for log lines
+    /// Answer the complete requests at the front of data[0..len) into
+    /// `out` and return the bytes they took; an unfinished request is
+    /// handed back, with more bytes behind it, after the next read.
+    /// -1 closes the connection once `out` is written.  Runs on a loop
+    /// thread, several at once with --threads.
+    ssize_t   (*process)(const char *data, size_t len, proto_buf_t *out);
+    size_t      max_request;  ///< a longer unfinished request closes the connection
+} proto_handler_t;
+
+/// Serve `h` on `port` from every event loop of this worker.  Call
+/// before http_server_init (the loops start listening as they come up).
+/// Returns 0, or -1 when PROTO_MAX_SERVERS are registered already.
+int proto_server_add(int port, const proto_handler_t *h);
+
+#endif // PROTO_SERVER_H
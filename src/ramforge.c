@@ -11,6 +11,9 @@ static void _get(App *a, const char *p, RouteHandler h){
 static void _post(App *a, const char *p, RouteHandler h){
     register_route("POST", p, h);
 }
+static void _post_blocking(App *a, const char *p, RouteHandler h){
+    register_route_flags("POST", p, h, ROUTE_BLOCKING);
+}
 
 static void start(App *app, int port){
     http_server_init(app, port);
@@ -27,6 +30,7 @@ App *RamForge_create_custom(const char *aof_file_path){
 
     app->get      = _get;
     app->post     = _post;
+    app->post_blocking = _post_blocking;
     app->start    = start;
     app->shutdown = shutdown_hook;
     return app;
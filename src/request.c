@@ -1,26 +1,31 @@
 // request.c
 #include "request.h"
-#include "slab_alloc.h"
 #include <string.h>
 
-Request parse_request(const char* body) {
+Request parse_request(const char* body, size_t body_len, arena_t* arena) {
     Request req;
     req.param_count = 0;
-    if (body) {
-        size_t len = strlen(body) + 1;
-        // allocate via slab (fast, no heap fragmentation)
-        char *copy = slab_alloc(len);
-        memcpy(copy, body, len);
-        req.body = copy;
-    } else {
-        req.body = NULL;
-    }
+    req.query = NULL;
+    req.body = (char*)body;
+    req.body_len = body ? body_len : 0;
+    req.arena = arena;
     return req;
 }
 
-void free_request(Request* req) {
-    if (req->body) {
-        slab_free(req->body);
-        req->body = NULL;
+const char *request_query(const Request *req, const char *name, size_t *len) {
+    size_t name_len = strlen(name);
+    const char *p = req->query;
+
+    while (p && *p) {
+        const char *end = strchr(p, '&');
+        if (!end) end = p + strlen(p);
+        if ((size_t)(end - p) >= name_len && memcmp(p, name, name_len) == 0 &&
+            (p[name_len] == '=' || p + name_len == end)) {
+            const char *value = p + name_len + (p[name_len] == '=');
+            *len = (size_t)(end - value);
+            return value;
+        }
+        p = *end ? end + 1 : end;
     }
+    return NULL;
 }
@@ -1,6 +1,9 @@
 #ifndef REQUEST_H
 #define REQUEST_H
 
+#include <stddef.h>
+#include "arena.h"
+
 #define MAX_ROUTE_PARAMS 10
 #define MAX_PARAM_LEN    64
 
@@ -12,12 +15,17 @@ typedef struct {
 typedef struct {
     int            param_count;
     RequestParam   params[MAX_ROUTE_PARAMS];
-    char          *body;
+    const char    *query;     // after '?' in the URL (not decoded), or NULL
+    char          *body;      // borrowed from the connection, NUL-terminated
+    size_t         body_len;
+    arena_t       *arena;     // per-request scratch, reset after the response
 } Request;
 
-// Parse the raw body into a Request
-Request parse_request(const char *body);
-// Free any allocated memory inside Request
-void    free_request(Request *req);
+// Wrap the raw body in a Request (no copy: valid until the arena resets)
+Request parse_request(const char *body, size_t body_len, arena_t *arena);
+
+// Raw value of query parameter `name` (a slice of the URL, `*len` bytes,
+// not NUL-terminated), or NULL when absent
+const char *request_query(const Request *req, const char *name, size_t *len);
 
 #endif // REQUEST_H
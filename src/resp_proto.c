@@ -0,0 +1,335 @@
+// resp_proto.c
+#include "resp_proto.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "user.h"
+
+#define SCAN_COUNT_DEFAULT 10
+
+typedef struct {
+    const char *p;      // into the read buffer: nothing is copied
+    size_t      len;
+} resp_arg_t;
+
+static Storage *resp_storage = NULL;
+
+void resp_proto_init(Storage *st) {
+    resp_storage = st;
+}
+
+/* ─── parsing ─────────────────────────────────────────────────────── */
+
+// "<digits>\r\n" at p: 1 with *v and *next set, 0 if the line is not all
+// there yet, -1 if it is not a number
+static int parse_number_line(const char *p, const char *end, long long *v, const char **next) {
+    const char *nl = memchr(p, '\r', (size_t)(end - p));
+    if (!nl || nl + 1 >= end) return (end - p > 24) ? -1 : 0;
+    if (nl[1] != '\n') return -1;
+
+    int neg = (p < nl && *p == '-');
+    const char *q = p + neg;
+    if (q == nl || nl - q > 18) return -1;
+    long long n = 0;
+    for (; q < nl; q++) {
+        if (*q < '0' || *q > '9') return -1;
+        n = n * 10 + (*q - '0');
+    }
+    *v = neg ? -n : n;
+    *next = nl + 2;
+    return 1;
+}
+
+// One multibulk command ("*<n>\r\n" then n × "$<len>\r\n<bytes>\r\n"):
+// its length, 0 if incomplete, -1 on a protocol error.  `total` is the
+// argument count; only the first RESP_MAX_ARGS land in argv.
+static ssize_t parse_multibulk(const char *data, size_t len, resp_arg_t *argv, int *total) {
+    const char *end = data + len;
+    const char *p;
+    long long n;
+    int rc = parse_number_line(data + 1, end, &n, &p);
+    if (rc <= 0) return rc;
+    if (n > RESP_MAX_REQUEST) return -1;
+
+    *total = n > 0 ? (int)n : 0;
+    for (long long i = 0; i < n; i++) {
+        if (p == end) return 0;
+        if (*p != '$') return -1;
+        long long blen;
+        rc = parse_number_line(p + 1, end, &blen, &p);
+        if (rc <= 0) return rc;
+        if (blen < 0 || blen > RESP_MAX_REQUEST) return -1;
+        if (end - p < blen + 2) return 0;
+        if (p[blen] != '\r' || p[blen + 1] != '\n') return -1;
+        if (i < RESP_MAX_ARGS) {
+            argv[i].p = p;
+            argv[i].len = (size_t)blen;
+        }
+        p += blen + 2;
+    }
+    return p - data;
+}
+
+// An inline command: one line, arguments split on blanks
+static ssize_t parse_inline(const char *data, size_t len, resp_arg_t *argv, int *total) {
+    const char *nl = memchr(data, '\n', len);
+    if (!nl) return 0;
+    const char *end = (nl > data && nl[-1] == '\r') ? nl - 1 : nl;
+
+    *total = 0;
+    for (const char *p = data; p < end; ) {
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+        if (p == end) break;
+        const char *start = p;
+        while (p < end && *p != ' ' && *p != '\t') p++;
+        if (*total < RESP_MAX_ARGS) {
+            argv[*total].p = start;
+            argv[*total].len = (size_t)(p - start);
+        }
+        (*total)++;
+    }
+    return nl + 1 - data;
+}
+
+/* ─── replies ─────────────────────────────────────────────────────── */
+
+static int put(proto_buf_t *out, const char *s, size_t n) {
+    char *dst = proto_buf_reserve(out, n);
+    if (!dst) return -1;
+    memcpy(dst, s, n);
+    out->len += n;
+    return 0;
+}
+
+// "<prefix><n>\r\n": integers, array and bulk headers
+static int put_number(proto_buf_t *out, char prefix, long long n) {
+    char line[32];
+    int len = snprintf(line, sizeof(line), "%c%lld\r\n", prefix, n);
+    return put(out, line, (size_t)len);
+}
+
+static int put_bulk(proto_buf_t *out, const char *s, size_t n) {
+    char *dst = proto_buf_reserve(out, n + 32);
+    if (!dst) return -1;
+    int hdr = snprintf(dst, 32, "$%zu\r\n", n);
+    memcpy(dst + hdr, s, n);
+    memcpy(dst + hdr + n, "\r\n", 2);
+    out->len += (size_t)hdr + n + 2;
+    return 0;
+}
+
+#define put_literal(out, s) put(out, s, sizeof(s) - 1)
+
+static int put_error(proto_buf_t *out, const char *fmt, const char *arg, size_t arg_len) {
+    char line[160];
+    int len = snprintf(line, sizeof(line), fmt, (int)(arg_len > 64 ? 64 : arg_len), arg);
+    if (len < 0 || (size_t)len >= sizeof(line) - 2) len = (int)sizeof(line) - 3;
+    memcpy(line + len, "\r\n", 2);
+    return put(out, line, (size_t)len + 2);
+}
+
+/* ─── commands ────────────────────────────────────────────────────── */
+
+static int arg_is(const resp_arg_t *a, const char *name) {
+    size_t n = strlen(name);
+    return a->len == n && strncasecmp(a->p, name, n) == 0;
+}
+
+// The user id a key names: its trailing digits
+static int key_id(const resp_arg_t *k, int *id) {
+    size_t i = k->len;
+    while (i > 0 && k->p[i - 1] >= '0' && k->p[i - 1] <= '9') i--;
+    if (i == k->len) return -1;
+
+    long long v = 0;
+    for (size_t j = i; j < k->len; j++) {
+        v = v * 10 + (k->p[j] - '0');
+        if (v > INT_MAX) return -1;
+    }
+    *id = (int)v;
+    return 0;
+}
+
+#define ERR_KEY "-ERR key must end in a user id (0..2147483647)"
+
+static int cmd_get_one(const resp_arg_t *key, proto_buf_t *out) {
+    int id;
+    if (key_id(key, &id) < 0) return put_literal(out, ERR_KEY "\r\n");
+    User u;
+    if (!storage_get(resp_storage, id, &u, sizeof(u))) return put_literal(out, "$-1\r\n");
+    return put_bulk(out, u.name, strnlen(u.name, sizeof(u.name) - 1));
+}
+
+// Checked before anything is written, so a bad pair stores nothing
+static int check_pair(const resp_arg_t *kv, proto_buf_t *out, int *bad) {
+    int id;
+    *bad = 1;
+    if (key_id(&kv[0], &id) < 0) return put_literal(out, ERR_KEY "\r\n");
+    if (kv[1].len >= MAX_NAME_LEN) return put_literal(out, "-ERR value longer than 63 bytes\r\n");
+    *bad = 0;
+    return 0;
+}
+
+static int store_pair(const resp_arg_t *kv) {
+    User u;
+    memset(&u, 0, sizeof(u));
+    key_id(&kv[0], &u.id);
+    memcpy(u.name, kv[1].p, kv[1].len);
+    return user_save(resp_storage, &u);
+}
+
+static int cmd_set_pairs(const resp_arg_t *kv, int pairs, proto_buf_t *out) {
+    int bad;
+    for (int i = 0; i < pairs; i++) {
+        if (check_pair(&kv[2 * i], out, &bad) < 0) return -1;
+        if (bad) return 0;
+    }
+    for (int i = 0; i < pairs; i++) {
+        if (store_pair(&kv[2 * i]) < 0) return put_literal(out, "-ERR disk full, write not logged\r\n");
+    }
+    return put_literal(out, "+OK\r\n");
+}
+
+static int cmd_del(const resp_arg_t *keys, int n, proto_buf_t *out) {
+    long long removed = 0;
+    for (int i = 0; i < n; i++) {
+        int id;
+        if (key_id(&keys[i], &id) < 0) continue;    // names no user, so nothing to remove
+        int rc = user_remove(resp_storage, id);
+        if (rc < 0) return put_literal(out, "-ERR disk full, write not logged\r\n");
+        removed += rc;
+    }
+    return put_number(out, ':', removed);
+}
+
+typedef struct {
+    int   *ids;
+    size_t n, cap;
+} scan_keys_t;
+
+static void scan_collect(int id, const void *data, size_t size, void *ud) {
+    (void)data;
+    (void)size;
+    scan_keys_t *k = (scan_keys_t *)ud;
+    if (k->n == k->cap) {
+        size_t cap = k->cap ? k->cap * 2 : 64;
+        int *ids = realloc(k->ids, cap * sizeof(*ids));
+        if (!ids) return;
+        k->ids = ids;
+        k->cap = cap;
+    }
+    k->ids[k->n++] = id;
+}
+
+static int cmd_scan(const resp_arg_t *argv, int argc, proto_buf_t *out) {
+    char num[24];
+    size_t cursor = 0, count = SCAN_COUNT_DEFAULT;
+
+    if (argv[1].len == 0 || argv[1].len >= sizeof(num)) return put_literal(out, "-ERR invalid cursor\r\n");
+    memcpy(num, argv[1].p, argv[1].len);
+    num[argv[1].len] = '\0';
+    char *end;
+    cursor = strtoull(num, &end, 10);
+    if (*end) return put_literal(out, "-ERR invalid cursor\r\n");
+
+    for (int i = 2; i < argc; i += 2) {
+        if (i + 1 >= argc) return put_literal(out, "-ERR syntax error\r\n");
+        if (!arg_is(&argv[i], "COUNT")) return put_literal(out, "-ERR only COUNT is supported\r\n");
+        if (argv[i + 1].len == 0 || argv[i + 1].len >= sizeof(num)) return put_literal(out, "-ERR syntax error\r\n");
+        memcpy(num, argv[i + 1].p, argv[i + 1].len);
+        num[argv[i + 1].len] = '\0';
+        count = strtoull(num, &end, 10);
+        if (*end || count == 0) return put_literal(out, "-ERR syntax error\r\n");
+    }
+
+    scan_keys_t keys = { 0 };
+    size_t next = storage_scan(resp_storage, cursor, count, scan_collect, &keys);
+
+    int rc = put_literal(out, "*2\r\n");
+    int len = snprintf(num, sizeof(num), "%zu", next);
+    if (rc == 0) rc = put_bulk(out, num, (size_t)len);
+    if (rc == 0) rc = put_number(out, '*', (long long)keys.n);
+    for (size_t i = 0; rc == 0 && i < keys.n; i++) {
+        len = snprintf(num, sizeof(num), "%d", keys.ids[i]);
+        rc = put_bulk(out, num, (size_t)len);
+    }
+    free(keys.ids);
+    return rc;
+}
+
+// One command: 0, -1 when out of memory, 1 to close the connection
+static int exec_command(const resp_arg_t *argv, int argc, proto_buf_t *out) {
+    const resp_arg_t *cmd = &argv[0];
+
+    if (arg_is(cmd, "GET") && argc == 2) {
+        return cmd_get_one(&argv[1], out);
+    }
+    if (arg_is(cmd, "SET") && argc == 3) {
+        return cmd_set_pairs(&argv[1], 1, out);
+    }
+    if (arg_is(cmd, "MGET") && argc >= 2) {
+        if (put_number(out, '*', argc - 1) < 0) return -1;
+        for (int i = 1; i < argc; i++) {
+            if (cmd_get_one(&argv[i], out) < 0) return -1;
+        }
+        return 0;
+    }
+    if (arg_is(cmd, "MSET") && argc >= 3 && argc % 2 == 1) {
+        return cmd_set_pairs(&argv[1], (argc - 1) / 2, out);
+    }
+    if (arg_is(cmd, "DEL") && argc >= 2) {
+        return cmd_del(&argv[1], argc - 1, out);
+    }
+    if (arg_is(cmd, "SCAN") && argc >= 2) {
+        return cmd_scan(argv, argc, out);
+    }
+    if (arg_is(cmd, "PING") && argc <= 2) {
+        return argc == 2 ? put_bulk(out, argv[1].p, argv[1].len) : put_literal(out, "+PONG\r\n");
+    }
+    if (arg_is(cmd, "QUIT")) {
+        return put_literal(out, "+OK\r\n") < 0 ? -1 : 1;
+    }
+    // What clients and redis-benchmark ask on connect
+    if (arg_is(cmd, "COMMAND") || arg_is(cmd, "CONFIG")) {
+        return put_literal(out, "*0\r\n");
+    }
+
+    static const char* const known[] = { "GET", "SET", "MGET", "MSET", "DEL", "SCAN", "PING" };
+    for (size_t i = 0; i < sizeof(known) / sizeof(known[0]); i++) {
+        if (arg_is(cmd, known[i])) {
+            return put_error(out, "-ERR wrong number of arguments for '%.*s' command", cmd->p, cmd->len);
+        }
+    }
+    return put_error(out, "-ERR unknown command '%.*s'", cmd->p, cmd->len);
+}
+
+ssize_t resp_proto_process(const char *data, size_t len, proto_buf_t *out) {
+    resp_arg_t argv[RESP_MAX_ARGS];
+    size_t off = 0;
+
+    while (off < len) {
+        int argc = 0;
+        ssize_t n = data[off] == '*' ? parse_multibulk(data + off, len - off, argv, &argc)
+                                     : parse_inline(data + off, len - off, argv, &argc);
+        if (n == 0) break;                  // the rest of the command is still coming
+        if (n < 0) {
+            put_literal(out, "-ERR Protocol error\r\n");
+            return -1;
+        }
+        off += (size_t)n;
+        if (argc == 0) continue;            // blank line or empty array
+
+        int rc = argc > RESP_MAX_ARGS ? put_literal(out, "-ERR too many arguments\r\n")
+                                      : exec_command(argv, argc, out);
+        if (rc != 0) return -1;             // out of memory, or QUIT
+    }
+    return (ssize_t)off;
+}
+
+const proto_handler_t resp_proto_handler = {
+        .name        = "RESP",
+        .process     = resp_proto_process,
+        .max_request = RESP_MAX_REQUEST
+};
@@ -0,0 +1,38 @@
+// resp_proto.h
+#ifndef RESP_PROTO_H
+#define RESP_PROTO_H
+
+#include "proto_server.h"
+#include "storage.h"
+
+/// Redis protocol (RESP2) listener (--resp-port), so redis-benchmark,
+/// redis-cli and pipelining client libraries work against the store.
+///
+/// A key names a user id by its trailing decimal digits, whatever comes
+/// before them: "42", "user:42" and redis-benchmark's "key:000000000042"
+/// are all user 42.  A value is the user's name (at most MAX_NAME_LEN - 1
+/// bytes).  Commands:
+///
+///   PING [msg]   GET key   SET key value   DEL key [key ...]
+///   MGET key [key ...]   MSET key value [key value ...]
+///   SCAN cursor [COUNT n]    (keys come back as plain ids)
+///   QUIT, and COMMAND / CONFIG GET answered with an empty array
+///
+/// Writes take the same AOF-first path as POST /users; DEL logs a
+/// removal record.  MSET is not atomic: an AOF failure part-way leaves
+/// the pairs before it stored.  Commands are parsed in place in the read
+/// buffer (multibulk, and inline commands for telnet); a command cut by a
+/// read is picked up again when the rest arrives.
+
+#define RESP_MAX_ARGS    1024          ///< more arguments are refused
+#define RESP_MAX_REQUEST (1024 * 1024) ///< longest command that can be buffered
+
+/// Serve commands against `st` (the AOF must be initialised)
+void resp_proto_init(Storage *st);
+
+/// proto_handler_t.process for RESP
+ssize_t resp_proto_process(const char *data, size_t len, proto_buf_t *out);
+
+extern const proto_handler_t resp_proto_handler;
+
+#endif // RESP_PROTO_H
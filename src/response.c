@@ -2,11 +2,45 @@
 #include "response.h"
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
-// No heap here—writes directly into the Response’s fixed buffer.
+int response_reserve(Response* res, size_t need) {
+    if (res->capacity - res->len >= need) return 0;
+    if (!res->grow) return -1;
+    return res->grow(res, need);
+}
+
+void response_write(Response* res, const void* data, size_t n) {
+    if (response_reserve(res, n) < 0) {
+        n = res->capacity - res->len;
+    }
+    memcpy(res->buffer + res->len, data, n);
+    res->len += n;
+}
+
+void response_stream(Response* res, response_stream_fn fn, void* state) {
+    res->len = 0;
+    res->stream = fn;
+    res->stream_state = state;
+}
+
+// No heap here—writes directly into the Response's buffer.
 void response_json(Response* res, const char* fmt, ...) {
     va_list args;
     va_start(args, fmt);
-    vsnprintf(res->buffer, RESPONSE_BUFFER_SIZE, fmt, args);
+    int n = vsnprintf(res->buffer, res->capacity, fmt, args);
     va_end(args);
+    if (n < 0) n = 0;
+
+    if ((size_t)n >= res->capacity) {
+        res->len = 0;
+        if (response_reserve(res, (size_t)n + 1) == 0) {
+            va_start(args, fmt);
+            vsnprintf(res->buffer, res->capacity, fmt, args);
+            va_end(args);
+        } else {
+            n = res->capacity ? (int)res->capacity - 1 : 0;
+        }
+    }
+    res->len = (size_t)n;
 }
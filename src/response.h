@@ -1,13 +1,49 @@
 #ifndef RESPONSE_H
 #define RESPONSE_H
 
-#define RESPONSE_BUFFER_SIZE 4096
+#include <stddef.h>
 
-typedef struct {
-    char buffer[RESPONSE_BUFFER_SIZE];
-} Response;
+#define RESPONSE_BUFFER_SIZE 4096   // room a handler can count on without reserving
 
-// Format JSON (or any text) into res->buffer
+typedef struct Response Response;
+
+/// Enlarge the room behind res->buffer to at least `need` more bytes,
+/// keeping what was written.  Returns 0, or -1 if it cannot.
+typedef int (*response_grow_fn)(Response *res, size_t need);
+
+/// Producer for a streamed body: fill `chunk` (fixed capacity, cannot
+/// grow) and return 1 while more remains, 0 once done.  Called again
+/// only after the previous chunk was written to the socket.
+typedef int (*response_stream_fn)(void *state, Response *chunk);
+
+/// A handler writes its body straight into the connection's output
+/// buffer (the HTTP headers are filled in in front of it afterwards)
+/// and records how much it wrote in `len`.
+struct Response {
+    char             *buffer;    // body starts here
+    size_t            len;       // body bytes written so far
+    size_t            capacity;  // room at buffer
+    response_grow_fn  grow;      // NULL: fixed capacity
+    void             *owner;     // for grow()
+    response_stream_fn stream;   // set by response_stream()
+    void             *stream_state;
+};
+
+// Make room for `need` more bytes after res->len.  Returns 0, or -1
+// when the body cannot grow that far.
+int  response_reserve(Response *res, size_t need);
+
+// Append raw bytes (truncated if no room can be made)
+void response_write(Response *res, const void *data, size_t n);
+
+// Append a string literal (length known at compile time)
+#define response_literal(res, lit) response_write((res), "" lit, sizeof(lit) - 1)
+
+// Send the body as HTTP/1.1 chunks pulled from `fn` instead of `buffer`.
+// `state` must outlive the request: allocate it from the request arena.
+void response_stream(Response *res, response_stream_fn fn, void *state);
+
+// Format JSON (or any text) as the whole body
 void response_json(Response *res, const char *fmt, ...);
 
 #endif // RESPONSE_H
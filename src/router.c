@@ -27,6 +27,7 @@ typedef struct TrieNode {
     struct TrieNode    *children;    // first child (linked list)
     struct TrieNode    *sibling;     // next sibling in list
     RouteHandler        handler;     // non-NULL if a route ends here
+    int                 flags;       // ROUTE_* annotations of that route
 } TrieNode;
 
 /// One root per HTTP method
@@ -47,6 +48,7 @@ static TrieNode *create_node(const char *segment, bool is_param) {
     TrieNode *n = malloc(sizeof(*n));
     n->is_param   = is_param;
     n->handler    = NULL;
+    n->flags      = 0;
     n->children   = NULL;
     n->sibling    = NULL;
     if (is_param) {
@@ -70,6 +72,14 @@ void router_init(void) {
 void register_route(const char *method,
                     const char *path,
                     RouteHandler handler)
+{
+    register_route_flags(method, path, handler, 0);
+}
+
+void register_route_flags(const char *method,
+                          const char *path,
+                          RouteHandler handler,
+                          int flags)
 {
     int mi = method_index(method);
     if (mi < 0) return;  // unsupported method
@@ -118,36 +128,37 @@ void register_route(const char *method,
     // At final node, attach the handler
     if (node) {
         node->handler = handler;
+        node->flags   = flags;
     }
 }
 
-/// Match an incoming request path and invoke the handler
-int route_request(const char *method,
-                   const char *path,
-                   const char *body,
-                   char       *response_buffer)
+/// Walk the method trie for `path`, filling `req`; NULL if no route ends there
+static TrieNode *match_node(int mi,
+                            const char *path,
+                            const char *body,
+                            size_t      body_len,
+                            arena_t    *arena,
+                            Request    *req)
 {
-    int mi = method_index(method);
-    if (mi < 0) {
-        sprintf(response_buffer,
-                "{\"error\":\"Unsupported method '%s'\"}",
-                method);
-        return -2;
-    }
-
-    // Split incoming path into segments
-    char *segments[MAX_PATH_SEGMENTS];
-    int   seg_count = 0;
-    char *pcopy = strdup(path), *saveptr = NULL, *seg = NULL;
-    seg = strtok_r(pcopy, "/", &saveptr);
-    while (seg && seg_count < MAX_PATH_SEGMENTS) {
-        segments[seg_count++] = seg;
-        seg = strtok_r(NULL, "/", &saveptr);
+    // Split incoming path into segments (slices of `path`, no copy)
+    const char *segments[MAX_PATH_SEGMENTS];
+    size_t      seg_lens[MAX_PATH_SEGMENTS];
+    int         seg_count = 0;
+    // up to the query string, if any
+    const char *query = strchr(path, '?');
+    const char *path_end = query ? query : path + strlen(path);
+    for (const char *p = path; p < path_end && seg_count < MAX_PATH_SEGMENTS; ) {
+        while (p < path_end && *p == '/') p++;
+        if (p == path_end) break;
+        const char *start = p;
+        while (p < path_end && *p != '/') p++;
+        segments[seg_count]   = start;
+        seg_lens[seg_count++] = (size_t)(p - start);
     }
 
     // Prepare Request struct
-    Request req = parse_request(body);
-    req.param_count = 0;
+    *req = parse_request(body, body_len, arena);
+    req->query = query ? query + 1 : NULL;
 
     // Traverse trie
     TrieNode *child_list = method_roots[mi];
@@ -155,10 +166,13 @@ int route_request(const char *method,
     for (int i = 0; i < seg_count; i++) {
         TrieNode *cur = child_list;
         TrieNode *param_match = NULL;
+        node = NULL;
 
         // Try to match static first, then param
         while (cur) {
-            if (!cur->is_param && strcmp(cur->segment, segments[i]) == 0) {
+            if (!cur->is_param
+                && strncmp(cur->segment, segments[i], seg_lens[i]) == 0
+                && cur->segment[seg_lens[i]] == '\0') {
                 node = cur;
                 break;
             }
@@ -169,39 +183,67 @@ int route_request(const char *method,
         }
         if (!node) {
             // fallback to parameter if available
-            if (param_match) {
+            if (param_match && req->param_count < MAX_ROUTE_PARAMS) {
                 node = param_match;
                 // record param name/value
-                strncpy(req.params[req.param_count].name,
-                        node->param_name,
-                        sizeof(req.params[0].name));
-                strncpy(req.params[req.param_count].value,
-                        segments[i],
-                        sizeof(req.params[0].value));
-                req.param_count++;
+                RequestParam *rp = &req->params[req->param_count++];
+                size_t vlen = seg_lens[i] < sizeof(rp->value) - 1
+                              ? seg_lens[i] : sizeof(rp->value) - 1;
+                strncpy(rp->name, node->param_name, sizeof(rp->name) - 1);
+                rp->name[sizeof(rp->name) - 1] = '\0';
+                memcpy(rp->value, segments[i], vlen);
+                rp->value[vlen] = '\0';
             } else {
-                // no match
-                sprintf(response_buffer, "{\"error\":\"Not found\"}");
-                free(pcopy);
-                free_request(&req);
-                return -1;
+                return NULL;   // no match
             }
         }
         // descend
         child_list = node->children;
     }
-    free(pcopy);
+
+    return (node && node->handler) ? node : NULL;
+}
+
+/// Resolve the handler without invoking it
+RouteHandler route_match(const char *method,
+                         const char *path,
+                         const char *body,
+                         size_t      body_len,
+                         arena_t    *arena,
+                         Request    *req,
+                         int        *flags)
+{
+    int mi = method_index(method);
+    if (mi < 0) return NULL;
+
+    TrieNode *node = match_node(mi, path, body, body_len, arena, req);
+    if (!node) return NULL;
+    *flags = node->flags;
+    return node->handler;
+}
+
+/// Match an incoming request path and invoke the handler
+int route_request(const char *method,
+                   const char *path,
+                   const char *body,
+                   size_t      body_len,
+                   arena_t    *arena,
+                   Response   *res)
+{
+    int mi = method_index(method);
+    if (mi < 0) {
+        response_json(res,
+                      "{\"error\":\"Unsupported method '%s'\"}",
+                      method);
+        return -2;
+    }
 
     // If we found a node with a handler, call it
-    if (node && node->handler) {
-        Response res;
-        memset(&res, 0, sizeof(res));
-        int rc = node->handler(&req, &res);
-        free_request(&req);
-        strcpy(response_buffer, res.buffer);
-        return rc;
+    Request req;
+    TrieNode *node = match_node(mi, path, body, body_len, arena, &req);
+    if (node) {
+        return node->handler(&req, res);
     }
-    free_request(&req);
-    sprintf(response_buffer, "{\"error\":\"Not found\"}");
+    response_json(res, "{\"error\":\"Not found\"}");
     return -1;
 }
@@ -7,6 +7,10 @@
 
 typedef int (*RouteHandler)(Request*, Response*);
 
+/// Route annotations (register_route_flags)
+#define ROUTE_BLOCKING 0x1   ///< may block (disk I/O, fsync): the server runs it
+                             ///< on the libuv thread pool, off the event loop
+
 /// Initialize the router (must call once before registering any routes)
 void router_init(void);
 
@@ -15,11 +19,34 @@ void router_init(void);
 /// Example: register_route("GET", "/users/:id", get_user_handler);
 void register_route(const char* method, const char* path, RouteHandler handler);
 
-/// Match an incoming request and dispatch to the handler, serializing JSON into response_buffer.
-/// If no match is found, returns `{"error":"Not found"}`.
+/// register_route() with ROUTE_* annotations.  A ROUTE_BLOCKING handler runs
+/// on another thread: it must not touch loop-owned state (Storage included)
+/// other than through thread-safe APIs, and cannot stream its body.
+void register_route_flags(const char* method, const char* path,
+                          RouteHandler handler, int flags);
+
+/// Resolve a route without running it, for a caller that decides where the
+/// handler runs: fills `req` as route_request() would and returns the
+/// handler, with its ROUTE_* flags in `*flags`.  Returns NULL when nothing
+/// matches (route_request() then produces the error answer).
+RouteHandler route_match(const char* method,
+                         const char* path,
+                         const char* body,
+                         size_t      body_len,
+                         arena_t*    arena,
+                         Request*    req,
+                         int*        flags);
+
+/// Match an incoming request and dispatch to the handler, which writes its
+/// JSON body into `res`.  `body` (body_len bytes, NUL-terminated) is lent
+/// to the handler, as is `arena` for request-scoped scratch.
+/// A query string in `path` is not matched; it is left in `Request.query`.
+/// If no match is found, the body is `{"error":"Not found"}` and -1 is returned.
 int route_request(const char* method,
                    const char* path,
                    const char* body,
-                   char* response_buffer);
+                   size_t      body_len,
+                   arena_t*    arena,
+                   Response*   res);
 
 #endif // ROUTER_H
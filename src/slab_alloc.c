@@ -1,136 +1,674 @@
 // slab_alloc.c
-#define _POSIX_C_SOURCE 200112L
+#define _GNU_SOURCE
 #include "slab_alloc.h"
+#include "hugepage.h"
+#include "numa_topo.h"
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+
+/*
+ * Layout
+ *
+ *   thread ──► tcache magazine (per class, no locks)
+ *                │ refill / flush in batches
+ *                ▼
+ *              owned pages: avail list ⇄ full list (owner thread only)
+ *                │ adopt                        ▲
+ *                ▼                              │ remote frees: lock-free
+ *              central per-class list           │ push onto the page's
+ *              (abandoned pages, mutex)         │ own `remote` stack
+ *
+ * Every page is owned by at most one thread.  Only the owner touches a
+ * page's local free list, so the fast paths never lock.  A block freed
+ * by another thread is pushed onto the page it came from and collected
+ * by the owner on its next refill.  When a thread exits its pages are
+ * abandoned to the central list and adopted by whoever needs one next.
+ *
+ * Ownership: all slab pages are carved from one reserved virtual arena,
+ * so slab_free() classifies a pointer with a range check and never reads
+ * memory it does not own.  Anything outside the arena came from the
+ * huge-class path: an mmap with a tagged header in front of the block.
+ *
+ * Reclaim: each page counts the blocks it has handed out.  slab_trim()
+ * (driven by a timer on the owning loop) releases pages that stayed
+ * empty for several consecutive passes with MADV_DONTNEED, keeping one
+ * empty page per class as a reserve.  Released pages are reused for any
+ * class before the arena grows.
+ */
 
 /// --- Configuration ---
-/// List of size-classes (bytes); must be ascending.
+/// Size classes: 16-byte steps up to 128, then four classes per power
+/// of two (quarter steps) up to 4096.  Worst-case internal waste is
+/// ~20% instead of ~50% with pure powers of two; a 68-byte User now
+/// takes an 80-byte block instead of 128 + header.
 static const size_t size_classes[] = {
-        64, 128, 256, 512, 1024, 2048, 4096
+          16,   32,   48,   64,   80,   96,  112,  128,
+         160,  192,  224,  256,  320,  384,  448,  512,
+         640,  768,  896, 1024, 1280, 1536, 1792, 2048,
+        2560, 3072, 3584, 4096
 };
+/* an int, like the class indices that loop over it */
 #define NUM_CLASSES \
-    (sizeof(size_classes)/sizeof(size_classes[0]))
+    ((int)(sizeof(size_classes)/sizeof(size_classes[0])))
+#define SLAB_MAX    4096
+
+#define MAG_CAP     64          /* blocks cached per thread per class */
+#define MAG_BATCH   (MAG_CAP/2) /* moved per refill / flush           */
+
+#define ARENA_RESERVE   (64ull << 30)  /* virtual only (MAP_NORESERVE)  */
+#define ARENA_MIN       (1ull  << 30)  /* give up halving below this    */
+
+#define HUGE_MAGIC      0x52464855474521ull     /* "!EGUHFR" */
+#define HUGE_CACHE      8                       /* recycled mappings     */
+#define HUGE_CACHE_MAX  (1u << 20)              /* larger ones are unmapped */
 
 /// We'll carve each slab page from a 64 KiB chunk
 static size_t PAGE_SIZE;
 static size_t PAGE_MASK;
 
-/// Header prepended to each block in a slab
+/// Blocks carry no header: the page metadata identifies the class, and
+/// a free block's first word threads it onto a free list.
 typedef struct slab_header {
     struct slab_header *next_free;
 } slab_header;
 
+struct slab_heap;
+
 /// Metadata at start of each slab page
 typedef struct slab_page {
-    struct slab_page     *next;
+    struct slab_page     *next;         // owner's avail/full list, or central
+    struct slab_page     *prev;
     int                   class_idx;
+    int                   full;         // on the owner's full list
+    unsigned              used;         // blocks out of the page (owner-only)
+    unsigned              idle_passes;  // consecutive trims seen empty
+    _Atomic(struct slab_heap *) owner;  // NULL while abandoned
+    slab_header          *free;         // owner-only free list
+    _Atomic(slab_header *) remote;      // frees from other threads
 } slab_page;
 
-/// One slab class descriptor
+/// One slab class descriptor (shared by all threads)
 typedef struct {
-    size_t         block_size;    // size_classes[i]
-    slab_header   *free_list;     // singly-linked free blocks
-    slab_page     *pages;         // list of allocated pages
+    size_t          block_size;    // size_classes[i]
+    size_t          per_page;      // blocks carved per page
+    pthread_mutex_t lock;          // guards `abandoned`
+    slab_page      *abandoned;     // pages whose owner thread exited
+    atomic_size_t   pages;         // pages currently carved for the class
 } slab_class;
 
+/// Header in front of every huge-class block (keeps 16-byte alignment)
+typedef struct huge_header {
+    struct huge_header *prev, *next;    // live list, for slab_destroy()
+    size_t              map_len;        // whole mapping, header included
+    uint64_t            magic;          // HUGE_MAGIC while live
+} huge_header;
+
+/// Per-thread magazine in front of the owned pages
+typedef struct {
+    unsigned  count;
+    void     *slot[MAG_CAP];
+} slab_tcache;
+
+/// Per-thread state.  Heaps are recycled, never freed before destroy,
+/// so a remote free may safely poke a stale owner's `remote_hint`.
+typedef struct slab_heap {
+    struct slab_heap *next;                 // global heap registry
+    int               in_use;
+    slab_tcache       mag[NUM_CLASSES];
+    slab_page        *avail[NUM_CLASSES];   // pages with local free blocks
+    slab_page        *fullp[NUM_CLASSES];   // exhausted pages
+    atomic_uint       remote_hint;          // remote frees since last sweep
+    /* stats: written by the owner only, read by slab_stats() */
+    atomic_size_t     allocs[NUM_CLASSES];
+    atomic_size_t     frees[NUM_CLASSES];
+} slab_heap;
+
 static slab_class classes[NUM_CLASSES];
 
+/// First block starts one cache line past the page metadata
+#define PAGE_HDR    ((sizeof(slab_page) + 63) & ~(size_t)63)
+
+static pthread_mutex_t  g_lock = PTHREAD_MUTEX_INITIALIZER; // heaps + arena bump
+static slab_heap       *g_heaps;
+
+/* the slab arena: [g_arena, g_arena_end), carved bottom-up */
+static char            *g_arena, *g_arena_end, *g_arena_top;
+static size_t           g_arena_len;
+
+/* pages handed back to the OS, reusable by any class (g_lock) */
+static slab_page      **g_released;
+static size_t           g_nreleased, g_released_cap;
+static size_t           g_released_total;
+
+/* huge class: live list + a few recycled mappings */
+static pthread_mutex_t  g_huge_lock = PTHREAD_MUTEX_INITIALIZER;
+static huge_header     *g_huge_live;
+static huge_header     *g_huge_cache[HUGE_CACHE];
+static size_t           g_huge_blocks, g_huge_bytes;
+static size_t           g_os_page;
+static pthread_key_t    g_heap_key;
+static _Thread_local slab_heap *tl_heap;
+
+static void heap_release(void *arg);
+
 void slab_init(void) {
     // Determine page size (multiple of OS page size).
     long ps = sysconf(_SC_PAGESIZE);
     if (ps <= 0) ps = 4096;
     PAGE_SIZE = (size_t)ps * 16;        // 64 KiB on 4 KiB pages
     PAGE_MASK = PAGE_SIZE - 1;
+    g_os_page = (size_t)ps;
+
+    // Reserve the arena (address space only; pages fault in on use).
+    // Over-reserve one alignment unit so the start can be aligned: a
+    // slab page, or a 2 MiB huge page when the huge-page policy is on.
+    size_t align = hugepage_mode() != HUGEPAGE_OFF ? HUGEPAGE_SIZE : PAGE_SIZE;
+    for (size_t len = ARENA_RESERVE; len >= ARENA_MIN && !g_arena; len /= 2) {
+        void *m = mmap(NULL, len + align, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (m == MAP_FAILED) continue;
+        g_arena_len = len + align;
+        g_arena     = m;
+        g_arena_top = (char*)(((uintptr_t)m + align - 1) & ~(uintptr_t)(align - 1));
+        g_arena_end = g_arena_top + len;
+    }
+    // Slab pages are carved bottom-up, so 32 of them share one THP.
+    // (MAP_HUGETLB cannot back a NORESERVE reservation safely, so the
+    // explicit policy also uses THP here.)  slab_trim() of a single
+    // slab page splits its huge page; the kernel re-collapses later.
+    if (g_arena) {
+        hugepage_advise(g_arena_top, (size_t)(g_arena_end - g_arena_top));
+        numa_topo_bind(g_arena, g_arena_len);   // pages fault in on our node
+    }
 
     // Initialize each size class
     for (int i = 0; i < NUM_CLASSES; i++) {
         classes[i].block_size = size_classes[i];
-        classes[i].free_list  = NULL;
-        classes[i].pages      = NULL;
+        classes[i].per_page   = (PAGE_SIZE - PAGE_HDR) / size_classes[i];
+        classes[i].abandoned  = NULL;
+        atomic_store(&classes[i].pages, 0);
+        pthread_mutex_init(&classes[i].lock, NULL);
     }
+    pthread_key_create(&g_heap_key, heap_release);
 }
 
-static int find_class(size_t size) {
-    for (int i = 0; i < NUM_CLASSES; i++) {
-        if (size <= classes[i].block_size)
-            return i;
-    }
-    return -1;  // larger than max class
+/// O(1) class lookup mirroring the size_classes[] layout
+static inline int find_class(size_t size) {
+    if (size <= 128) return size ? (int)((size - 1) >> 4) : 0;
+    if (size > SLAB_MAX) return -1;     // larger than max class
+    unsigned e = 63u - (unsigned)__builtin_clzll(size - 1);  // 2^e < size ≤ 2^(e+1)
+    return (int)(8 + (e - 7) * 4 + ((size - 1 - ((size_t)1 << e)) >> (e - 2)));
 }
 
-void *slab_alloc(size_t size) {
-    int ci = find_class(size);
-    if (ci < 0) {
-        // fallback for large allocations
-        void *p = malloc(size);
-        return p;
+/* ─── page lists (owner thread only) ──────────────────────────────── */
+
+static void list_push(slab_page **head, slab_page *pg) {
+    pg->prev = NULL;
+    pg->next = *head;
+    if (*head) (*head)->prev = pg;
+    *head = pg;
+}
+
+static void list_unlink(slab_page **head, slab_page *pg) {
+    if (pg->prev) pg->prev->next = pg->next;
+    else          *head          = pg->next;
+    if (pg->next) pg->next->prev = pg->prev;
+    pg->next = pg->prev = NULL;
+}
+
+/* pull everything other threads freed into the page's local list */
+static int page_collect(slab_page *pg) {
+    slab_header *r = atomic_exchange_explicit(&pg->remote, NULL,
+                                              memory_order_acquire);
+    if (!r) return 0;
+    unsigned n = 1;
+    slab_header *tail = r;
+    while (tail->next_free) { tail = tail->next_free; n++; }
+    tail->next_free = pg->free;
+    pg->free = r;
+    pg->used -= n;
+    return 1;
+}
+
+/* owned page just gained a free block */
+static void page_mark_avail(slab_heap *hp, slab_page *pg) {
+    if (!pg->full) return;
+    list_unlink(&hp->fullp[pg->class_idx], pg);
+    pg->full = 0;
+    list_push(&hp->avail[pg->class_idx], pg);
+}
+
+static void page_take(slab_heap *hp, slab_page *pg) {
+    atomic_store_explicit(&pg->owner, hp, memory_order_release);
+    page_collect(pg);
+    pg->full = 0;
+    list_push(&hp->avail[pg->class_idx], pg);
+}
+
+/* ─── obtaining pages ─────────────────────────────────────────────── */
+
+static slab_page *page_carve(int ci) {
+    // reuse a released page, else bump one off the arena (already aligned)
+    pthread_mutex_lock(&g_lock);
+    char *mem = NULL;
+    if (g_nreleased) {
+        mem = (char*)g_released[--g_nreleased];
+    } else if (g_arena_top && g_arena_top + PAGE_SIZE <= g_arena_end) {
+        mem = g_arena_top;
+        g_arena_top += PAGE_SIZE;
+    }
+    pthread_mutex_unlock(&g_lock);
+    if (!mem) return NULL;
+
+    slab_page *pg = (slab_page*)mem;
+    memset(pg, 0, sizeof *pg);
+    pg->class_idx = ci;
+    atomic_fetch_add_explicit(&classes[ci].pages, 1, memory_order_relaxed);
+
+    // carve it into blocks (16-byte aligned: every class is a multiple of 16)
+    size_t bs         = classes[ci].block_size;
+    size_t max_blocks = classes[ci].per_page;
+
+    char *blk = mem + PAGE_HDR;
+    for (size_t j = 0; j < max_blocks; j++) {
+        slab_header *hdr = (slab_header*)blk;
+        hdr->next_free   = pg->free;
+        pg->free         = hdr;
+        blk += bs;
     }
+    return pg;
+}
+
+static slab_page *page_adopt(int ci) {
     slab_class *cl = &classes[ci];
+    pthread_mutex_lock(&cl->lock);
+    slab_page *pg = cl->abandoned;
+    if (pg) cl->abandoned = pg->next;
+    pthread_mutex_unlock(&cl->lock);
+    return pg;
+}
+
+/* move remote frees of exhausted pages back into the avail list */
+static void heap_sweep(slab_heap *hp, int ci) {
+    slab_page *pg = hp->fullp[ci];
+    while (pg) {
+        slab_page *next = pg->next;
+        if (page_collect(pg)) page_mark_avail(hp, pg);
+        pg = next;
+    }
+}
+
+/* ─── thread heaps ────────────────────────────────────────────────── */
 
-    // Refill from a new page if empty
-    if (!cl->free_list) {
-        // allocate one big slab page, page-aligned
-        void *mem;
-        if (posix_memalign(&mem, PAGE_SIZE, PAGE_SIZE) != 0)
-            return malloc(size);  // fallback on failure
-
-        slab_page *pg = (slab_page*)mem;
-        pg->next      = cl->pages;
-        pg->class_idx = ci;
-        cl->pages     = pg;
-
-        // carve it into blocks
-        size_t header_sz = sizeof(slab_header);
-        size_t bs        = cl->block_size + header_sz;
-        size_t max_blocks = (PAGE_SIZE - sizeof(slab_page)) / bs;
-
-        char *blk = (char*)mem + sizeof(slab_page);
-        for (size_t j = 0; j < max_blocks; j++) {
-            slab_header *hdr = (slab_header*)blk;
-            hdr->next_free   = cl->free_list;
-            cl->free_list    = hdr;
-            blk += bs;
+static slab_heap *heap_get(void) {
+    if (tl_heap) return tl_heap;
+
+    pthread_mutex_lock(&g_lock);
+    slab_heap *hp = g_heaps;
+    while (hp && hp->in_use) hp = hp->next;
+    if (!hp) {
+        hp = calloc(1, sizeof *hp);
+        if (!hp) { pthread_mutex_unlock(&g_lock); return NULL; }
+        hp->next = g_heaps;
+        g_heaps  = hp;
+    }
+    hp->in_use = 1;
+    pthread_mutex_unlock(&g_lock);
+
+    tl_heap = hp;
+    pthread_setspecific(g_heap_key, hp);
+    return hp;
+}
+
+/* return a cached block to its (owned) page */
+static void block_return(slab_heap *hp, void *blk) {
+    slab_header *h  = (slab_header*)blk;
+    slab_page   *pg = (slab_page*)((uintptr_t)blk & ~PAGE_MASK);
+    h->next_free = pg->free;
+    pg->free     = h;
+    pg->used--;
+    page_mark_avail(hp, pg);
+}
+
+/* thread exit: empty the magazines and abandon every owned page */
+static void heap_release(void *arg) {
+    slab_heap *hp = arg;
+    for (int ci = 0; ci < NUM_CLASSES; ci++) {
+        slab_tcache *tc = &hp->mag[ci];
+        while (tc->count) block_return(hp, tc->slot[--tc->count]);
+
+        slab_page **lists[2] = { &hp->avail[ci], &hp->fullp[ci] };
+        for (int l = 0; l < 2; l++) {
+            slab_page *pg;
+            while ((pg = *lists[l])) {
+                list_unlink(lists[l], pg);
+                atomic_store_explicit(&pg->owner, NULL, memory_order_release);
+                pthread_mutex_lock(&classes[ci].lock);
+                pg->next = classes[ci].abandoned;
+                classes[ci].abandoned = pg;
+                pthread_mutex_unlock(&classes[ci].lock);
+            }
         }
     }
+    atomic_store(&hp->remote_hint, 0);
+
+    pthread_mutex_lock(&g_lock);
+    hp->in_use = 0;
+    pthread_mutex_unlock(&g_lock);
+    if (tl_heap == hp) tl_heap = NULL;
+}
+
+/* ─── huge class: one mapping per block ───────────────────────────── */
+
+static void *huge_alloc(size_t size) {
+    size_t len = (size + sizeof(huge_header) + g_os_page - 1) & ~(g_os_page - 1);
+    huge_header *hh = NULL;
+
+    pthread_mutex_lock(&g_huge_lock);
+    for (int i = 0; i < HUGE_CACHE; i++) {          // exact-length reuse
+        if (g_huge_cache[i] && g_huge_cache[i]->map_len == len) {
+            hh = g_huge_cache[i];
+            g_huge_cache[i] = NULL;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_huge_lock);
+
+    if (!hh) {
+        void *m = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m == MAP_FAILED) return NULL;
+        hh = m;
+        hh->map_len = len;
+    }
+    hh->magic = HUGE_MAGIC;
+
+    pthread_mutex_lock(&g_huge_lock);
+    hh->prev = NULL;
+    hh->next = g_huge_live;
+    if (g_huge_live) g_huge_live->prev = hh;
+    g_huge_live = hh;
+    g_huge_blocks++;
+    g_huge_bytes += hh->map_len;
+    pthread_mutex_unlock(&g_huge_lock);
+    return hh + 1;
+}
+
+static void huge_free(void *ptr) {
+    huge_header *hh = (huge_header*)ptr - 1;
+    if (hh->magic != HUGE_MAGIC) abort();           // not ours / double free
+    hh->magic = 0;
+
+    pthread_mutex_lock(&g_huge_lock);
+    if (hh->prev) hh->prev->next = hh->next;
+    else          g_huge_live    = hh->next;
+    if (hh->next) hh->next->prev = hh->prev;
+    g_huge_blocks--;
+    g_huge_bytes -= hh->map_len;
+
+    if (hh->map_len <= HUGE_CACHE_MAX) {
+        for (int i = 0; i < HUGE_CACHE; i++) {
+            if (!g_huge_cache[i]) {
+                g_huge_cache[i] = hh;
+                hh = NULL;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_huge_lock);
+    if (hh) munmap(hh, hh->map_len);
+}
+
+static inline int in_arena(const void *p) {
+    return (const char*)p >= g_arena && (const char*)p < g_arena + g_arena_len;
+}
+
+/* ─── alloc / free ────────────────────────────────────────────────── */
+
+static int tcache_refill(slab_heap *hp, int ci) {
+    slab_tcache *tc = &hp->mag[ci];
+
+    for (;;) {
+        slab_page *pg = hp->avail[ci];
+        if (!pg) {
+            if (atomic_exchange(&hp->remote_hint, 0)) {
+                heap_sweep(hp, ci);
+                pg = hp->avail[ci];
+            }
+            if (!pg && (pg = page_adopt(ci))) page_take(hp, pg);
+            if (!pg && (pg = page_carve(ci))) page_take(hp, pg);
+            if (!pg) return 0;
+        }
+
+        while (tc->count < MAG_BATCH && pg->free) {
+            slab_header *h = pg->free;
+            pg->free = h->next_free;
+            tc->slot[tc->count++] = h;
+            pg->used++;
+        }
+        pg->idle_passes = 0;
+        if (!pg->free && !page_collect(pg)) {   // exhausted
+            list_unlink(&hp->avail[ci], pg);
+            pg->full = 1;
+            list_push(&hp->fullp[ci], pg);
+        }
+        if (tc->count) return 1;
+    }
+}
+
+void *slab_alloc(size_t size) {
+    int ci = find_class(size);
+    if (ci < 0) return huge_alloc(size);   // large allocations
+
+    slab_heap *hp = heap_get();
+    if (!hp) return huge_alloc(size);
+    slab_tcache *tc = &hp->mag[ci];
+
+    // Refill the magazine from owned pages if empty
+    if (!tc->count && !tcache_refill(hp, ci))
+        return huge_alloc(size);  // arena exhausted
+
+    atomic_store_explicit(&hp->allocs[ci],
+        atomic_load_explicit(&hp->allocs[ci], memory_order_relaxed) + 1,
+        memory_order_relaxed);
 
     // Pop one block
-    slab_header *h = cl->free_list;
-    cl->free_list = h->next_free;
-    return (void*)( (char*)h + sizeof(slab_header) );
+    return tc->slot[--tc->count];
 }
 
 void slab_free(void *ptr) {
     if (!ptr) return;
-    // Check if pointer lies within a slab page
-    uintptr_t up = (uintptr_t)ptr;
-    slab_header *h = (slab_header*)(up - sizeof(slab_header));
+    // Outside the arena: must be a huge-class block
+    if (!in_arena(ptr)) { huge_free(ptr); return; }
+
+    slab_header *h = ptr;
     // Compute base of page via alignment
-    uintptr_t page_base = up & ~PAGE_MASK;
-    slab_page *pg = (slab_page*)page_base;
-    // Validate that this page is one we allocated
+    slab_page *pg = (slab_page*)((uintptr_t)ptr & ~PAGE_MASK);
     int ci = pg->class_idx;
-    if (ci >= 0 && ci < NUM_CLASSES) {
-        slab_class *cl = &classes[ci];
-        h->next_free   = cl->free_list;
-        cl->free_list  = h;
-    } else {
-        // fallback (large alloc or invalid)
-        free(ptr);
+
+    slab_heap *hp    = heap_get();
+    slab_heap *owner = atomic_load_explicit(&pg->owner, memory_order_acquire);
+    if (hp) atomic_store_explicit(&hp->frees[ci],
+                atomic_load_explicit(&hp->frees[ci], memory_order_relaxed) + 1,
+                memory_order_relaxed);
+    if (hp && owner == hp) {
+        slab_tcache *tc = &hp->mag[ci];
+        if (tc->count == MAG_CAP) {             // flush the older half
+            for (unsigned i = 0; i < MAG_BATCH; i++)
+                block_return(hp, tc->slot[i]);
+            memmove(tc->slot, tc->slot + MAG_BATCH,
+                    (MAG_CAP - MAG_BATCH) * sizeof tc->slot[0]);
+            tc->count -= MAG_BATCH;
+        }
+        tc->slot[tc->count++] = h;
+        return;
     }
+
+    // remote free: back to the owning page, lock-free
+    slab_header *head = atomic_load_explicit(&pg->remote, memory_order_relaxed);
+    do {
+        h->next_free = head;
+    } while (!atomic_compare_exchange_weak_explicit(&pg->remote, &head, h,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+    if (owner) atomic_fetch_add_explicit(&owner->remote_hint, 1,
+                                         memory_order_relaxed);
 }
 
-void slab_destroy(void) {
-    // Free all pages
-    for (int i = 0; i < NUM_CLASSES; i++) {
-        slab_page *pg = classes[i].pages;
+/* ─── reclaim & stats ─────────────────────────────────────────────── */
+
+/* hand an empty page back to the OS; its address stays reserved */
+static void page_release(slab_page *pg) {
+    atomic_fetch_sub_explicit(&classes[pg->class_idx].pages, 1,
+                              memory_order_relaxed);
+    madvise(pg, PAGE_SIZE, MADV_DONTNEED);
+
+    pthread_mutex_lock(&g_lock);
+    if (g_nreleased == g_released_cap) {
+        size_t cap = g_released_cap ? g_released_cap * 2 : 64;
+        slab_page **v = realloc(g_released, cap * sizeof *v);
+        if (!v) {                       // keep it mapped; just forget it
+            pthread_mutex_unlock(&g_lock);
+            return;
+        }
+        g_released     = v;
+        g_released_cap = cap;
+    }
+    g_released[g_nreleased++] = pg;
+    g_released_total++;
+    pthread_mutex_unlock(&g_lock);
+}
+
+size_t slab_trim(unsigned idle_passes) {
+    slab_heap *hp = heap_get();
+    if (!hp) return 0;
+    size_t released = 0;
+
+    for (int ci = 0; ci < NUM_CLASSES; ci++) {
+        // cached blocks would keep their pages looking busy
+        slab_tcache *tc = &hp->mag[ci];
+        while (tc->count) block_return(hp, tc->slot[--tc->count]);
+        atomic_store(&hp->remote_hint, 0);
+        heap_sweep(hp, ci);
+
+        int reserve = 1;                // one empty page stays warm
+        slab_page *pg = hp->avail[ci];
         while (pg) {
             slab_page *next = pg->next;
-            free(pg);
+            page_collect(pg);
+            if (pg->used) {
+                pg->idle_passes = 0;
+            } else if (reserve) {
+                reserve = 0;
+            } else if (++pg->idle_passes >= idle_passes) {
+                list_unlink(&hp->avail[ci], pg);
+                page_release(pg);
+                released++;
+            }
             pg = next;
         }
-        classes[i].pages     = NULL;
-        classes[i].free_list = NULL;
+
+        // pages of exited threads: nobody can hold their blocks once empty
+        slab_class *cl = &classes[ci];
+        pthread_mutex_lock(&cl->lock);
+        slab_page **link = &cl->abandoned;
+        while (*link) {
+            slab_page *a = *link;
+            page_collect(a);
+            if (a->used == 0) {
+                *link = a->next;
+                page_release(a);
+                released++;
+            } else {
+                link = &a->next;
+            }
+        }
+        pthread_mutex_unlock(&cl->lock);
+    }
+    return released;
+}
+
+void slab_stats(slab_stats_t *out) {
+    memset(out, 0, sizeof *out);
+    out->nclasses  = NUM_CLASSES;
+    out->page_size = PAGE_SIZE;
+
+    pthread_mutex_lock(&g_lock);
+    for (int ci = 0; ci < NUM_CLASSES; ci++) {
+        size_t a = 0, f = 0;
+        for (slab_heap *hp = g_heaps; hp; hp = hp->next) {
+            a += atomic_load_explicit(&hp->allocs[ci], memory_order_relaxed);
+            f += atomic_load_explicit(&hp->frees[ci],  memory_order_relaxed);
+        }
+        slab_class_stats_t *c = &out->cls[ci];
+        c->block_size  = classes[ci].block_size;
+        c->pages       = atomic_load_explicit(&classes[ci].pages, memory_order_relaxed);
+        c->live_blocks = a > f ? a - f : 0;
+        size_t total   = c->pages * classes[ci].per_page;
+        c->free_blocks = total > c->live_blocks ? total - c->live_blocks : 0;
+        c->bytes       = c->pages * PAGE_SIZE;
+    }
+    out->arena_pages    = g_arena_top ? (size_t)(g_arena_top - g_arena) / PAGE_SIZE : 0;
+    out->pages_released = g_released_total;
+    out->pages_idle     = g_nreleased;
+    pthread_mutex_unlock(&g_lock);
+
+    pthread_mutex_lock(&g_huge_lock);
+    out->huge_blocks = g_huge_blocks;
+    out->huge_bytes  = g_huge_bytes;
+    pthread_mutex_unlock(&g_huge_lock);
+}
+
+size_t slab_usable_size(const void *ptr) {
+    if (!ptr) return 0;
+    if (!in_arena(ptr)) {
+        const huge_header *hh = (const huge_header*)ptr - 1;
+        return hh->map_len - sizeof *hh;
     }
+    const slab_page *pg = (const slab_page*)((uintptr_t)ptr & ~PAGE_MASK);
+    return classes[pg->class_idx].block_size;
+}
+
+void slab_destroy(void) {
+    // Unmap huge blocks still live or cached
+    pthread_mutex_lock(&g_huge_lock);
+    while (g_huge_live) {
+        huge_header *next = g_huge_live->next;
+        munmap(g_huge_live, g_huge_live->map_len);
+        g_huge_live = next;
+    }
+    g_huge_blocks = g_huge_bytes = 0;
+    for (int i = 0; i < HUGE_CACHE; i++) {
+        if (g_huge_cache[i]) munmap(g_huge_cache[i], g_huge_cache[i]->map_len);
+        g_huge_cache[i] = NULL;
+    }
+    pthread_mutex_unlock(&g_huge_lock);
+
+    // Release the whole arena (every slab page at once)
+    pthread_mutex_lock(&g_lock);
+    if (g_arena) munmap(g_arena, g_arena_len);
+    g_arena = g_arena_top = g_arena_end = NULL;
+    g_arena_len = 0;
+    free(g_released);
+    g_released = NULL;
+    g_nreleased = g_released_cap = 0;
+
+    slab_heap *hp = g_heaps;
+    while (hp) {
+        slab_heap *next = hp->next;
+        free(hp);
+        hp = next;
+    }
+    g_heaps = NULL;
+    pthread_mutex_unlock(&g_lock);
+
+    for (int i = 0; i < NUM_CLASSES; i++)
+        classes[i].abandoned = NULL;
+    tl_heap = NULL;
+    pthread_setspecific(g_heap_key, NULL);
 }
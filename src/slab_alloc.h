@@ -9,14 +9,53 @@
 void slab_init(void);
 
 /// Allocate at least `size` bytes.  Returns a pointer that can
-/// later be freed with slab_free().
+/// later be freed with slab_free().  Requests above the largest size
+/// class get their own mmap (the huge class).
 void *slab_alloc(size_t size);
 
-/// Free a pointer returned by slab_alloc().
+/// Free a pointer returned by slab_alloc().  Any other pointer is a
+/// bug and aborts (the ownership check never reads foreign memory).
 void slab_free(void *ptr);
 
+/// Bytes actually reserved for `ptr` (its size class, or the usable
+/// part of its huge mapping).
+size_t slab_usable_size(const void *ptr);
+
+/// Release slab pages that have been completely free for at least
+/// `idle_passes` consecutive calls (MADV_DONTNEED).  Trims the calling
+/// thread's pages and those of exited threads; one empty page per class
+/// is kept as a reserve.  Returns the number of pages released.
+size_t slab_trim(unsigned idle_passes);
+
+#define SLAB_STATS_MAX_CLASSES 32
+
+/// Per size-class usage
+typedef struct {
+    size_t block_size;
+    size_t pages;          ///< pages currently carved for the class
+    size_t live_blocks;    ///< allocated and not yet freed
+    size_t free_blocks;    ///< carved but unused (cached or on free lists)
+    size_t bytes;          ///< pages × page size (resident upper bound)
+} slab_class_stats_t;
+
+/// Allocator-wide usage (see GET /metrics)
+typedef struct {
+    unsigned           nclasses;
+    size_t             page_size;
+    slab_class_stats_t cls[SLAB_STATS_MAX_CLASSES];
+    size_t             arena_pages;      ///< pages ever carved from the arena
+    size_t             pages_released;   ///< cumulative slab_trim() releases
+    size_t             pages_idle;       ///< released, awaiting reuse
+    size_t             huge_blocks;      ///< live huge-class allocations
+    size_t             huge_bytes;
+} slab_stats_t;
+
+/// Snapshot of the counters above.  Cheap enough for a metrics poll;
+/// live counts are approximate while other threads allocate.
+void slab_stats(slab_stats_t *out);
+
 /// Destroy the slab allocator, freeing all slab pages and any
-/// malloc-fallback blocks that remain.
+/// huge-class blocks that remain.
 void slab_destroy(void);
 
 #endif // SLAB_ALLOC_H
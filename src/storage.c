@@ -1,9 +1,19 @@
 // storage.c
 #include "storage.h"
+#include "slab_alloc.h"
+#include "hugepage.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 
+#define SLOT_NONE SIZE_MAX
+
+/* shared mode: readers share st->rw, mutators hold it exclusively; the
+   snapshot mutex (st->lock) nests inside as before */
+#define READ_LOCK(st)   do { if ((st)->shared) pthread_rwlock_rdlock(&(st)->rw); } while (0)
+#define WRITE_LOCK(st)  do { if ((st)->shared) pthread_rwlock_wrlock(&(st)->rw); } while (0)
+#define UNLOCK(st)      do { if ((st)->shared) pthread_rwlock_unlock(&(st)->rw); } while (0)
+
 /// Simple 32-bit integer mix for hashing
 static inline uint32_t mix32(uint32_t x) {
     x ^= x >> 16;
@@ -14,91 +24,170 @@ static inline uint32_t mix32(uint32_t x) {
     return x;
 }
 
+static inline uint8_t slot_state(const Storage *st, size_t i) {
+    return st->flags[i] & BUCKET_STATE;
+}
+
+/// Table arrays are probed at random: large ones go on huge pages
+/// (per the --hugepages policy) to keep GETs out of the page walker.
+static void alloc_arrays(Storage *st) {
+    st->flags    = hugepage_alloc(st->capacity * sizeof(uint8_t));
+    st->keys     = hugepage_alloc(st->capacity * sizeof(int));
+    st->values   = hugepage_alloc(st->capacity * sizeof(void*));
+    st->val_sizes= hugepage_alloc(st->capacity * sizeof(size_t));
+}
 
+static void free_arrays(uint8_t *flags, int *keys, void **values,
+                        size_t *val_sizes, size_t capacity) {
+    hugepage_free(flags,     capacity * sizeof(uint8_t));
+    hugepage_free(keys,      capacity * sizeof(int));
+    hugepage_free(values,    capacity * sizeof(void*));
+    hugepage_free(val_sizes, capacity * sizeof(size_t));
+}
 
 /// Initialize with a small power-of-two capacity.
 void storage_init(Storage *st) {
     st->capacity = 16;
     st->size     = 0;
-    st->flags    = calloc(st->capacity, sizeof(uint8_t));
-    st->keys     = malloc(st->capacity * sizeof(int));
-    st->values   = malloc(st->capacity * sizeof(void*));
-    st->val_sizes= malloc(st->capacity * sizeof(size_t));
+    st->tombstones = 0;
+    alloc_arrays(st);
+
+    pthread_mutex_init(&st->lock, NULL);
+    st->snap_active  = 0;
+    st->snap_pending = 0;
+    st->snap_cursor  = 0;
+    st->snap_old     = NULL;
+    st->snap_keys    = NULL;
+    st->snap_nkeys   = st->snap_nabsent = st->snap_keypos = 0;
+
+    st->dirty_keys   = NULL;
+    st->dirty_count  = 0;
+    st->dirty_cap    = 0;
+
+    st->shared = 0;
+    pthread_rwlock_init(&st->rw, NULL);
+    for (int i = 0; i < STORAGE_KEY_STRIPES; i++) {
+        pthread_mutex_init(&st->key_locks[i], NULL);
+    }
 }
 
-/// Free all data blocks and arrays.
-void storage_destroy(Storage *st) {
-    for (size_t i = 0; i < st->capacity; i++) {
-        if (st->flags[i] == BUCKET_OCCUPIED) {
-            free(st->values[i]);
-        }
+void storage_set_shared(Storage *st, int shared) {
+    st->shared = shared;
+}
+
+static inline pthread_mutex_t *key_lock(Storage *st, int id) {
+    return &st->key_locks[mix32((uint32_t)id) & (STORAGE_KEY_STRIPES - 1)];
+}
+
+void storage_key_lock(Storage *st, int id) {
+    if (st->shared) pthread_mutex_lock(key_lock(st, id));
+}
+
+void storage_key_unlock(Storage *st, int id) {
+    if (st->shared) pthread_mutex_unlock(key_lock(st, id));
+}
+
+void storage_key_lock_all(Storage *st) {
+    if (!st->shared) return;
+    for (int i = 0; i < STORAGE_KEY_STRIPES; i++) {
+        pthread_mutex_lock(&st->key_locks[i]);
     }
-    free(st->flags);
-    free(st->keys);
-    free(st->values);
-    free(st->val_sizes);
 }
 
-/// Rehash into a new table twice as large
-static void storage_rehash(Storage *st) {
-    size_t old_cap = st->capacity;
-    uint8_t *old_flags = st->flags;
-    int     *old_keys  = st->keys;
-    void    **old_vals = st->values;
-    size_t  *old_sz    = st->val_sizes;
+void storage_key_unlock_all(Storage *st) {
+    if (!st->shared) return;
+    for (int i = STORAGE_KEY_STRIPES - 1; i >= 0; i--) {
+        pthread_mutex_unlock(&st->key_locks[i]);
+    }
+}
 
-    st->capacity *= 2;
-    st->size = 0;
-    st->flags    = calloc(st->capacity, sizeof(uint8_t));
-    st->keys     = malloc(st->capacity * sizeof(int));
-    st->values   = malloc(st->capacity * sizeof(void*));
-    st->val_sizes= malloc(st->capacity * sizeof(size_t));
+static void free_old_list(storage_old_t *o) {
+    while (o) {
+        storage_old_t *next = o->next;
+        slab_free(o->data);
+        free(o);
+        o = next;
+    }
+}
 
-    for (size_t i = 0; i < old_cap; i++) {
-        if (old_flags[i] == BUCKET_OCCUPIED) {
-            storage_save(st, old_keys[i], old_vals[i], old_sz[i]);
-            // storage_save makes its own copy, so free old buffer
-            free(old_vals[i]);
+/// Free all data blocks and arrays.
+void storage_destroy(Storage *st) {
+    for (size_t i = 0; i < st->capacity; i++) {
+        if (slot_state(st, i) == BUCKET_OCCUPIED) {
+            slab_free(st->values[i]);
         }
     }
-    free(old_flags);
-    free(old_keys);
-    free(old_vals);
-    free(old_sz);
-}
+    free_arrays(st->flags, st->keys, st->values, st->val_sizes, st->capacity);
 
-/// Insert or update via Robin-Hood hashing
-void storage_save(Storage *st, int id, const void *data, size_t size) {
-    // Grow if load factor > 0.7
-    if ((double)(st->size + 1) / st->capacity > 0.7) {
-        storage_rehash(st);
+    free_old_list(st->snap_old);
+    st->snap_old = NULL;
+    free(st->snap_keys);
+    free(st->dirty_keys);
+    pthread_mutex_destroy(&st->lock);
+    pthread_rwlock_destroy(&st->rw);
+    for (int i = 0; i < STORAGE_KEY_STRIPES; i++) {
+        pthread_mutex_destroy(&st->key_locks[i]);
     }
+}
 
+/// Slot holding `id`, or SLOT_NONE.
+static size_t find_slot(const Storage *st, int id) {
     uint32_t hash = mix32((uint32_t)id);
     size_t  mask = st->capacity - 1;
     size_t  idx  = hash & mask;
-    size_t  dist = 0;
 
-    int    cur_key;
-    void  *cur_val;
-    size_t cur_sz;
-    uint8_t cur_flag;
+    for (size_t dist = 0; dist < st->capacity; dist++) {
+        uint8_t state = slot_state(st, idx);
+        if (state == BUCKET_EMPTY) {
+            return SLOT_NONE;
+        }
+        if (state == BUCKET_OCCUPIED && st->keys[idx] == id) {
+            return idx;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return SLOT_NONE;
+}
+
+/// A removal the next checkpoint still has to report (DIRTY tombstone)
+static inline int slot_is_dirty_tomb(const Storage *st, size_t i) {
+    return (st->flags[i] & (BUCKET_STATE | BUCKET_DIRTY)) == (BUCKET_DELETED | BUCKET_DIRTY);
+}
+
+/// Tombstone of `id` still marked DIRTY, or SLOT_NONE.
+static size_t find_dirty_tomb(const Storage *st, int id) {
+    size_t mask = st->capacity - 1;
+    size_t idx  = mix32((uint32_t)id) & mask;
+
+    for (size_t dist = 0; dist < st->capacity; dist++) {
+        if (slot_state(st, idx) == BUCKET_EMPTY) return SLOT_NONE;
+        if (slot_is_dirty_tomb(st, idx) && st->keys[idx] == id) return idx;
+        idx = (idx + 1) & mask;
+    }
+    return SLOT_NONE;
+}
 
-    // Prepare new entry
-    int    new_key = id;
-    void  *new_val = malloc(size);
-    memcpy(new_val, data, size);
-    size_t new_sz  = size;
-    uint8_t new_flag = BUCKET_OCCUPIED;
+/// Robin-Hood placement of a key known to be absent.  The marker bits
+/// in `meta` travel with the entry whenever it is displaced.
+static void insert_slot(Storage *st, int key, void *val, size_t sz, uint8_t meta) {
+    size_t mask = st->capacity - 1;
+    size_t idx  = mix32((uint32_t)key) & mask;
+    size_t dist = 0;
 
     for (;;) {
-        cur_flag = st->flags[idx];
-        if (cur_flag != BUCKET_OCCUPIED) {
+        if (slot_is_dirty_tomb(st, idx)) {
+            // Kept until the checkpoint clears it: step over
+            idx = (idx + 1) & mask;
+            dist++;
+            continue;
+        }
+        if (slot_state(st, idx) != BUCKET_OCCUPIED) {
             // Empty or deleted: place here
-            st->flags[idx]     = BUCKET_OCCUPIED;
-            st->keys[idx]      = new_key;
-            st->values[idx]    = new_val;
-            st->val_sizes[idx] = new_sz;
+            if (slot_state(st, idx) == BUCKET_DELETED) st->tombstones--;
+            st->flags[idx]     = (uint8_t)(BUCKET_OCCUPIED | meta);
+            st->keys[idx]      = key;
+            st->values[idx]    = val;
+            st->val_sizes[idx] = sz;
             st->size++;
             return;
         }
@@ -109,24 +198,21 @@ void storage_save(Storage *st, int id, const void *data, size_t size) {
 
         if (cur_dist < dist) {
             // Robin-Hood swap
-            cur_key   = st->keys[idx];
-            cur_val   = st->values[idx];
-            cur_sz    = st->val_sizes[idx];
-
-            st->keys[idx]      = new_key;
-            st->values[idx]    = new_val;
-            st->val_sizes[idx] = new_sz;
-
-            new_key   = cur_key;
-            new_val   = cur_val;
-            new_sz    = cur_sz;
-            dist      = cur_dist;
-        } else if (st->keys[idx] == new_key) {
-            // Overwrite existing key
-            free(st->values[idx]);
-            st->values[idx]    = new_val;
-            st->val_sizes[idx] = new_sz;
-            return;
+            int     cur_key  = st->keys[idx];
+            void   *cur_val  = st->values[idx];
+            size_t  cur_sz   = st->val_sizes[idx];
+            uint8_t cur_meta = st->flags[idx] & (uint8_t)~BUCKET_STATE;
+
+            st->flags[idx]     = (uint8_t)(BUCKET_OCCUPIED | meta);
+            st->keys[idx]      = key;
+            st->values[idx]    = val;
+            st->val_sizes[idx] = sz;
+
+            key  = cur_key;
+            val  = cur_val;
+            sz   = cur_sz;
+            meta = cur_meta;
+            dist = cur_dist;
         }
 
         // Next slot
@@ -135,54 +221,390 @@ void storage_save(Storage *st, int id, const void *data, size_t size) {
     }
 }
 
-/// Retrieve the data for `id` if present.
-int storage_get(Storage *st, int id, void *out, size_t out_sz) {
-    uint32_t hash = mix32((uint32_t)id);
-    size_t  mask = st->capacity - 1;
-    size_t  idx  = hash & mask;
+/// Rehash, dropping tombstones, into a table at most half full after the
+/// next insert: twice as large when the entries fill it, the same size
+/// when it was mostly tombstones.  Data blocks are moved, not copied.
+static void storage_rehash(Storage *st) {
+    size_t old_cap = st->capacity;
+    uint8_t *old_flags = st->flags;
+    int     *old_keys  = st->keys;
+    void    **old_vals = st->values;
+    size_t  *old_sz    = st->val_sizes;
 
-    for (size_t dist = 0; dist < st->capacity; dist++) {
-        if (st->flags[idx] == BUCKET_EMPTY) {
-            return 0;  // not found
+    // Removals still to be checkpointed keep their tombstone
+    size_t keep = st->size + 1;
+    for (size_t i = 0; i < old_cap; i++) {
+        if ((old_flags[i] & (BUCKET_STATE | BUCKET_DIRTY)) == (BUCKET_DELETED | BUCKET_DIRTY)) keep++;
+    }
+    while (keep * 2 > st->capacity) st->capacity *= 2;
+    st->size = 0;
+    st->tombstones = 0;
+    alloc_arrays(st);
+
+    for (size_t i = 0; i < old_cap; i++) {
+        if ((old_flags[i] & BUCKET_STATE) == BUCKET_OCCUPIED) {
+            insert_slot(st, old_keys[i], old_vals[i], old_sz[i],
+                        old_flags[i] & (uint8_t)~BUCKET_STATE);
         }
-        if (st->flags[idx] == BUCKET_OCCUPIED && st->keys[idx] == id) {
-            if (out_sz < st->val_sizes[idx]) return 0;
-            memcpy(out, st->values[idx], st->val_sizes[idx]);
-            return 1;
+    }
+    size_t mask = st->capacity - 1;
+    for (size_t i = 0; i < old_cap; i++) {
+        if ((old_flags[i] & (BUCKET_STATE | BUCKET_DIRTY)) != (BUCKET_DELETED | BUCKET_DIRTY)) continue;
+        size_t idx = mix32((uint32_t)old_keys[i]) & mask;
+        while (slot_state(st, idx) != BUCKET_EMPTY) idx = (idx + 1) & mask;
+        st->flags[idx] = BUCKET_DELETED | BUCKET_DIRTY;
+        st->keys[idx]  = old_keys[i];
+        st->tombstones++;
+    }
+    free_arrays(old_flags, old_keys, old_vals, old_sz, old_cap);
+
+    // Tagged entries moved: the snapshot reader rescans from the top
+    st->snap_cursor = 0;
+}
+
+/// If slot `idx` still belongs to the running snapshot, hand its current
+/// value to the reader instead of letting the caller free it.
+static int preserve_old(Storage *st, size_t idx) {
+    if (!(st->flags[idx] & BUCKET_SNAP)) return 0;
+
+    storage_old_t *o = malloc(sizeof *o);
+    o->id    = st->keys[idx];
+    o->size  = st->val_sizes[idx];
+    o->data  = st->values[idx];
+    o->next  = st->snap_old;
+    st->snap_old = o;
+
+    st->flags[idx] &= (uint8_t)~BUCKET_SNAP;
+    st->snap_pending--;
+    return 1;
+}
+
+/// Remember `id` as changed since the last checkpoint.
+static void note_dirty(Storage *st, int id) {
+    if (st->dirty_count == st->dirty_cap) {
+        size_t ncap = st->dirty_cap ? st->dirty_cap * 2 : 1024;
+        int *nk = realloc(st->dirty_keys, ncap * sizeof(int));
+        if (!nk) return;        // worst case the next delta misses a key; AOF still has it
+        st->dirty_keys = nk;
+        st->dirty_cap  = ncap;
+    }
+    st->dirty_keys[st->dirty_count++] = id;
+}
+
+/// Insert or update via Robin-Hood hashing
+void storage_save(Storage *st, int id, const void *data, size_t size) {
+    void *copy = slab_alloc(size);
+    memcpy(copy, data, size);
+
+    WRITE_LOCK(st);
+    int locked = st->snap_active;
+    if (locked) pthread_mutex_lock(&st->lock);
+
+    size_t idx = find_slot(st, id);
+    if (idx != SLOT_NONE) {
+        // Overwrite existing key in place
+        if (!preserve_old(st, idx)) slab_free(st->values[idx]);
+        st->values[idx]    = copy;
+        st->val_sizes[idx] = size;
+        if (!(st->flags[idx] & BUCKET_DIRTY)) {
+            st->flags[idx] |= BUCKET_DIRTY;
+            note_dirty(st, id);
         }
-        idx = (idx + 1) & mask;
+    } else {
+        // Removed earlier in this interval: already in the dirty list
+        size_t tomb = find_dirty_tomb(st, id);
+        if (tomb != SLOT_NONE) st->flags[tomb] = BUCKET_DELETED;
+
+        // Rehash if entries and tombstones fill more than 0.7
+        if ((double)(st->size + st->tombstones + 1) / st->capacity > 0.7) {
+            storage_rehash(st);
+        }
+        insert_slot(st, id, copy, size, BUCKET_DIRTY);
+        if (tomb == SLOT_NONE) note_dirty(st, id);
     }
-    return 0;
+
+    if (locked) pthread_mutex_unlock(&st->lock);
+    UNLOCK(st);
+}
+
+/// Retrieve the data for `id` if present.
+int storage_get(Storage *st, int id, void *out, size_t out_sz) {
+    READ_LOCK(st);
+    int locked = st->snap_active;
+    if (locked) pthread_mutex_lock(&st->lock);
+
+    int found = 0;
+    size_t idx = find_slot(st, id);
+    if (idx != SLOT_NONE && out_sz >= st->val_sizes[idx]) {
+        memcpy(out, st->values[idx], st->val_sizes[idx]);
+        found = 1;
+    }
+
+    if (locked) pthread_mutex_unlock(&st->lock);
+    UNLOCK(st);
+    return found;
 }
 
 /// Remove entry and mark deleted.
 void storage_remove(Storage *st, int id) {
-    uint32_t hash = mix32((uint32_t)id);
-    size_t  mask = st->capacity - 1;
-    size_t  idx  = hash & mask;
+    WRITE_LOCK(st);
+    int locked = st->snap_active;
+    if (locked) pthread_mutex_lock(&st->lock);
 
-    for (size_t dist = 0; dist < st->capacity; dist++) {
-        if (st->flags[idx] == BUCKET_EMPTY) {
-            return;  // not found
-        }
-        if (st->flags[idx] == BUCKET_OCCUPIED && st->keys[idx] == id) {
-            free(st->values[idx]);
-            st->flags[idx] = BUCKET_DELETED;
-            st->size--;
-            return;
-        }
-        idx = (idx + 1) & mask;
+    size_t idx = find_slot(st, id);
+    if (idx != SLOT_NONE) {
+        if (!preserve_old(st, idx)) slab_free(st->values[idx]);
+        if (!(st->flags[idx] & BUCKET_DIRTY)) note_dirty(st, id);
+        // The mark stays with the tombstone until the next checkpoint
+        st->flags[idx] = BUCKET_DELETED | BUCKET_DIRTY;
+        st->size--;
+        st->tombstones++;
     }
+
+    if (locked) pthread_mutex_unlock(&st->lock);
+    UNLOCK(st);
 }
 
 void storage_iterate(Storage *st, void (*fn)(int, const void *, size_t, void *), void *udata) {
-    // Access the flags/keys/values arrays directly (they're already in storage.c)
+    READ_LOCK(st);
+    int locked = st->snap_active;
+    if (locked) pthread_mutex_lock(&st->lock);
+
     for (size_t i = 0; i < st->capacity; i++) {
-        if (st->flags[i] == BUCKET_OCCUPIED) {
+        if (slot_state(st, i) == BUCKET_OCCUPIED) {
             fn(st->keys[i],
                st->values[i],
                st->val_sizes[i],
                udata);
         }
     }
+
+    if (locked) pthread_mutex_unlock(&st->lock);
+    UNLOCK(st);
+}
+
+/// Reverse the bits of a cursor (SCAN walks home buckets in this order).
+static inline size_t rev_bits(size_t v) {
+    size_t s = sizeof(v) * 8;
+    size_t mask = ~(size_t)0;
+    while ((s >>= 1) > 0) {
+        mask ^= (mask << s);
+        v = ((v >> s) & mask) | ((v << s) & ~mask);
+    }
+    return v;
+}
+
+/// Emit every entry whose home bucket is `home`.  Linear probing keeps
+/// them between `home` and the next empty slot, as find_slot() relies on.
+static void scan_bucket(const Storage *st, size_t home,
+                        storage_iter_fn fn, void *udata) {
+    size_t mask = st->capacity - 1;
+    size_t idx  = home;
+
+    for (size_t dist = 0; dist < st->capacity; dist++) {
+        uint8_t state = slot_state(st, idx);
+        if (state == BUCKET_EMPTY) return;
+        if (state == BUCKET_OCCUPIED &&
+            (mix32((uint32_t)st->keys[idx]) & mask) == home) {
+            fn(st->keys[idx], st->values[idx], st->val_sizes[idx], udata);
+        }
+        idx = (idx + 1) & mask;
+    }
+}
+
+/// Redis-style SCAN: the cursor is a home bucket, advanced by
+/// incrementing its reversed bits.  Doubling the table splits bucket h
+/// into h and h + old capacity, which the reversed order visits next to
+/// each other, so buckets already covered stay covered across a rehash.
+size_t storage_scan(Storage *st, size_t cursor, size_t count,
+                    storage_iter_fn fn, void *udata) {
+    READ_LOCK(st);
+    int locked = st->snap_active;
+    if (locked) pthread_mutex_lock(&st->lock);
+
+    size_t mask = st->capacity - 1;
+    size_t v = cursor & mask;
+    if (!count) count = 1;
+    do {
+        scan_bucket(st, v, fn, udata);
+
+        v |= ~mask;
+        v = rev_bits(v);
+        v++;
+        v = rev_bits(v);
+    } while (v && --count);
+
+    if (locked) pthread_mutex_unlock(&st->lock);
+    UNLOCK(st);
+    return v;
+}
+
+/* ─── fork-less snapshots ─────────────────────────────────────────── */
+
+int storage_snapshot_begin(Storage *st) {
+    WRITE_LOCK(st);
+    if (st->snap_active) { UNLOCK(st); return -1; }
+
+    // No reader is attached yet, so tagging needs no lock
+    for (size_t i = 0; i < st->capacity; i++) {
+        if (slot_state(st, i) == BUCKET_OCCUPIED) {
+            st->flags[i] |= BUCKET_SNAP;
+        }
+    }
+    st->snap_pending = st->size;
+    st->snap_cursor  = 0;
+    st->snap_old     = NULL;
+    st->snap_active  = 1;
+    UNLOCK(st);
+    return 0;
+}
+
+int storage_snapshot_step(Storage *st,
+                          storage_iter_fn fn,
+                          void           *udata,
+                          size_t          budget)
+{
+    pthread_mutex_lock(&st->lock);
+
+    // Pre-images first; from here on they belong to the reader
+    storage_old_t *old = st->snap_old;
+    st->snap_old = NULL;
+    for (storage_old_t *o = old; o; o = o->next) {
+        fn(o->id, o->data, o->size, udata);
+    }
+
+    if (st->snap_keys) {
+        // Delta: tombstones first, then the tagged keys by lookup
+        while (budget && st->snap_keypos < st->snap_nabsent) {
+            fn(st->snap_keys[st->snap_keypos++], NULL, 0, udata);
+            budget--;
+        }
+        while (budget && st->snap_keypos < st->snap_nkeys) {
+            size_t i = find_slot(st, st->snap_keys[st->snap_keypos++]);
+            if (i != SLOT_NONE && (st->flags[i] & BUCKET_SNAP)) {
+                fn(st->keys[i], st->values[i], st->val_sizes[i], udata);
+                st->flags[i] &= (uint8_t)~BUCKET_SNAP;
+                st->snap_pending--;
+            }
+            budget--;
+        }
+        int more = st->snap_keypos < st->snap_nkeys;
+        pthread_mutex_unlock(&st->lock);
+
+        free_old_list(old);
+        return more;
+    }
+
+    // Then tagged live entries.  The cursor wraps: an entry displaced
+    // behind it (Robin-Hood shift or rehash) is caught on the next lap.
+    size_t mask = st->capacity - 1;
+    while (budget-- && st->snap_pending) {
+        size_t i = st->snap_cursor;
+        if (st->flags[i] & BUCKET_SNAP) {
+            fn(st->keys[i], st->values[i], st->val_sizes[i], udata);
+            st->flags[i] &= (uint8_t)~BUCKET_SNAP;
+            st->snap_pending--;
+        }
+        st->snap_cursor = (i + 1) & mask;
+    }
+
+    // With nothing left tagged, no new pre-images can appear
+    int more = st->snap_pending != 0;
+    pthread_mutex_unlock(&st->lock);
+
+    free_old_list(old);
+    return more;
+}
+
+int storage_snapshot_begin_keys(Storage *st, int *keys, size_t n) {
+    WRITE_LOCK(st);
+    if (st->snap_active) { UNLOCK(st); free(keys); return -1; }
+
+    // Partition: keys gone since they were dirtied go first (tombstones),
+    // present ones are tagged exactly like a full snapshot would
+    size_t absent = 0, pending = 0;
+    for (size_t k = 0; k < n; k++) {
+        size_t i = find_slot(st, keys[k]);
+        if (i == SLOT_NONE) {
+            int tmp = keys[absent]; keys[absent++] = keys[k]; keys[k] = tmp;
+        } else if (!(st->flags[i] & BUCKET_SNAP)) {
+            st->flags[i] |= BUCKET_SNAP;
+            pending++;
+        }
+    }
+    st->snap_keys    = keys;
+    st->snap_nkeys   = n;
+    st->snap_nabsent = absent;
+    st->snap_keypos  = 0;
+    st->snap_pending = pending;
+    st->snap_cursor  = 0;
+    st->snap_old     = NULL;
+    st->snap_active  = 1;
+    UNLOCK(st);
+    return 0;
+}
+
+void storage_snapshot_end(Storage *st) {
+    WRITE_LOCK(st);
+    if (!st->snap_active) { UNLOCK(st); return; }
+
+    pthread_mutex_lock(&st->lock);
+    if (st->snap_pending) {                  // aborted: untag the rest
+        for (size_t i = 0; i < st->capacity; i++) {
+            st->flags[i] &= (uint8_t)~BUCKET_SNAP;
+        }
+        st->snap_pending = 0;
+    }
+    storage_old_t *old = st->snap_old;
+    st->snap_old = NULL;
+    int *keys = st->snap_keys;
+    st->snap_keys  = NULL;
+    st->snap_nkeys = st->snap_nabsent = st->snap_keypos = 0;
+    pthread_mutex_unlock(&st->lock);
+
+    st->snap_active = 0;
+    UNLOCK(st);
+
+    free_old_list(old);
+    free(keys);
+}
+
+/* ─── dirty tracking ──────────────────────────────────────────────── */
+
+size_t storage_dirty_count(const Storage *st) {
+    return st->dirty_count;
+}
+
+void storage_iterate_dirty(Storage *st, storage_iter_fn fn, void *udata) {
+    for (size_t k = 0; k < st->dirty_count; k++) {
+        size_t i = find_slot(st, st->dirty_keys[k]);
+        if (i == SLOT_NONE) fn(st->dirty_keys[k], NULL, 0, udata);
+        else                fn(st->keys[i], st->values[i], st->val_sizes[i], udata);
+    }
+}
+
+int *storage_dirty_take(Storage *st, size_t *n) {
+    WRITE_LOCK(st);
+    int locked = st->snap_active;
+    if (locked) pthread_mutex_lock(&st->lock);
+
+    for (size_t k = 0; k < st->dirty_count; k++) {
+        size_t i = find_slot(st, st->dirty_keys[k]);
+        if (i == SLOT_NONE) i = find_dirty_tomb(st, st->dirty_keys[k]);
+        if (i != SLOT_NONE) st->flags[i] &= (uint8_t)~BUCKET_DIRTY;
+    }
+    int *keys = st->dirty_keys;
+    *n = st->dirty_count;
+    st->dirty_keys  = NULL;
+    st->dirty_count = 0;
+    st->dirty_cap   = 0;
+
+    if (locked) pthread_mutex_unlock(&st->lock);
+    UNLOCK(st);
+    return keys;
+}
+
+void storage_dirty_reset(Storage *st) {
+    size_t n;
+    free(storage_dirty_take(st, &n));
 }
@@ -4,11 +4,19 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <pthread.h>
 
 /// Bucket states for the open-addressing table
 #define BUCKET_EMPTY    0
 #define BUCKET_OCCUPIED 1
 #define BUCKET_DELETED  2
+#define BUCKET_STATE    0x03  ///< mask selecting the BUCKET_* state
+
+/// Per-slot marker bits packed above the state (they travel with the entry)
+#define BUCKET_SNAP     0x04  ///< part of the running snapshot, not yet emitted
+#define BUCKET_DIRTY    0x08  ///< written since the last checkpoint
+
+#define STORAGE_KEY_STRIPES 64  ///< writer locks in shared mode (power of two)
 
 
 /// Opaque iteration callback (for JSON serializers, RDB dumps, etc.)
@@ -19,22 +27,70 @@ typedef void (*storage_iter_fn)(
         void        *udata
 );
 
+/// Pre-image of an entry overwritten/removed while a snapshot was running
+typedef struct storage_old {
+    struct storage_old *next;
+    int                 id;
+    size_t              size;
+    void               *data;
+} storage_old_t;
+
 /// The Storage type: SwissTable Robin-Hood hash map
 typedef struct Storage {
     size_t     capacity;    ///< always power of two
     size_t     size;        ///< number of OCCUPIED entries
+    size_t     tombstones;  ///< number of DELETED slots (they lengthen probes too)
     uint8_t   *flags;       ///< BUCKET_* per slot
     int       *keys;        ///< key per slot
     void     **values;      ///< data pointer per slot
     size_t    *val_sizes;   ///< size of each data block
+
+    /* point-in-time snapshot state (see storage_snapshot_begin) */
+    pthread_mutex_t lock;         ///< held by mutators only while a snapshot runs
+    int             snap_active;  ///< set/cleared on the owning thread only
+    size_t          snap_pending; ///< BUCKET_SNAP entries not yet emitted
+    size_t          snap_cursor;  ///< next slot the snapshot reader examines
+    storage_old_t  *snap_old;     ///< pre-images awaiting the reader
+    int            *snap_keys;    ///< delta snapshot: keys to emit (NULL = full)
+    size_t          snap_nkeys;
+    size_t          snap_nabsent; ///< leading snap_keys[] that are tombstones
+    size_t          snap_keypos;
+
+    /* keys written or removed since the last checkpoint (BUCKET_DIRTY dedups) */
+    int            *dirty_keys;
+    size_t          dirty_count;
+    size_t          dirty_cap;
+
+    /* shared mode: several event-loop threads on one table */
+    int              shared;      ///< set before the threads start
+    pthread_rwlock_t rw;          ///< readers share, mutators exclude
+    pthread_mutex_t  key_locks[STORAGE_KEY_STRIPES];
 } Storage;
 
-/// Initialize a Storage.  Must call once before use.
+/// Initialize a Storage.  Must call once before use (after slab_init();
+/// entry copies live in the slab allocator).
 void storage_init(Storage *st);
 
 /// Destroy a Storage, freeing all memory.
 void storage_destroy(Storage *st);
 
+/// Let several threads use `st` at once (a multi-loop server): lookups
+/// and scans take a shared lock, mutations and snapshot begin/end an
+/// exclusive one.  Call before the other threads start; without it the
+/// table belongs to one thread and no lock is taken.
+void storage_set_shared(Storage *st, int shared);
+
+/// Shared mode: serialize the writers of one key across threads, so a
+/// write-ahead log (AOF_append, then storage_save) sees them in the same
+/// order as the table.  No-ops otherwise.
+void storage_key_lock(Storage *st, int id);
+void storage_key_unlock(Storage *st, int id);
+
+/// Hold every key lock: no logged write is between its log record and
+/// its table update (a compaction starting its view).
+void storage_key_lock_all(Storage *st);
+void storage_key_unlock_all(Storage *st);
+
 /// Save or update entry `id` with a copy of `data` (size bytes).
 void storage_save(Storage *st, int id, const void *data, size_t size);
 
@@ -49,4 +105,60 @@ void storage_iterate(Storage *st,
                      storage_iter_fn fn,
                      void           *udata);
 
+/// Resumable scan (like Redis SCAN) for work spread over requests or
+/// event-loop turns.  Visits up to `count` home buckets from `cursor`
+/// (0 starts a scan), calls `fn` for every entry in them and returns the
+/// cursor for the next call; 0 once the whole table was covered.  An
+/// entry present for the whole scan is reported at least once even if
+/// the table grows in between; it may be reported twice, and entries
+/// added or removed meanwhile may or may not be seen.
+size_t storage_scan(Storage *st, size_t cursor, size_t count,
+                    storage_iter_fn fn, void *udata);
+
+/* ─── fork-less point-in-time snapshots ─────────────────────────────
+ * begin() tags every live entry with BUCKET_SNAP.  While the snapshot
+ * runs, a mutation of a tagged entry moves the old value onto a
+ * pre-image list instead of freeing it, so the reader always sees the
+ * table as it was at begin().  Extra memory is bounded by the number
+ * of distinct keys written during the snapshot, not by the table size.
+ *
+ * begin()/end() and all mutations happen on the owning thread (in
+ * shared mode: under the exclusive lock, from any thread); step() may
+ * run on any other thread.                                           */
+
+/// Start a snapshot.  Returns -1 if one is already running.
+int  storage_snapshot_begin(Storage *st);
+
+/// Emit up to `budget` slots' worth of the frozen view through `fn`.
+/// `fn` runs with the storage lock held and must not call back into
+/// Storage.  Returns 1 while more remains, 0 once the view is complete.
+int  storage_snapshot_step(Storage *st,
+                           storage_iter_fn fn,
+                           void           *udata,
+                           size_t          budget);
+
+/// Start a delta snapshot over `keys` (ownership passes to Storage, as
+/// returned by storage_dirty_take).  Keys absent at begin are emitted
+/// first as tombstones: fn(id, NULL, 0, udata).
+int  storage_snapshot_begin_keys(Storage *st, int *keys, size_t n);
+
+/// Detach the reader.  Safe to call before step() returned 0 (abort).
+void storage_snapshot_end(Storage *st);
+
+/* ─── dirty tracking for incremental checkpoints ─────────────────── */
+
+/// Number of keys written or removed since the last checkpoint.
+size_t storage_dirty_count(const Storage *st);
+
+/// Visit every dirty key: present ones with their data, removed ones
+/// as fn(id, NULL, 0, udata).  Used by a forked delta writer.
+void storage_iterate_dirty(Storage *st, storage_iter_fn fn, void *udata);
+
+/// Start a new checkpoint interval: hand the dirty key list to the
+/// caller (free() it) and clear the marks.  O(dirty), not O(capacity).
+int *storage_dirty_take(Storage *st, size_t *n);
+
+/// Start a new checkpoint interval, discarding the dirty key list.
+void storage_dirty_reset(Storage *st);
+
 #endif // STORAGE_H
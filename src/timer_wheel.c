@@ -0,0 +1,75 @@
+// timer_wheel.c
+#include "timer_wheel.h"
+#include <stddef.h>
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+void timer_wheel_init(timer_wheel_t *tw, unsigned int tick_ms) {
+    for (int i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        tw->slots[i].prev = tw->slots[i].next = &tw->slots[i];
+    }
+    tw->now = 0;
+    tw->tick_ms = tick_ms ? tick_ms : 1;
+    tw->pending = 0;
+}
+
+static void unlink_entry(timer_wheel_entry_t *e) {
+    e->prev->next = e->next;
+    e->next->prev = e->prev;
+    e->prev = e->next = NULL;
+}
+
+void timer_wheel_schedule(timer_wheel_t *tw, timer_wheel_entry_t *e,
+                          uint64_t delay_ms, timer_wheel_cb cb) {
+    if (timer_wheel_pending(e)) {
+        unlink_entry(e);
+        tw->pending--;
+    }
+
+    /* Round up, and never into the slot being processed right now */
+    uint64_t ticks = (delay_ms + tw->tick_ms - 1) / tw->tick_ms;
+    if (ticks == 0) ticks = 1;
+    e->deadline = tw->now + ticks;
+    e->cb = cb;
+
+    timer_wheel_entry_t *head = &tw->slots[e->deadline & SLOT_MASK];
+    e->prev = head->prev;
+    e->next = head;
+    head->prev->next = e;
+    head->prev = e;
+    tw->pending++;
+}
+
+void timer_wheel_cancel(timer_wheel_t *tw, timer_wheel_entry_t *e) {
+    if (!timer_wheel_pending(e)) return;
+    unlink_entry(e);
+    tw->pending--;
+}
+
+unsigned int timer_wheel_tick(timer_wheel_t *tw) {
+    tw->now++;
+    timer_wheel_entry_t *head = &tw->slots[tw->now & SLOT_MASK];
+
+    /* Due entries move to a private list first: callbacks may schedule
+       or cancel anything, including entries of this very slot */
+    timer_wheel_entry_t due = { &due, &due, 0, NULL };
+    for (timer_wheel_entry_t *e = head->next, *next; e != head; e = next) {
+        next = e->next;
+        if (e->deadline > tw->now) continue;   /* a later lap */
+        unlink_entry(e);
+        e->prev = due.prev;
+        e->next = &due;
+        due.prev->next = e;
+        due.prev = e;
+    }
+
+    unsigned int fired = 0;
+    while (due.next != &due) {
+        timer_wheel_entry_t *e = due.next;
+        unlink_entry(e);
+        tw->pending--;
+        fired++;
+        e->cb(e);
+    }
+    return fired;
+}
@@ -0,0 +1,53 @@
+// timer_wheel.h
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Hashed timing wheel for many coarse, frequently re-armed timeouts
+/// (one per connection).  Scheduling and cancelling are O(1) list
+/// splices; one periodic tick walks a single slot.  Timeouts longer than
+/// a lap wait in their slot for later rounds.  Single-threaded: one wheel
+/// per event loop, driven by one uv_timer_t.
+
+#define TIMER_WHEEL_SLOTS 256   ///< power of two
+
+typedef struct timer_wheel_entry timer_wheel_entry_t;
+typedef void (*timer_wheel_cb)(timer_wheel_entry_t *entry);
+
+/// Embed in the owning object; zeroed means "not scheduled".
+struct timer_wheel_entry {
+    timer_wheel_entry_t *prev, *next;
+    uint64_t             deadline;  ///< in ticks
+    timer_wheel_cb       cb;
+};
+
+typedef struct {
+    timer_wheel_entry_t slots[TIMER_WHEEL_SLOTS];  ///< list heads
+    uint64_t            now;                       ///< ticks since init
+    unsigned int        tick_ms;
+    uint64_t            pending;                   ///< entries scheduled
+} timer_wheel_t;
+
+/// Set up an empty wheel whose tick is `tick_ms` long.
+void timer_wheel_init(timer_wheel_t *tw, unsigned int tick_ms);
+
+/// (Re)schedule `e` to run `cb` after at least `delay_ms`, rounded up to
+/// whole ticks.  An entry already scheduled is moved.
+void timer_wheel_schedule(timer_wheel_t *tw, timer_wheel_entry_t *e,
+                          uint64_t delay_ms, timer_wheel_cb cb);
+
+/// Unschedule `e`; harmless when it is not scheduled.
+void timer_wheel_cancel(timer_wheel_t *tw, timer_wheel_entry_t *e);
+
+/// Advance one tick and run the callbacks that fell due, each after its
+/// entry was unscheduled (a callback may reschedule it).  Returns how
+/// many ran.
+unsigned int timer_wheel_tick(timer_wheel_t *tw);
+
+static inline int timer_wheel_pending(const timer_wheel_entry_t *e) {
+    return e->next != NULL;
+}
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,674 @@
+// uring_net.c
+#define _GNU_SOURCE
+#include "uring_net.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define URING_NET_NATIVE 1
+#endif
+#endif
+
+#ifdef URING_NET_NATIVE
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+
+#define RING_ENTRIES  4096
+#define BUF_COUNT     512          /* provided recv buffers (power of two) */
+#define BUF_SIZE      4096
+#define BUF_GROUP     0
+
+/* user_data = object pointer | operation (objects are 8-byte aligned) */
+enum { OP_ACCEPT = 1, OP_RECV, OP_SEND, OP_SHUTDOWN, OP_CANCEL };
+#define OP_MASK  7u
+
+/* uring_conn_t.state */
+#define ST_READING      0x01u   /* the owner wants reads */
+#define ST_RECV_ARMED   0x02u   /* a multishot recv is in the kernel */
+#define ST_RECV_CANCEL  0x04u   /* ... and so is a cancel for it */
+#define ST_INPUT_END    0x08u   /* EOF or a read error was seen */
+#define ST_SENDING      0x10u   /* the write queue head is in the kernel */
+#define ST_SHUT_WANTED  0x20u   /* shutdown once the queue drains */
+#define ST_CLOSING      0x40u
+#define ST_DEFERRED     0x80u   /* on net->deferred */
+
+struct uring_net {
+    int                  ring_fd;
+    uv_poll_t            poll;        /* the ring fd: completions ready */
+    uv_prepare_t         prepare;     /* before the loop blocks: submit */
+    int                  handles_open;
+    int                  listen_fd;
+    int                  stopping;
+    uring_net_callbacks_t cb;
+
+    /* submission queue */
+    unsigned            *sq_head, *sq_tail, *sq_flags;
+    unsigned             sq_mask, sq_entries;
+    unsigned             sq_local_tail;   /* filled, maybe not yet published */
+    unsigned             sq_pending;      /* not yet handed to the kernel */
+    struct io_uring_sqe *sqes;
+
+    /* completion queue */
+    unsigned            *cq_head, *cq_tail;
+    unsigned             cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void                *sq_map, *cq_map;
+    size_t               sq_map_len, cq_map_len, sqe_map_len;
+
+    /* provided buffers for multishot recv */
+    struct io_uring_buf_ring *br;
+    size_t               br_len;
+    char                *bufs;
+    unsigned             br_tail;
+
+    uring_conn_t        *deferred;        /* held input to deliver, closes to finish */
+};
+
+static int sys_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_register(int fd, unsigned op, void *arg, unsigned nr) {
+    return (int)syscall(__NR_io_uring_register, fd, op, arg, nr);
+}
+
+static inline uint64_t tag(void *obj, unsigned op) {
+    return (uint64_t)(uintptr_t)obj | op;
+}
+
+/* ─── submission ─────────────────────────────────────────────────── */
+
+static void drain(uring_net_t *net);
+
+/* Hand everything queued so far to the kernel in one io_uring_enter */
+static int submit(uring_net_t *net) {
+    if (!net->sq_pending) return 0;
+    __atomic_store_n(net->sq_tail, net->sq_local_tail, __ATOMIC_RELEASE);
+    int ret = sys_enter(net->ring_fd, net->sq_pending, 0, 0);
+    if (ret < 0) return -errno;
+    net->sq_pending -= (unsigned)ret;
+    return 0;
+}
+
+static struct io_uring_sqe *get_sqe(uring_net_t *net) {
+    for (int attempt = 0; attempt < 3; attempt++) {
+        unsigned head = __atomic_load_n(net->sq_head, __ATOMIC_ACQUIRE);
+        if (net->sq_local_tail - head < net->sq_entries) {
+            struct io_uring_sqe *sqe = &net->sqes[net->sq_local_tail & net->sq_mask];
+            memset(sqe, 0, sizeof(*sqe));
+            net->sq_local_tail++;
+            net->sq_pending++;
+            return sqe;
+        }
+        /* full: submit; a kernel busy with overflowed completions wants
+           them reaped first */
+        if (submit(net) == -EBUSY) drain(net);
+    }
+    return NULL;
+}
+
+/* ─── provided buffers ───────────────────────────────────────────── */
+
+static void buf_give(uring_net_t *net, unsigned bid) {
+    struct io_uring_buf *b = &net->br->bufs[net->br_tail & (BUF_COUNT - 1)];
+    b->addr = (uint64_t)(uintptr_t)(net->bufs + (size_t)bid * BUF_SIZE);
+    b->len  = BUF_SIZE;
+    b->bid  = (uint16_t)bid;
+    net->br_tail++;
+}
+
+static void buf_publish(uring_net_t *net) {
+    __atomic_store_n(&net->br->tail, (uint16_t)net->br_tail, __ATOMIC_RELEASE);
+}
+
+/* ─── per-connection operations ──────────────────────────────────── */
+
+static void defer(uring_conn_t *c) {
+    if (c->state & ST_DEFERRED) return;
+    c->state |= ST_DEFERRED;
+    c->deferred_next = c->net->deferred;
+    c->net->deferred = c;
+}
+
+static int arm_accept(uring_net_t *net) {
+    struct io_uring_sqe *sqe = get_sqe(net);
+    if (!sqe) return UV_ENOBUFS;
+    sqe->opcode       = IORING_OP_ACCEPT;
+    sqe->fd           = net->listen_fd;
+    sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data    = tag(net, OP_ACCEPT);
+    return 0;
+}
+
+static int arm_recv(uring_conn_t *c) {
+    struct io_uring_sqe *sqe = get_sqe(c->net);
+    if (!sqe) return UV_ENOBUFS;
+    sqe->opcode    = IORING_OP_RECV;
+    sqe->fd        = c->fd;
+    sqe->ioprio    = IORING_RECV_MULTISHOT;
+    sqe->flags     = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUF_GROUP;
+    sqe->user_data = tag(c, OP_RECV);
+    c->state |= ST_RECV_ARMED;
+    c->ops++;
+    return 0;
+}
+
+static void cancel(uring_conn_t *c, unsigned op) {
+    struct io_uring_sqe *sqe = get_sqe(c->net);
+    if (!sqe) return;          /* the operation simply runs to completion */
+    sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+    sqe->fd        = -1;
+    sqe->addr      = tag(c, op);
+    sqe->user_data = tag(c, OP_CANCEL);
+    c->ops++;
+}
+
+static int send_head(uring_conn_t *c) {
+    uring_write_t *w = c->wq_head;
+    struct io_uring_sqe *sqe = get_sqe(c->net);
+    if (!sqe) return UV_ENOBUFS;
+
+    memset(&w->msg, 0, sizeof(w->msg));
+    w->msg.msg_iov    = w->iov;
+    w->msg.msg_iovlen = (size_t)w->iovcnt;
+    sqe->opcode    = IORING_OP_SENDMSG;
+    sqe->fd        = c->fd;
+    sqe->addr      = (uint64_t)(uintptr_t)&w->msg;
+    sqe->len       = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = tag(c, OP_SEND);
+    c->state |= ST_SENDING;
+    c->ops++;
+    return 0;
+}
+
+static int send_shutdown(uring_conn_t *c) {
+    struct io_uring_sqe *sqe = get_sqe(c->net);
+    if (!sqe) return UV_ENOBUFS;
+    c->state &= ~ST_SHUT_WANTED;
+    sqe->opcode    = IORING_OP_SHUTDOWN;
+    sqe->fd        = c->fd;
+    sqe->len       = SHUT_WR;
+    sqe->user_data = tag(c, OP_SHUTDOWN);
+    c->ops++;
+    return 0;
+}
+
+static int hold(uring_conn_t *c, const char *data, size_t len) {
+    if (c->held_len + len > c->held_cap) {
+        size_t cap = c->held_cap ? c->held_cap * 2 : BUF_SIZE;
+        while (cap < c->held_len + len) cap *= 2;
+        char *grown = realloc(c->held, cap);
+        if (!grown) return -1;
+        c->held = grown;
+        c->held_cap = cap;
+    }
+    memcpy(c->held + c->held_len, data, len);
+    c->held_len += len;
+    return 0;
+}
+
+/* The last operation of a closing connection finished */
+static void finish_close(uring_conn_t *c) {
+    close(c->fd);
+    c->fd = -1;
+    while (c->wq_head) {
+        uring_write_t *w = c->wq_head;
+        c->wq_head = w->next;
+        c->net->cb.written(c, w, UV_ECANCELED);
+    }
+    c->wq_tail = NULL;
+    free(c->held);
+    c->held = NULL;
+    c->held_len = c->held_cap = 0;
+    c->net->cb.closed(c);
+}
+
+/* Input that arrived while reading was stopped, then the recv again */
+static void deliver_held(uring_conn_t *c) {
+    if (!(c->state & ST_READING) || (c->state & ST_CLOSING)) return;
+
+    if (c->held_len) {
+        /* detached first: the callback may stop reading and more be held */
+        char *held = c->held;
+        size_t len = c->held_len;
+        c->held = NULL;
+        c->held_len = c->held_cap = 0;
+        c->net->cb.read(c, (ssize_t)len, held);
+        free(held);
+        if (!(c->state & ST_READING) || (c->state & ST_CLOSING)) return;
+    }
+    if (c->held_status) {
+        int status = c->held_status;
+        c->held_status = 0;
+        c->net->cb.read(c, status, NULL);
+        return;
+    }
+    if (!(c->state & (ST_RECV_ARMED | ST_INPUT_END)) && arm_recv(c) < 0) {
+        c->net->cb.read(c, UV_ENOBUFS, NULL);
+    }
+}
+
+/* ─── completions ────────────────────────────────────────────────── */
+
+static void on_accept(uring_net_t *net, const struct io_uring_cqe *cqe) {
+    if (cqe->res >= 0) {
+        if (net->stopping || !net->cb.accept(net, cqe->res)) close(cqe->res);
+    } else if (cqe->res != -ECANCELED) {
+        fprintf(stderr, "[URING] Accept error: %s\n", strerror(-cqe->res));
+    }
+    if (!(cqe->flags & IORING_CQE_F_MORE) && !net->stopping) arm_accept(net);
+}
+
+static void on_recv(uring_net_t *net, uring_conn_t *c, const struct io_uring_cqe *cqe) {
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+        c->state &= ~(ST_RECV_ARMED | ST_RECV_CANCEL);
+        c->ops--;
+    }
+
+    int res = cqe->res;
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        unsigned bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        const char *data = net->bufs + (size_t)bid * BUF_SIZE;
+        if (res > 0 && !(c->state & ST_CLOSING)) {
+            if ((c->state & ST_READING) && !c->held_len && !c->held_status) {
+                net->cb.read(c, res, data);
+            } else if (hold(c, data, (size_t)res) < 0) {
+                c->held_status = UV_ENOMEM;
+                c->state |= ST_INPUT_END;
+            }
+        }
+        buf_give(net, bid);
+    } else if (res != -ENOBUFS && res != -ECANCELED && !(c->state & ST_CLOSING)) {
+        /* EOF (0) or an error: nothing more will come.  UV error codes
+           are negated errno values on Linux. */
+        int status = res == 0 ? UV_EOF : res;
+        c->state |= ST_INPUT_END;
+        if ((c->state & ST_READING) && !c->held_len) net->cb.read(c, status, NULL);
+        else c->held_status = status;
+    }
+
+    if (c->state & ST_CLOSING) {
+        if (c->ops == 0) defer(c);
+        return;
+    }
+    /* multishot ended (buffers ran dry, a cancel that raced a restart):
+       re-arm while the owner still reads */
+    if ((c->state & ST_READING) && !(c->state & (ST_RECV_ARMED | ST_INPUT_END)) &&
+        !c->held_len && arm_recv(c) < 0) {
+        net->cb.read(c, UV_ENOBUFS, NULL);
+    }
+}
+
+static void on_send(uring_conn_t *c, const struct io_uring_cqe *cqe) {
+    uring_write_t *w = c->wq_head;
+    c->state &= ~ST_SENDING;
+    c->ops--;
+
+    int status = cqe->res < 0 ? cqe->res : 0;
+    if (cqe->res > 0) {
+        /* short send: step over what went out and go again */
+        size_t sent = (size_t)cqe->res;
+        while (w->iovcnt && sent >= w->iov->iov_len) {
+            sent -= w->iov->iov_len;
+            w->iov++;
+            w->iovcnt--;
+        }
+        if (w->iovcnt) {
+            w->iov->iov_base = (char*)w->iov->iov_base + sent;
+            w->iov->iov_len -= sent;
+            if (c->state & ST_CLOSING) status = UV_ECANCELED;
+            else if ((status = send_head(c)) == 0) return;
+        }
+    }
+
+    c->wq_head = w->next;
+    if (!c->wq_head) c->wq_tail = NULL;
+    c->net->cb.written(c, w, status);
+
+    if (c->state & ST_CLOSING) {
+        if (c->ops == 0) defer(c);
+        return;
+    }
+    if (c->wq_head) {
+        if (!(c->state & ST_SENDING) && (status = send_head(c)) < 0) {
+            /* the owner closes on a failed write; the close cancels the rest */
+            w = c->wq_head;
+            c->wq_head = w->next;
+            if (!c->wq_head) c->wq_tail = NULL;
+            c->net->cb.written(c, w, status);
+        }
+    } else if (c->state & ST_SHUT_WANTED) {
+        if ((status = send_shutdown(c)) < 0) c->net->cb.shutdown(c, status);
+    }
+}
+
+static void dispatch(uring_net_t *net, const struct io_uring_cqe *cqe) {
+    unsigned op = (unsigned)(cqe->user_data & OP_MASK);
+    void *obj = (void*)(uintptr_t)(cqe->user_data & ~(uint64_t)OP_MASK);
+
+    if (op == OP_ACCEPT) {
+        on_accept(net, cqe);
+        return;
+    }
+
+    uring_conn_t *c = obj;
+    switch (op) {
+    case OP_RECV:
+        on_recv(net, c, cqe);
+        break;
+    case OP_SEND:
+        on_send(c, cqe);
+        break;
+    case OP_SHUTDOWN:
+        c->ops--;
+        if (!(c->state & ST_CLOSING)) net->cb.shutdown(c, cqe->res < 0 ? cqe->res : 0);
+        else if (c->ops == 0) defer(c);
+        break;
+    case OP_CANCEL:
+        c->ops--;
+        if ((c->state & ST_CLOSING) && c->ops == 0) defer(c);
+        break;
+    }
+}
+
+/* Reap every completion.  The head moves before each dispatch, so a
+   callback that has to reap (a full ring) never sees an entry twice. */
+static void drain(uring_net_t *net) {
+    for (;;) {
+        unsigned head = *net->cq_head;
+        if (head == __atomic_load_n(net->cq_tail, __ATOMIC_ACQUIRE)) break;
+        struct io_uring_cqe cqe = net->cqes[head & net->cq_mask];
+        __atomic_store_n(net->cq_head, head + 1, __ATOMIC_RELEASE);
+        dispatch(net, &cqe);
+    }
+    buf_publish(net);
+}
+
+static void poll_cb(uv_poll_t *handle, int status, int events) {
+    (void)status;
+    (void)events;
+    uring_net_t *net = handle->data;
+    drain(net);
+
+    /* completions that overflowed the CQ are flushed into it by an enter */
+    if (__atomic_load_n(net->sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) {
+        sys_enter(net->ring_fd, 0, 0, IORING_ENTER_GETEVENTS);
+        drain(net);
+    }
+}
+
+/* Once per loop iteration, just before it blocks: finish what was
+   deferred, then submit the iteration's SQEs in one go */
+static void prepare_cb(uv_prepare_t *handle) {
+    uring_net_t *net = handle->data;
+
+    while (net->deferred) {
+        uring_conn_t *c = net->deferred;
+        net->deferred = c->deferred_next;
+        c->state &= ~ST_DEFERRED;
+        if (c->state & ST_CLOSING) {
+            if (c->ops == 0) finish_close(c);
+        } else {
+            deliver_held(c);
+        }
+    }
+    buf_publish(net);
+
+    int rc = submit(net);
+    if (rc < 0 && rc != -EBUSY && rc != -EAGAIN && rc != -EINTR) {
+        fprintf(stderr, "[URING] Submit failed: %s\n", strerror(-rc));
+    }
+}
+
+/* ─── setup / teardown ───────────────────────────────────────────── */
+
+/* multishot recv needs Linux 6.0 (provided buffer rings 5.19) */
+static int kernel_supported(void) {
+    struct utsname u;
+    int major = 0;
+    if (uname(&u) != 0 || sscanf(u.release, "%d.", &major) != 1) return 0;
+    return major >= 6;
+}
+
+static void unmap_rings(uring_net_t *net) {
+    if (net->sqes) munmap(net->sqes, net->sqe_map_len);
+    if (net->cq_map && net->cq_map != net->sq_map) munmap(net->cq_map, net->cq_map_len);
+    if (net->sq_map) munmap(net->sq_map, net->sq_map_len);
+    if (net->br) munmap(net->br, net->br_len);
+    free(net->bufs);
+    if (net->ring_fd >= 0) close(net->ring_fd);
+}
+
+static int map_rings(uring_net_t *net, const struct io_uring_params *p) {
+    net->sq_map_len = p->sq_off.array + p->sq_entries * sizeof(unsigned);
+    net->cq_map_len = p->cq_off.cqes + p->cq_entries * sizeof(struct io_uring_cqe);
+    if (p->features & IORING_FEAT_SINGLE_MMAP) {
+        if (net->cq_map_len > net->sq_map_len) net->sq_map_len = net->cq_map_len;
+        net->cq_map_len = net->sq_map_len;
+    }
+
+    net->sq_map = mmap(NULL, net->sq_map_len, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, net->ring_fd, IORING_OFF_SQ_RING);
+    if (net->sq_map == MAP_FAILED) { net->sq_map = NULL; return -errno; }
+
+    if (p->features & IORING_FEAT_SINGLE_MMAP) {
+        net->cq_map = net->sq_map;
+    } else {
+        net->cq_map = mmap(NULL, net->cq_map_len, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, net->ring_fd, IORING_OFF_CQ_RING);
+        if (net->cq_map == MAP_FAILED) { net->cq_map = NULL; return -errno; }
+    }
+
+    net->sqe_map_len = p->sq_entries * sizeof(struct io_uring_sqe);
+    net->sqes = mmap(NULL, net->sqe_map_len, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, net->ring_fd, IORING_OFF_SQES);
+    if (net->sqes == MAP_FAILED) { net->sqes = NULL; return -errno; }
+
+    char *sq = net->sq_map, *cq = net->cq_map;
+    net->sq_head    = (unsigned*)(sq + p->sq_off.head);
+    net->sq_tail    = (unsigned*)(sq + p->sq_off.tail);
+    net->sq_flags   = (unsigned*)(sq + p->sq_off.flags);
+    net->sq_mask    = *(unsigned*)(sq + p->sq_off.ring_mask);
+    net->sq_entries = *(unsigned*)(sq + p->sq_off.ring_entries);
+    net->cq_head    = (unsigned*)(cq + p->cq_off.head);
+    net->cq_tail    = (unsigned*)(cq + p->cq_off.tail);
+    net->cq_mask    = *(unsigned*)(cq + p->cq_off.ring_mask);
+    net->cqes       = (struct io_uring_cqe*)(cq + p->cq_off.cqes);
+    net->sq_local_tail = *net->sq_tail;
+
+    /* SQ slots map 1:1 onto SQEs */
+    unsigned *array = (unsigned*)(sq + p->sq_off.array);
+    for (unsigned i = 0; i < net->sq_entries; i++) array[i] = i;
+    return 0;
+}
+
+static int setup_buffers(uring_net_t *net) {
+    net->br_len = BUF_COUNT * sizeof(struct io_uring_buf);
+    net->br = mmap(NULL, net->br_len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (net->br == MAP_FAILED) { net->br = NULL; return -errno; }
+    net->bufs = malloc((size_t)BUF_COUNT * BUF_SIZE);
+    if (!net->bufs) return -ENOMEM;
+
+    struct io_uring_buf_reg reg = {
+        .ring_addr    = (uint64_t)(uintptr_t)net->br,
+        .ring_entries = BUF_COUNT,
+        .bgid         = BUF_GROUP
+    };
+    if (sys_register(net->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) return -errno;
+
+    for (unsigned i = 0; i < BUF_COUNT; i++) buf_give(net, i);
+    buf_publish(net);
+    return 0;
+}
+
+uring_net_t *uring_net_start(uv_loop_t *loop, int listen_fd,
+                             const uring_net_callbacks_t *cb, int *err) {
+    if (!kernel_supported()) { *err = UV_ENOSYS; return NULL; }
+
+    uring_net_t *net = calloc(1, sizeof(*net));
+    if (!net) { *err = UV_ENOMEM; return NULL; }
+    net->listen_fd = listen_fd;
+    net->cb = *cb;
+
+    /* one issuer (this loop's thread); retry plain on older kernels */
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_SINGLE_ISSUER;
+    net->ring_fd = sys_setup(RING_ENTRIES, &p);
+    if (net->ring_fd < 0 && errno == EINVAL) {
+        memset(&p, 0, sizeof(p));
+        net->ring_fd = sys_setup(RING_ENTRIES, &p);
+    }
+
+    int rc = net->ring_fd < 0 ? -errno : 0;
+    if (rc == 0 && !(p.features & IORING_FEAT_NODROP)) rc = -ENOSYS;
+    if (rc == 0) rc = map_rings(net, &p);
+    if (rc == 0) rc = setup_buffers(net);
+    if (rc == 0) rc = arm_accept(net);
+    if (rc == 0) rc = submit(net);
+    if (rc < 0) {
+        unmap_rings(net);
+        free(net);
+        *err = rc;
+        return NULL;
+    }
+
+    uv_poll_init(loop, &net->poll, net->ring_fd);
+    uv_prepare_init(loop, &net->prepare);
+    net->poll.data = net->prepare.data = net;
+    net->handles_open = 2;
+    uv_poll_start(&net->poll, UV_READABLE, poll_cb);
+    uv_prepare_start(&net->prepare, prepare_cb);
+    return net;
+}
+
+static void handle_closed(uv_handle_t *handle) {
+    uring_net_t *net = handle->data;
+    if (--net->handles_open > 0) return;
+    unmap_rings(net);           /* closing the ring cancels what is left */
+    free(net);
+}
+
+void uring_net_stop(uring_net_t *net) {
+    if (net->stopping) return;
+    net->stopping = 1;
+    uv_close((uv_handle_t*)&net->poll, handle_closed);
+    uv_close((uv_handle_t*)&net->prepare, handle_closed);
+}
+
+/* ─── public connection API ──────────────────────────────────────── */
+
+void uring_conn_init(uring_conn_t *c, uring_net_t *net, int fd, void *data) {
+    memset(c, 0, sizeof(*c));
+    c->net  = net;
+    c->fd   = fd;
+    c->data = data;
+}
+
+int uring_conn_read_start(uring_conn_t *c) {
+    if (c->state & ST_CLOSING) return UV_EINVAL;
+    c->state |= ST_READING;
+    if (c->held_len || c->held_status) {
+        defer(c);               /* delivered from the loop, like any read */
+        return 0;
+    }
+    if (c->state & (ST_RECV_ARMED | ST_INPUT_END)) return 0;
+    return arm_recv(c);
+}
+
+void uring_conn_read_stop(uring_conn_t *c) {
+    c->state &= ~ST_READING;
+    if ((c->state & ST_RECV_ARMED) && !(c->state & ST_RECV_CANCEL)) {
+        c->state |= ST_RECV_CANCEL;
+        cancel(c, OP_RECV);
+    }
+}
+
+int uring_conn_write(uring_conn_t *c, uring_write_t *w,
+                     struct iovec *iov, int iovcnt) {
+    if (c->state & ST_CLOSING) return UV_EPIPE;
+    w->next   = NULL;
+    w->iov    = iov;
+    w->iovcnt = iovcnt;
+
+    if (c->wq_tail) c->wq_tail->next = w;
+    else c->wq_head = w;
+    c->wq_tail = w;
+
+    if (c->state & ST_SENDING) return 0;
+    int rc = send_head(c);
+    if (rc < 0) {
+        c->wq_head = c->wq_tail = NULL;
+    }
+    return rc;
+}
+
+int uring_conn_shutdown(uring_conn_t *c) {
+    if (c->state & ST_CLOSING) return UV_ENOTCONN;
+    if (c->wq_head) {
+        c->state |= ST_SHUT_WANTED;
+        return 0;
+    }
+    return send_shutdown(c);
+}
+
+void uring_conn_close(uring_conn_t *c) {
+    if (c->state & ST_CLOSING) return;
+    c->state |= ST_CLOSING;
+    c->state &= ~(ST_READING | ST_SHUT_WANTED);
+
+    if ((c->state & ST_RECV_ARMED) && !(c->state & ST_RECV_CANCEL)) {
+        c->state |= ST_RECV_CANCEL;
+        cancel(c, OP_RECV);
+    }
+    if (c->state & ST_SENDING) cancel(c, OP_SEND);
+    if (c->ops == 0) defer(c);
+}
+
+int uring_conn_closing(const uring_conn_t *c) {
+    return (c->state & ST_CLOSING) != 0;
+}
+
+#else   /* no io_uring headers: the backend is never available */
+
+uring_net_t *uring_net_start(uv_loop_t *loop, int listen_fd,
+                             const uring_net_callbacks_t *cb, int *err) {
+    (void)loop; (void)listen_fd; (void)cb;
+    *err = UV_ENOSYS;
+    return NULL;
+}
+
+void uring_net_stop(uring_net_t *net) { (void)net; }
+
+void uring_conn_init(uring_conn_t *c, uring_net_t *net, int fd, void *data) {
+    memset(c, 0, sizeof(*c));
+    c->net = net; c->fd = fd; c->data = data;
+}
+
+int  uring_conn_read_start(uring_conn_t *c) { (void)c; return UV_ENOSYS; }
+void uring_conn_read_stop(uring_conn_t *c) { (void)c; }
+int  uring_conn_write(uring_conn_t *c, uring_write_t *w, struct iovec *iov, int iovcnt) {
+    (void)c; (void)w; (void)iov; (void)iovcnt;
+    return UV_ENOSYS;
+}
+int  uring_conn_shutdown(uring_conn_t *c) { (void)c; return UV_ENOSYS; }
+void uring_conn_close(uring_conn_t *c) { (void)c; }
+int  uring_conn_closing(const uring_conn_t *c) { (void)c; return 1; }
+
+#endif
@@ -0,0 +1,89 @@
+// uring_net.h
+#ifndef URING_NET_H
+#define URING_NET_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <uv.h>
+
+/// Native Linux socket I/O on io_uring, driven from a libuv loop: the
+/// ring's fd is watched by the loop, so timers, the thread pool and
+/// async handles keep working while accept, recv and send bypass
+/// libuv's stream layer.  Multishot accept; multishot recv into a ring
+/// of provided buffers (no buffer is tied to an idle connection); sends
+/// queued per connection, one sendmsg in flight each; every submission
+/// of one loop iteration goes to the kernel in a single io_uring_enter.
+/// One instance per event loop, used from that loop's thread only.
+///
+/// Callback semantics mirror libuv streams: reads stop promptly (bytes
+/// the kernel already delivered wait for the next read_start), queued
+/// writes complete with UV_ECANCELED on close, and `closed` runs from
+/// the loop after every operation on the socket has finished.
+
+typedef struct uring_net   uring_net_t;
+typedef struct uring_conn  uring_conn_t;
+typedef struct uring_write uring_write_t;
+
+/// One queued send.  `iov` is caller memory that must stay valid until
+/// the written callback; short sends advance it in place.
+struct uring_write {
+    uring_write_t *next;
+    struct iovec  *iov;
+    int            iovcnt;
+    struct msghdr  msg;
+};
+
+/// Embed in the owner's connection object.  Fields are private.
+struct uring_conn {
+    uring_net_t   *net;
+    int            fd;
+    unsigned       state;
+    int            ops;          ///< submissions still owing a completion
+    uring_write_t *wq_head, *wq_tail;
+    char          *held;         ///< received while reading was stopped
+    size_t         held_len, held_cap;
+    int            held_status;  ///< ... and the EOF/error behind it
+    uring_conn_t  *deferred_next;
+    void          *data;         ///< owner
+};
+
+typedef struct {
+    /// A connection arrived on `fd`: return its uring_conn_t (set up
+    /// with uring_conn_init), or NULL to refuse it (the fd is closed).
+    uring_conn_t *(*accept)(uring_net_t *net, int fd);
+    /// nread > 0 bytes, or UV_EOF / a negative UV error code.
+    void (*read)(uring_conn_t *c, ssize_t nread, const char *data);
+    void (*written)(uring_conn_t *c, uring_write_t *w, int status);
+    void (*shutdown)(uring_conn_t *c, int status);
+    void (*closed)(uring_conn_t *c);
+} uring_net_callbacks_t;
+
+/// Set up a ring on `loop` accepting from `listen_fd` (already listening).
+/// NULL when io_uring or a feature it needs is unavailable; `*err` then
+/// holds a UV error code and the caller should fall back to libuv.
+uring_net_t *uring_net_start(uv_loop_t *loop, int listen_fd,
+                             const uring_net_callbacks_t *cb, int *err);
+
+/// Stop accepting and release the ring.  Connections must be closed.
+void uring_net_stop(uring_net_t *net);
+
+void uring_conn_init(uring_conn_t *c, uring_net_t *net, int fd, void *data);
+
+/// Start / stop delivering reads.  Returns 0 or a UV error code.
+int  uring_conn_read_start(uring_conn_t *c);
+void uring_conn_read_stop(uring_conn_t *c);
+
+/// Queue `iov[0..iovcnt)` behind earlier writes.
+int  uring_conn_write(uring_conn_t *c, uring_write_t *w,
+                      struct iovec *iov, int iovcnt);
+
+/// Half-close (SHUT_WR) once the queued writes are out.
+int  uring_conn_shutdown(uring_conn_t *c);
+
+/// Cancel what is in flight, then close the fd and call `closed`.
+void uring_conn_close(uring_conn_t *c);
+int  uring_conn_closing(const uring_conn_t *c);
+
+#endif // URING_NET_H
@@ -0,0 +1,47 @@
+// user.c
+#include "user.h"
+#include <stdlib.h>
+#include "aof_batch.h"
+
+int user_save(Storage *st, const User *u) {
+    storage_key_lock(st, u->id);
+    if (AOF_append(u->id, u, sizeof(*u)) < 0) {
+        storage_key_unlock(st, u->id);
+        return -1;
+    }
+    storage_save(st, u->id, u, sizeof(*u));
+    storage_key_unlock(st, u->id);
+    return 0;
+}
+
+int user_save_batch(Storage *st, const User *users, size_t n) {
+    aof_rec_t *recs = malloc(n * sizeof(*recs));
+    if (!recs) return -1;
+    for (size_t i = 0; i < n; i++) {
+        recs[i] = (aof_rec_t){ users[i].id, &users[i], sizeof(users[i]) };
+    }
+
+    // Ids may land on any stripe: take them all rather than order a subset
+    storage_key_lock_all(st);
+    int rc = AOF_append_batch(recs, n);
+    if (rc == 0) {
+        for (size_t i = 0; i < n; i++) {
+            storage_save(st, users[i].id, &users[i], sizeof(users[i]));
+        }
+    }
+    storage_key_unlock_all(st);
+    free(recs);
+    return rc < 0 ? -1 : 0;
+}
+
+int user_remove(Storage *st, int id) {
+    User u;
+    int rc = 0;
+    storage_key_lock(st, id);
+    if (storage_get(st, id, &u, sizeof(u))) {
+        rc = AOF_append(id, NULL, 0) < 0 ? -1 : 1;
+        if (rc == 1) storage_remove(st, id);
+    }
+    storage_key_unlock(st, id);
+    return rc;
+}
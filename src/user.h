@@ -1,9 +1,29 @@
 #ifndef RAMFORGE_USER_H
 #define RAMFORGE_USER_H
 
+#include "storage.h"
+
 #define MAX_NAME_LEN 64
 typedef struct {
     int id;
     char name[MAX_NAME_LEN];
 } User;
+
+/// The one write path for a user, whatever protocol it came in on:
+/// AOF-first (logged, then applied), under the key's writer lock so
+/// several loops on one Storage log and apply in the same order.
+/// Returns 0, or -1 if the AOF refused the record (disk full); the
+/// table is then left unchanged.
+int user_save(Storage *st, const User *u);
+
+/// `n` users through the same path as one AOF batch frame (a single
+/// CRC, replayed all or nothing), then into the table in one pass.  Every
+/// key lock is held throughout.  Returns 0, or -1 with nothing stored.
+int user_save_batch(Storage *st, const User *users, size_t n);
+
+/// Remove user `id` the same way (a removal record in the AOF first).
+/// Returns 1 if it was removed, 0 if there was no such user, -1 if the
+/// AOF refused the record.
+int user_remove(Storage *st, int id);
+
 #endif //RAMFORGE_USER_H
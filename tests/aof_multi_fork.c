@@ -1,6 +1,6 @@
 // compile with:
 //   gcc -pthread -Isrc -o tests/aof_multi_fork tests/aof_multi_fork.c \
-//       src/aof_batch.c src/storage.c src/crc32c.c
+//       src/aof_batch.c src/storage.c src/slab_alloc.c src/hugepage.c src/numa_topo.c src/crc32c.c
 #define _GNU_SOURCE
 #include <unistd.h>
 #include <sys/wait.h>
@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include "../src/storage.h"
 #include "../src/aof_batch.h"
+#include "../src/slab_alloc.h"
 
 /* helper: save + append */
 static void put(Storage *st, int id) {
@@ -23,6 +24,7 @@ int main(void)
 {
     printf("Starting test...\n");
     unlink("mf.aof");
+    slab_init();
     Storage st; storage_init(&st);
     AOF_init("mf.aof", 1<<12, 0);          /* --aof always */
 
@@ -0,0 +1,247 @@
+// compile with:
+//   gcc -O2 -pthread -Isrc -o tests/bench/bin_load tests/bench/bin_load.c
+//
+// usage: bin_load [port] [threads] [conns] [seconds] [depth] [keys] [ids]
+//
+// http_load's counterpart for the binary protocol (--bin-port): every
+// connection keeps `depth` pipelined GET frames in flight, each asking
+// for `ids` random ids out of 1..keys (ids > 1 is a multi-get).  Prints
+// frames and users per second and the p50/p99 batch round trip,
+// labelled with $BIN_LOAD_LABEL.  bin_proto.sh compares it with HTTP.
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "bin_proto.h"
+
+#define MAX_DEPTH 64
+#define MAX_IDS   256
+
+typedef struct {
+    int      fd;
+    int      inflight;     /* frames sent, responses not yet complete */
+    size_t   skip;         /* payload bytes of the current response still to come */
+    char     hdr[sizeof(bin_header_t)];
+    size_t   hdr_len;      /* header bytes of the next response seen so far */
+    double   sent_at;
+} conn_t;
+
+typedef struct {
+    pthread_t thread;
+    int       port, conns, depth, keys, ids;
+    unsigned  seed;
+    double    seconds;
+    uint64_t  frames, users;
+    int       failed;
+    double   *lat;
+    size_t    nlat, lat_cap;
+} worker_t;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int connect_one(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in sa = { .sin_family = AF_INET, .sin_port = htons((uint16_t)port) };
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr *)&sa, sizeof sa) < 0) { close(fd); return -1; }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    return fd;
+}
+
+/* queue `depth` GET frames in one write */
+static int send_batch(worker_t *w, conn_t *c)
+{
+    static __thread char buf[MAX_DEPTH * (sizeof(bin_header_t) + MAX_IDS * 4)];
+    size_t len = 0;
+    for (int i = 0; i < w->depth; i++) {
+        bin_header_t h = { .len = (uint32_t)(w->ids * 4), .op = BIN_OP_GET,
+                           .count = (uint16_t)w->ids };
+        memcpy(buf + len, &h, sizeof h);
+        len += sizeof h;
+        for (int k = 0; k < w->ids; k++) {
+            int32_t id = (int32_t)(rand_r(&w->seed) % (unsigned)w->keys) + 1;
+            memcpy(buf + len, &id, 4);
+            len += 4;
+        }
+    }
+    for (size_t off = 0; off < len; ) {
+        ssize_t n = write(c->fd, buf + off, len - off);
+        if (n <= 0) return -1;
+        off += (size_t)n;
+    }
+    c->inflight = w->depth;
+    c->sent_at = now_sec();
+    return 0;
+}
+
+static void record_latency(worker_t *w, double sec)
+{
+    if (w->nlat == w->lat_cap) {
+        size_t cap = w->lat_cap ? w->lat_cap * 2 : 4096;
+        double *lat = realloc(w->lat, cap * sizeof *lat);
+        if (!lat) return;
+        w->lat = lat;
+        w->lat_cap = cap;
+    }
+    w->lat[w->nlat++] = sec;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* walk response frames: header, then skip its payload */
+static int count_responses(worker_t *w, conn_t *c, const char *data, size_t n)
+{
+    int found = 0;
+    while (n) {
+        if (c->skip) {
+            size_t k = n < c->skip ? n : c->skip;
+            c->skip -= k; data += k; n -= k;
+            if (c->skip == 0) found++;
+            continue;
+        }
+        size_t k = sizeof c->hdr - c->hdr_len;
+        if (k > n) k = n;
+        memcpy(c->hdr + c->hdr_len, data, k);
+        c->hdr_len += k; data += k; n -= k;
+        if (c->hdr_len < sizeof c->hdr) break;
+
+        bin_header_t h;
+        memcpy(&h, c->hdr, sizeof h);
+        c->hdr_len = 0;
+        if (h.status != BIN_OK) w->failed = 1;
+        w->users += h.count;
+        c->skip = h.len;
+        if (c->skip == 0) found++;
+    }
+    return found;
+}
+
+static void *worker_main(void *arg)
+{
+    worker_t *w = arg;
+    conn_t *conns = calloc((size_t)w->conns, sizeof *conns);
+    struct pollfd *pfds = calloc((size_t)w->conns, sizeof *pfds);
+    if (!conns || !pfds) { w->failed = 1; return NULL; }
+
+    for (int i = 0; i < w->conns; i++) {
+        conns[i].fd = connect_one(w->port);
+        if (conns[i].fd < 0 || send_batch(w, &conns[i]) < 0) { w->failed = 1; goto out; }
+        pfds[i].fd = conns[i].fd;
+        pfds[i].events = POLLIN;
+    }
+
+    char buf[65536];
+    double end = now_sec() + w->seconds;
+    while (now_sec() < end) {
+        if (poll(pfds, (nfds_t)w->conns, 100) <= 0) continue;
+        for (int i = 0; i < w->conns; i++) {
+            if (!(pfds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            ssize_t n = read(conns[i].fd, buf, sizeof buf);
+            if (n <= 0) { w->failed = 1; goto out; }
+
+            int got = count_responses(w, &conns[i], buf, (size_t)n);
+            conns[i].inflight -= got;
+            w->frames += (uint64_t)got;
+            if (conns[i].inflight > 0) continue;
+            record_latency(w, now_sec() - conns[i].sent_at);
+            if (send_batch(w, &conns[i]) < 0) { w->failed = 1; goto out; }
+        }
+    }
+
+out:
+    for (int i = 0; i < w->conns; i++)
+        if (conns[i].fd > 0) close(conns[i].fd);
+    free(conns);
+    free(pfds);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int    port    = argc > 1 ? atoi(argv[1]) : 1110;
+    int    threads = argc > 2 ? atoi(argv[2]) : 1;
+    int    conns   = argc > 3 ? atoi(argv[3]) : 64;
+    double seconds = argc > 4 ? atof(argv[4]) : 5.0;
+    int    depth   = argc > 5 ? atoi(argv[5]) : 16;
+    int    keys    = argc > 6 ? atoi(argv[6]) : 10000;
+    int    ids     = argc > 7 ? atoi(argv[7]) : 1;
+    const char *label = getenv("BIN_LOAD_LABEL");
+
+    if (threads < 1) threads = 1;
+    if (conns < threads) conns = threads;
+    if (depth < 1) depth = 1;
+    if (depth > MAX_DEPTH) depth = MAX_DEPTH;
+    if (keys < 1) keys = 1;
+    if (ids < 1) ids = 1;
+    if (ids > MAX_IDS) ids = MAX_IDS;
+
+    worker_t *ws = calloc((size_t)threads, sizeof *ws);
+    if (!ws) return 1;
+
+    double t0 = now_sec();
+    for (int i = 0; i < threads; i++) {
+        ws[i].port    = port;
+        ws[i].conns   = conns / threads + (i < conns % threads);
+        ws[i].depth   = depth;
+        ws[i].keys    = keys;
+        ws[i].ids     = ids;
+        ws[i].seconds = seconds;
+        ws[i].seed    = 0x9e3779b9u * (unsigned)(i + 1);
+        pthread_create(&ws[i].thread, NULL, worker_main, &ws[i]);
+    }
+
+    uint64_t frames = 0, users = 0;
+    size_t nlat = 0;
+    int failed = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ws[i].thread, NULL);
+        frames += ws[i].frames;
+        users  += ws[i].users;
+        failed |= ws[i].failed;
+        nlat   += ws[i].nlat;
+    }
+    double elapsed = now_sec() - t0;
+
+    double p50 = 0, p99 = 0;
+    double *lat = malloc((nlat ? nlat : 1) * sizeof *lat);
+    if (lat && nlat) {
+        size_t k = 0;
+        for (int i = 0; i < threads; i++) {
+            memcpy(lat + k, ws[i].lat, ws[i].nlat * sizeof *lat);
+            k += ws[i].nlat;
+        }
+        qsort(lat, nlat, sizeof *lat, cmp_double);
+        p50 = lat[nlat / 2];
+        p99 = lat[nlat * 99 / 100];
+    }
+
+    printf("%-22s conns=%-4d depth=%-3d %10.0f req/s %10.0f users/s  p50=%.2fms p99=%.2fms%s\n",
+           label ? label : "bin_load", conns, depth, frames / elapsed, users / elapsed,
+           p50 * 1e3, p99 * 1e3, failed ? "  (errors)" : "");
+    for (int i = 0; i < threads; i++)
+        free(ws[i].lat);
+    free(lat);
+    free(ws);
+    return failed;
+}
@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+# Internal-client throughput: GET /users/<id> over HTTP (http_load)
+# against the binary protocol on --bin-port (bin_load), single gets and
+# multi-gets of IDS ids per frame, same keys, same pipelining depth.
+set -e
+ROOT="$( cd -- "$(dirname -- "${BASH_SOURCE[0]}")/../.." &>/dev/null && pwd )"
+BIN=${BIN:-$ROOT/ramforge}
+HTTP_CLIENT=${HTTP_CLIENT:-$ROOT/tests/bench/http_load}
+BIN_CLIENT=${BIN_CLIENT:-$ROOT/tests/bench/bin_load}
+KEYS=${KEYS:-1000}
+SECONDS_PER_RUN=${SECONDS_PER_RUN:-5}
+CONNS=${CONNS:-64}
+DEPTH=${DEPTH:-16}
+IDS=${IDS:-16}
+BIN_PORT=${BIN_PORT:-1110}
+[[ -x "$BIN" ]] || { echo "❌ ramforge binary not found"; exit 1; }
+
+ulimit -n "$(ulimit -Hn)" 2>/dev/null || true
+WORK=$(mktemp -d); trap 'rm -rf "$WORK"' EXIT
+cd "$WORK"
+
+"$BIN" --workers 0 --bin-port "$BIN_PORT" >/dev/null 2>&1 &
+PID=$!
+for _ in $(seq 50); do
+    curl -s -o /dev/null http://localhost:1109/health && break
+    sleep 0.1
+done
+for i in $(seq 1 "$KEYS"); do
+    curl -s -o /dev/null -XPOST -d "{\"id\":$i,\"name\":\"user_$i\"}" http://localhost:1109/users
+done
+
+HTTP_LOAD_LABEL="http GET" "$HTTP_CLIENT" 1109 1 "$CONNS" "$SECONDS_PER_RUN" "$DEPTH" "$KEYS" || true
+BIN_LOAD_LABEL="binary GET" "$BIN_CLIENT" "$BIN_PORT" 1 "$CONNS" "$SECONDS_PER_RUN" "$DEPTH" "$KEYS" 1 || true
+BIN_LOAD_LABEL="binary GET x$IDS" "$BIN_CLIENT" "$BIN_PORT" 1 "$CONNS" "$SECONDS_PER_RUN" "$DEPTH" "$KEYS" "$IDS" || true
+
+kill "$PID"; wait "$PID" 2>/dev/null || true
+exit 0
@@ -0,0 +1,112 @@
+// compile with:
+//   gcc -O2 -o tests/bench/conn_mem tests/bench/conn_mem.c
+//
+// usage: conn_mem <server-pid> [conns] [port]
+//
+// Memory per idle keep-alive connection.  Opens `conns` sockets to a
+// running server, sends one GET /users/1 on each and waits for the
+// reply, so every connection has been through a full read/parse/write
+// cycle and then sits idle.  Reports the server's RSS growth divided by
+// the connection count.  conn_mem.sh starts the server and sweeps sizes.
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+static long rss_kb(int pid)
+{
+    char path[64], line[256];
+    long kb = -1;
+    snprintf(path, sizeof path, "/proc/%d/status", pid);
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    while (fgets(line, sizeof line, f))
+        if (sscanf(line, "VmRSS: %ld kB", &kb) == 1) break;
+    fclose(f);
+    return kb;
+}
+
+static int connect_one(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in sa = { .sin_family = AF_INET, .sin_port = htons((uint16_t)port) };
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr *)&sa, sizeof sa) < 0) { close(fd); return -1; }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    return fd;
+}
+
+/* one request, read until the header block and Content-Length body are in */
+static int round_trip(int fd)
+{
+    static const char req[] =
+        "GET /users/1 HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n";
+    if (write(fd, req, sizeof req - 1) != (ssize_t)(sizeof req - 1)) return -1;
+
+    char buf[4096];
+    size_t got = 0;
+    for (;;) {
+        ssize_t n = read(fd, buf + got, sizeof buf - 1 - got);
+        if (n <= 0) return -1;
+        got += (size_t)n;
+        buf[got] = '\0';
+        char *eoh = strstr(buf, "\r\n\r\n");
+        char *cl  = strcasestr(buf, "Content-Length:");
+        if (eoh && cl && got >= (size_t)(eoh + 4 - buf) + strtoul(cl + 15, NULL, 10))
+            return 0;
+        if (got == sizeof buf - 1) return 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <server-pid> [conns] [port]\n", argv[0]);
+        return 2;
+    }
+    int pid   = atoi(argv[1]);
+    int conns = argc > 2 ? atoi(argv[2]) : 1000;
+    int port  = argc > 3 ? atoi(argv[3]) : 1109;
+
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < (rlim_t)conns + 64) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    int *fds = calloc((size_t)conns, sizeof *fds);
+    long before = rss_kb(pid);
+    if (before < 0) { fprintf(stderr, "no such pid %d\n", pid); return 1; }
+
+    int open_ok = 0;
+    for (int i = 0; i < conns; i++) {
+        fds[i] = connect_one(port);
+        if (fds[i] < 0 || round_trip(fds[i]) < 0) {
+            fprintf(stderr, "connection %d failed (fd limit?)\n", i);
+            if (fds[i] >= 0) close(fds[i]);
+            break;
+        }
+        open_ok++;
+    }
+
+    struct timespec settle = { 0, 200 * 1000 * 1000 };
+    nanosleep(&settle, NULL);
+    long after = rss_kb(pid);
+
+    printf("conn_mem  %6d idle keep-alive conns  RSS %7ld → %7ld kB  %7.0f B/conn\n",
+           open_ok, before, after,
+           open_ok ? (double)(after - before) * 1024.0 / open_ok : 0.0);
+
+    for (int i = 0; i < open_ok; i++) close(fds[i]);
+    free(fds);
+    return open_ok == conns ? 0 : 1;
+}
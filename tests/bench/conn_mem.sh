@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+# Server RSS per idle keep-alive connection, for a sweep of connection counts.
+# Each size runs against a fresh single-process server (--workers 0).
+set -e
+ROOT="$( cd -- "$(dirname -- "${BASH_SOURCE[0]}")/../.." &>/dev/null && pwd )"
+BIN=${BIN:-$ROOT/ramforge}
+CLIENT=${CLIENT:-$ROOT/tests/bench/conn_mem}
+SIZES=${SIZES:-"100 1000 4000"}
+[[ -x "$BIN" ]] || { echo "❌ ramforge binary not found"; exit 1; }
+
+ulimit -n "$(ulimit -Hn)" 2>/dev/null || true
+WORK=$(mktemp -d); trap 'rm -rf "$WORK"' EXIT
+cd "$WORK"
+
+for n in $SIZES; do
+    "$BIN" --workers 0 >/dev/null 2>&1 &
+    PID=$!
+    sleep 0.5
+    curl -s -XPOST -d '{"id":1,"name":"neo"}' http://localhost:1109/users >/dev/null
+    "$CLIENT" "$PID" "$n" 1109 || true
+    kill "$PID"; wait "$PID" 2>/dev/null || true
+    rm -f append.aof dump.rdb*
+done
@@ -0,0 +1,240 @@
+// compile with:
+//   gcc -O2 -pthread -o tests/bench/http_load tests/bench/http_load.c
+//
+// usage: http_load [port] [threads] [conns] [seconds] [depth] [keys]
+//
+// Keep-alive GET /users/<id> load.  `conns` connections are spread over
+// `threads` client threads, each polling its share; every connection
+// keeps `depth` pipelined requests in flight over ids 1..keys.  Prints
+// the completed requests per second and the p50/p99 batch round trip
+// (send to last response), labelled with $HTTP_LOAD_LABEL.
+// Connections the server closes are reopened and counted.
+// loop_scale.sh and io_backend.sh start the servers and sweep settings.
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#define MAX_DEPTH 64
+
+typedef struct {
+    int      fd;
+    int      inflight;     /* requests sent, responses not yet seen */
+    char     tail[8];      /* last bytes of the previous read, for split markers */
+    size_t   tail_len;
+    double   sent_at;      /* when the current batch went out */
+} conn_t;
+
+typedef struct {
+    pthread_t thread;
+    int       port, conns, depth, keys;
+    unsigned  seed;
+    double    seconds;
+    uint64_t  done;
+    uint64_t  reconnects;
+    int       failed;
+    double   *lat;         /* batch round trips, seconds */
+    size_t    nlat, lat_cap;
+} worker_t;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int connect_one(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in sa = { .sin_family = AF_INET, .sin_port = htons((uint16_t)port) };
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr *)&sa, sizeof sa) < 0) { close(fd); return -1; }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    return fd;
+}
+
+/* queue `depth` requests in one write */
+static int send_batch(worker_t *w, conn_t *c)
+{
+    char buf[MAX_DEPTH * 64];
+    size_t len = 0;
+    for (int i = 0; i < w->depth; i++) {
+        int id = (int)(rand_r(&w->seed) % (unsigned)w->keys) + 1;
+        len += (size_t)snprintf(buf + len, sizeof buf - len,
+                                "GET /users/%d HTTP/1.1\r\nHost: x\r\n\r\n", id);
+    }
+    for (size_t off = 0; off < len; ) {
+        ssize_t n = write(c->fd, buf + off, len - off);
+        if (n <= 0) return -1;
+        off += (size_t)n;
+    }
+    c->inflight = w->depth;
+    c->sent_at = now_sec();
+    return 0;
+}
+
+static void record_latency(worker_t *w, double sec)
+{
+    if (w->nlat == w->lat_cap) {
+        size_t cap = w->lat_cap ? w->lat_cap * 2 : 4096;
+        double *lat = realloc(w->lat, cap * sizeof *lat);
+        if (!lat) return;
+        w->lat = lat;
+        w->lat_cap = cap;
+    }
+    w->lat[w->nlat++] = sec;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* count response status lines, including one split across two reads */
+static int count_responses(conn_t *c, const char *data, size_t n)
+{
+    static const char mark[] = "HTTP/1.1 ";
+    const size_t mlen = sizeof mark - 1;
+    char scan[sizeof c->tail + 65536];
+    memcpy(scan, c->tail, c->tail_len);
+    memcpy(scan + c->tail_len, data, n);
+    size_t total = c->tail_len + n;
+
+    int found = 0;
+    for (const char *p = scan; (p = memmem(p, total - (size_t)(p - scan), mark, mlen)); p += mlen)
+        found++;
+
+    /* keep a tail shorter than the marker, so nothing is counted twice */
+    c->tail_len = total < mlen - 1 ? total : mlen - 1;
+    memcpy(c->tail, scan + total - c->tail_len, c->tail_len);
+    return found;
+}
+
+static void *worker_main(void *arg)
+{
+    worker_t *w = arg;
+    conn_t *conns = calloc((size_t)w->conns, sizeof *conns);
+    struct pollfd *pfds = calloc((size_t)w->conns, sizeof *pfds);
+    if (!conns || !pfds) { w->failed = 1; return NULL; }
+
+    for (int i = 0; i < w->conns; i++) {
+        conns[i].fd = connect_one(w->port);
+        if (conns[i].fd < 0 || send_batch(w, &conns[i]) < 0) { w->failed = 1; goto out; }
+        pfds[i].fd = conns[i].fd;
+        pfds[i].events = POLLIN;
+    }
+
+    char buf[65536];
+    double end = now_sec() + w->seconds;
+    while (now_sec() < end) {
+        if (poll(pfds, (nfds_t)w->conns, 100) <= 0) continue;
+        for (int i = 0; i < w->conns; i++) {
+            if (!(pfds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            ssize_t n = read(conns[i].fd, buf, sizeof buf);
+            if (n <= 0) {
+                /* the server closes after its per-connection request cap:
+                   what was still in flight is lost, start over */
+                close(conns[i].fd);
+                conns[i] = (conn_t){ .fd = connect_one(w->port) };
+                if (conns[i].fd < 0 || send_batch(w, &conns[i]) < 0) { w->failed = 1; goto out; }
+                pfds[i].fd = conns[i].fd;
+                w->reconnects++;
+                continue;
+            }
+
+            int got = count_responses(&conns[i], buf, (size_t)n);
+            conns[i].inflight -= got;
+            w->done += (uint64_t)got;
+            if (conns[i].inflight > 0) continue;
+            record_latency(w, now_sec() - conns[i].sent_at);
+            if (send_batch(w, &conns[i]) < 0) { w->failed = 1; goto out; }
+        }
+    }
+
+out:
+    for (int i = 0; i < w->conns; i++)
+        if (conns[i].fd > 0) close(conns[i].fd);
+    free(conns);
+    free(pfds);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int    port    = argc > 1 ? atoi(argv[1]) : 1109;
+    int    threads = argc > 2 ? atoi(argv[2]) : 1;
+    int    conns   = argc > 3 ? atoi(argv[3]) : 64;
+    double seconds = argc > 4 ? atof(argv[4]) : 5.0;
+    int    depth   = argc > 5 ? atoi(argv[5]) : 16;
+    int    keys    = argc > 6 ? atoi(argv[6]) : 10000;
+    const char *label = getenv("HTTP_LOAD_LABEL");
+
+    if (threads < 1) threads = 1;
+    if (conns < threads) conns = threads;
+    if (depth < 1) depth = 1;
+    if (depth > MAX_DEPTH) depth = MAX_DEPTH;
+    if (keys < 1) keys = 1;
+
+    worker_t *ws = calloc((size_t)threads, sizeof *ws);
+    if (!ws) return 1;
+
+    double t0 = now_sec();
+    for (int i = 0; i < threads; i++) {
+        ws[i].port    = port;
+        ws[i].conns   = conns / threads + (i < conns % threads);
+        ws[i].depth   = depth;
+        ws[i].keys    = keys;
+        ws[i].seconds = seconds;
+        ws[i].seed    = 0x9e3779b9u * (unsigned)(i + 1);
+        pthread_create(&ws[i].thread, NULL, worker_main, &ws[i]);
+    }
+
+    uint64_t done = 0, reconnects = 0;
+    size_t nlat = 0;
+    int failed = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ws[i].thread, NULL);
+        done       += ws[i].done;
+        reconnects += ws[i].reconnects;
+        failed     |= ws[i].failed;
+        nlat       += ws[i].nlat;
+    }
+    double elapsed = now_sec() - t0;
+
+    /* pool every thread's samples for the percentiles */
+    double p50 = 0, p99 = 0;
+    double *lat = malloc((nlat ? nlat : 1) * sizeof *lat);
+    if (lat && nlat) {
+        size_t k = 0;
+        for (int i = 0; i < threads; i++) {
+            memcpy(lat + k, ws[i].lat, ws[i].nlat * sizeof *lat);
+            k += ws[i].nlat;
+        }
+        qsort(lat, nlat, sizeof *lat, cmp_double);
+        p50 = lat[nlat / 2];
+        p99 = lat[nlat * 99 / 100];
+    }
+
+    printf("%-22s conns=%-4d depth=%-3d %10.0f req/s  p50=%.2fms p99=%.2fms  reconnects=%llu%s\n",
+           label ? label : "http_load", conns, depth, done / elapsed,
+           p50 * 1e3, p99 * 1e3,
+           (unsigned long long)reconnects, failed ? "  (connection errors)" : "");
+    for (int i = 0; i < threads; i++)
+        free(ws[i].lat);
+    free(lat);
+    free(ws);
+    return failed;
+}
@@ -0,0 +1,65 @@
+#!/usr/bin/env bash
+# Socket I/O backend: libuv streams (--io uv) against the native io_uring
+# path (--io uring), same keys and load, at a few connection counts.
+# Prints req/s and the p50/p99 pipelined-batch round trip for each, then
+# socket write calls per request from /metrics (below 1 once responses to
+# pipelined requests are written together).
+# Both runs use one event loop unless THREADS says otherwise.
+set -e
+ROOT="$( cd -- "$(dirname -- "${BASH_SOURCE[0]}")/../.." &>/dev/null && pwd )"
+BIN=${BIN:-$ROOT/ramforge}
+CLIENT=${CLIENT:-$ROOT/tests/bench/http_load}
+CONNS_LIST=${CONNS_LIST:-"16 64 256"}
+KEYS=${KEYS:-1000}
+SECONDS_PER_RUN=${SECONDS_PER_RUN:-5}
+DEPTH=${DEPTH:-16}
+THREADS=${THREADS:-1}
+[[ -x "$BIN" ]] || { echo "❌ ramforge binary not found"; exit 1; }
+
+ulimit -n "$(ulimit -Hn)" 2>/dev/null || true
+WORK=$(mktemp -d); trap 'rm -rf "$WORK"' EXIT
+cd "$WORK"
+
+wait_up() {
+    for _ in $(seq 50); do
+        curl -s -o /dev/null http://localhost:1109/health && return 0
+        sleep 0.1
+    done
+    echo "❌ server did not come up"; return 1
+}
+
+# populate once; every run replays the same AOF
+"$BIN" --workers 0 >/dev/null 2>&1 &
+PID=$!
+wait_up
+for i in $(seq 1 "$KEYS"); do
+    curl -s -o /dev/null -XPOST -d "{\"id\":$i,\"name\":\"user_$i\"}" http://localhost:1109/users
+done
+kill "$PID"; wait "$PID" 2>/dev/null || true
+cp append.aof seed.aof
+
+http_counter() {   # name → value from the "http" block of /metrics
+    curl -s http://localhost:1109/metrics | grep -o "\"$1\":[0-9]*" | tail -1 | cut -d: -f2
+}
+
+run() {   # label, conns, server args...
+    local label=$1 conns=$2; shift 2
+    rm -f append.aof* dump.rdb*; cp seed.aof append.aof
+    "$BIN" "$@" >/dev/null 2>&1 &
+    local pid=$!
+    wait_up
+    local r0 w0 r1 w1
+    r0=$(http_counter requests); w0=$(http_counter writes)
+    HTTP_LOAD_LABEL="$label" "$CLIENT" 1109 1 "$conns" "$SECONDS_PER_RUN" "$DEPTH" "$KEYS" || true
+    r1=$(http_counter requests); w1=$(http_counter writes)
+    awk -v r=$((r1 - r0)) -v w=$((w1 - w0)) \
+        'BEGIN { printf "%-22s writes/request=%.3f\n", "", r ? w / r : 0 }'
+    kill "$pid"; wait "$pid" 2>/dev/null || true
+}
+
+for c in $CONNS_LIST; do
+    run "io=uv"    "$c" --workers 0 --threads "$THREADS" --io uv
+    run "io=uring" "$c" --workers 0 --threads "$THREADS" --io uring
+    echo
+done
+exit 0
@@ -0,0 +1,56 @@
+#!/usr/bin/env bash
+# Throughput per core count: forked workers (--workers N) against one
+# process with N event-loop threads (--workers 0 --threads N).  Both serve
+# the same keys, replayed from one AOF written up front.  Core counts
+# above nproc are skipped; the client shares the machine with the server.
+set -e
+ROOT="$( cd -- "$(dirname -- "${BASH_SOURCE[0]}")/../.." &>/dev/null && pwd )"
+BIN=${BIN:-$ROOT/ramforge}
+CLIENT=${CLIENT:-$ROOT/tests/bench/http_load}
+CORES=${CORES:-"1 2 4 8 16 32 64"}
+KEYS=${KEYS:-1000}
+SECONDS_PER_RUN=${SECONDS_PER_RUN:-5}
+CONNS=${CONNS:-256}
+DEPTH=${DEPTH:-16}
+[[ -x "$BIN" ]] || { echo "❌ ramforge binary not found"; exit 1; }
+
+ulimit -n "$(ulimit -Hn)" 2>/dev/null || true
+WORK=$(mktemp -d); trap 'rm -rf "$WORK"' EXIT
+cd "$WORK"
+
+wait_up() {
+    for _ in $(seq 50); do
+        curl -s -o /dev/null http://localhost:1109/health && return 0
+        sleep 0.1
+    done
+    echo "❌ server did not come up"; return 1
+}
+
+# populate once; every run replays the same AOF
+"$BIN" --workers 0 >/dev/null 2>&1 &
+PID=$!
+wait_up
+for i in $(seq 1 "$KEYS"); do
+    curl -s -o /dev/null -XPOST -d "{\"id\":$i,\"name\":\"user_$i\"}" http://localhost:1109/users
+done
+kill "$PID"; wait "$PID" 2>/dev/null || true
+cp append.aof seed.aof
+
+run() {   # label, server args...
+    local label=$1 n=$2; shift 2
+    rm -f append.aof* dump.rdb*; cp seed.aof append.aof
+    "$BIN" "$@" >/dev/null 2>&1 &
+    local pid=$!
+    wait_up
+    HTTP_LOAD_LABEL="$label" "$CLIENT" 1109 "$n" "$CONNS" "$SECONDS_PER_RUN" "$DEPTH" "$KEYS" || true
+    kill "$pid"; wait "$pid" 2>/dev/null || true
+}
+
+NPROC=$(nproc)
+for n in $CORES; do
+    [ "$n" -gt "$NPROC" ] && { echo "(skipping $n cores: nproc is $NPROC)"; continue; }
+    run "workers=$n"         "$n" --workers "$n"
+    run "workers=0 threads=$n" "$n" --workers 0 --threads "$n"
+    echo
+done
+exit 0
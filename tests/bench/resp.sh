@@ -0,0 +1,31 @@
+#!/usr/bin/env bash
+# Redis-protocol throughput on --resp-port with the stock redis-benchmark:
+# SET and GET over KEYS random keys, pipelined PIPELINE deep.  redis-cli
+# and client libraries work against the same port.
+set -e
+ROOT="$( cd -- "$(dirname -- "${BASH_SOURCE[0]}")/../.." &>/dev/null && pwd )"
+BIN=${BIN:-$ROOT/ramforge}
+KEYS=${KEYS:-10000}
+REQUESTS=${REQUESTS:-1000000}
+CONNS=${CONNS:-50}
+PIPELINE=${PIPELINE:-16}
+RESP_PORT=${RESP_PORT:-6380}
+[[ -x "$BIN" ]] || { echo "❌ ramforge binary not found"; exit 1; }
+command -v redis-benchmark >/dev/null || { echo "⏭️  redis-benchmark not installed, skipping RESP bench"; exit 0; }
+
+ulimit -n "$(ulimit -Hn)" 2>/dev/null || true
+WORK=$(mktemp -d); trap 'rm -rf "$WORK"' EXIT
+cd "$WORK"
+
+"$BIN" --workers 0 --resp-port "$RESP_PORT" >/dev/null 2>&1 &
+PID=$!
+for _ in $(seq 50); do
+    curl -s -o /dev/null http://localhost:1109/health && break
+    sleep 0.1
+done
+
+redis-benchmark -p "$RESP_PORT" -t set,get -n "$REQUESTS" -c "$CONNS" \
+                -P "$PIPELINE" -r "$KEYS" -q || true
+
+kill "$PID"; wait "$PID" 2>/dev/null || true
+exit 0
@@ -0,0 +1,75 @@
+// compile with:
+//   gcc -O2 -pthread -Isrc -o tests/bench/slab_frag tests/bench/slab_frag.c src/slab_alloc.c src/storage.c src/hugepage.c src/numa_topo.c
+//
+// usage: slab_frag [users]
+//
+// Fragmentation report: bytes spent per stored User.  "before" models
+// the previous allocator (power-of-two classes from 64 B, 8-byte block
+// header); "after" asks the live allocator via slab_usable_size().
+// The RSS line is measured and includes the Storage table itself.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../../src/slab_alloc.h"
+#include "../../src/storage.h"
+#include "../../src/user.h"
+
+#define SLAB_PAGE (64 * 1024)
+
+static size_t rss_bytes(void)
+{
+    long pages = 0, rss = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (f) { if (fscanf(f, "%ld %ld", &pages, &rss) != 2) rss = 0; fclose(f); }
+    return (size_t)rss * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+/* block stride of the old scheme, page slack included */
+static double legacy_per_object(size_t size)
+{
+    size_t cls = 64;
+    while (cls < size) cls *= 2;
+    size_t stride = cls + 8;
+    size_t per_page = (SLAB_PAGE - 16) / stride;
+    return (double)SLAB_PAGE / (double)per_page;
+}
+
+static void sum_cb(int id, const void *data, size_t size, void *ud)
+{
+    (void)id; (void)size;
+    *(size_t *)ud += slab_usable_size(data);
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    slab_init();
+
+    size_t rss0 = rss_bytes();
+    Storage st; storage_init(&st);
+    for (int i = 0; i < n; i++) {
+        User u = { .id = i };
+        snprintf(u.name, sizeof u.name, "user-%d", i);
+        storage_save(&st, i, &u, sizeof u);
+    }
+    size_t rss1 = rss_bytes();
+
+    size_t blocks = 0;
+    storage_iterate(&st, sum_cb, &blocks);
+    double block = (double)blocks / n;
+    size_t per_page = (SLAB_PAGE - 64) / (size_t)block;
+
+    printf("users             : %d  (payload %zu B each)\n", n, sizeof(User));
+    printf("before  block+hdr : %6.1f B/user  (%.0f%% overhead)\n",
+           legacy_per_object(sizeof(User)),
+           100.0 * (legacy_per_object(sizeof(User)) / sizeof(User) - 1));
+    printf("after   block     : %6.1f B/user  (%.0f%% overhead)\n",
+           (double)SLAB_PAGE / per_page,
+           100.0 * ((double)SLAB_PAGE / per_page / sizeof(User) - 1));
+    printf("RSS incl. table   : %6.1f B/user\n", (double)(rss1 - rss0) / n);
+
+    storage_destroy(&st);
+    slab_destroy();
+    return 0;
+}
@@ -0,0 +1,95 @@
+// compile with:
+//   gcc -O2 -pthread -Isrc -o tests/bench/slab_stress tests/bench/slab_stress.c src/slab_alloc.c src/hugepage.c src/numa_topo.c
+//
+// usage: slab_stress <slab|malloc> [threads] [ops/thread] [remote%]
+//
+// Each thread churns a private working set of random-sized blocks
+// (16 B … 4 KiB); `remote%` of the frees instead hand the block to the
+// next thread, which releases it (producer/consumer traffic).  In
+// `malloc` mode the system allocator is measured, so jemalloc or
+// mimalloc can be compared by LD_PRELOAD-ing them (see slab_stress.sh).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include "../../src/slab_alloc.h"
+
+#define WORKING_SET 4096
+#define HANDOFF     256
+
+static int    use_slab;
+static int    nthreads = 4;
+static long   nops     = 2000000;
+static int    remote_pct = 10;
+
+static void *volatile handoff[64][HANDOFF];
+
+static inline void *xalloc(size_t n) { return use_slab ? slab_alloc(n) : malloc(n); }
+static inline void  xfree(void *p)   { if (use_slab) slab_free(p); else free(p); }
+
+static void *worker(void *arg)
+{
+    int      me   = (int)(intptr_t)arg;
+    int      peer = (me + 1) % nthreads;
+    uint64_t x    = 0x9E3779B97F4A7C15ull * (uint64_t)(me + 1);
+    void   **set  = calloc(WORKING_SET, sizeof *set);
+
+    for (long i = 0; i < nops; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;           /* xorshift */
+        size_t slot = x % WORKING_SET;
+        size_t sz   = 16u << ((x >> 20) % 9);              /* 16 … 4096 */
+        sz -= (x >> 32) % (sz / 2);
+
+        void *old = set[slot];
+        if (old) {
+            if ((int)((x >> 40) % 100) < remote_pct) {
+                old = __atomic_exchange_n(&handoff[peer][(x >> 48) % HANDOFF],
+                                          old, __ATOMIC_ACQ_REL);
+            }
+            if (old) xfree(old);
+        }
+        char *p = xalloc(sz);
+        p[0] = p[sz - 1] = (char)i;                        /* touch it */
+        set[slot] = p;
+    }
+    for (int s = 0; s < WORKING_SET; s++) xfree(set[s]);
+    free(set);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || (strcmp(argv[1], "slab") && strcmp(argv[1], "malloc"))) {
+        fprintf(stderr, "usage: %s <slab|malloc> [threads] [ops] [remote%%]\n", argv[0]);
+        return 2;
+    }
+    use_slab = !strcmp(argv[1], "slab");
+    if (argc > 2) nthreads   = atoi(argv[2]);
+    if (argc > 3) nops       = atol(argv[3]);
+    if (argc > 4) remote_pct = atoi(argv[4]);
+    if (nthreads < 1 || nthreads > 64) nthreads = 4;
+
+    if (use_slab) slab_init();
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    pthread_t th[64];
+    for (int t = 0; t < nthreads; t++)
+        pthread_create(&th[t], NULL, worker, (void *)(intptr_t)t);
+    for (int t = 0; t < nthreads; t++)
+        pthread_join(th[t], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    for (int t = 0; t < nthreads; t++)
+        for (int i = 0; i < HANDOFF; i++)
+            xfree(handoff[t][i]);
+    if (use_slab) slab_destroy();
+
+    double sec = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("%-10s threads=%-3d remote=%2d%%  %8.2f Mops/s  (%.3f s)\n",
+           getenv("SLAB_BENCH_LABEL") ? getenv("SLAB_BENCH_LABEL") : argv[1],
+           nthreads, remote_pct, (double)nthreads * (double)nops / sec / 1e6, sec);
+    return 0;
+}
@@ -0,0 +1,26 @@
+#!/usr/bin/env bash
+# Multithreaded alloc/free stress: slab_alloc vs glibc, jemalloc, mimalloc.
+# jemalloc / mimalloc are LD_PRELOADed when found (or set JEMALLOC= / MIMALLOC=).
+set -e
+BIN=${BIN:-tests/bench/slab_stress}
+OPS=${OPS:-2000000}
+
+find_lib() {
+    for p in /usr/lib/x86_64-linux-gnu /usr/lib64 /usr/lib /usr/local/lib; do
+        ls "$p"/lib$1.so* 2>/dev/null | head -1 && return
+    done
+}
+JEMALLOC=${JEMALLOC:-$(find_lib jemalloc)}
+MIMALLOC=${MIMALLOC:-$(find_lib mimalloc)}
+
+for threads in 1 2 4 8; do
+    for remote in 0 25; do
+        SLAB_BENCH_LABEL=slab  "$BIN" slab   $threads $OPS $remote
+        SLAB_BENCH_LABEL=glibc "$BIN" malloc $threads $OPS $remote
+        [ -n "$JEMALLOC" ] && SLAB_BENCH_LABEL=jemalloc LD_PRELOAD=$JEMALLOC "$BIN" malloc $threads $OPS $remote
+        [ -n "$MIMALLOC" ] && SLAB_BENCH_LABEL=mimalloc LD_PRELOAD=$MIMALLOC "$BIN" malloc $threads $OPS $remote
+    done
+    echo
+done
+[ -z "$JEMALLOC$MIMALLOC" ] && echo "(jemalloc / mimalloc not found – glibc only)"
+exit 0
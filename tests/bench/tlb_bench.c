@@ -0,0 +1,98 @@
+// compile with:
+//   gcc -O2 -pthread -Isrc -o tests/bench/tlb_bench tests/bench/tlb_bench.c src/storage.c src/slab_alloc.c src/hugepage.c src/numa_topo.c
+//
+// usage: tlb_bench <off|thp|explicit> [keys] [lookups]
+//
+// Random GETs over a large Storage, with the table arrays and the slab
+// arena on 4 KiB or 2 MiB pages.  Reports ns/GET and, where the PMU is
+// visible (perf_event_paranoid ≤ 2, not in most VMs), dTLB load misses
+// per GET.  Run once per mode and compare (make bench does).
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#include "../../src/storage.h"
+#include "../../src/slab_alloc.h"
+#include "../../src/hugepage.h"
+#include "../../src/user.h"
+
+static int dtlb_open(void)
+{
+    struct perf_event_attr a;
+    memset(&a, 0, sizeof a);
+    a.size           = sizeof a;
+    a.type           = PERF_TYPE_HW_CACHE;
+    a.config         = PERF_COUNT_HW_CACHE_DTLB |
+                       (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    a.disabled       = 1;
+    a.exclude_kernel = 1;
+    a.exclude_hv     = 1;
+    return (int)syscall(SYS_perf_event_open, &a, 0, -1, -1, 0);
+}
+
+/* kB of anonymous memory the kernel actually backs with huge pages */
+static long anon_huge_kb(void)
+{
+    char line[256];
+    long kb = -1;
+    FILE *f = fopen("/proc/self/smaps_rollup", "r");
+    if (!f) return -1;
+    while (fgets(line, sizeof line, f))
+        if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1) break;
+    fclose(f);
+    return kb;
+}
+
+int main(int argc, char **argv)
+{
+    hugepage_mode_t mode = HUGEPAGE_OFF;
+    if (argc > 1 && !strcmp(argv[1], "thp"))      mode = HUGEPAGE_THP;
+    if (argc > 1 && !strcmp(argv[1], "explicit")) mode = HUGEPAGE_EXPLICIT;
+    int  keys    = argc > 2 ? atoi(argv[2]) : 4000000;
+    long lookups = argc > 3 ? atol(argv[3]) : 10000000;
+
+    hugepage_set_mode(mode);
+    slab_init();
+    Storage st; storage_init(&st);
+    for (int i = 0; i < keys; i++) {
+        User u = { .id = i };
+        storage_save(&st, i, &u, sizeof u);
+    }
+
+    int fd = dtlb_open();
+    uint64_t x = 88172645463325252ull, sink = 0;
+    User u;
+    struct timespec t0, t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (fd >= 0) { ioctl(fd, PERF_EVENT_IOC_RESET, 0); ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); }
+    for (long i = 0; i < lookups; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        sink += (uint64_t)storage_get(&st, (int)(x % (uint64_t)keys), &u, sizeof u);
+    }
+    if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    uint64_t misses = 0;
+    if (fd >= 0 && read(fd, &misses, sizeof misses) != sizeof misses) misses = 0;
+
+    double ns = ((double)(t1.tv_sec - t0.tv_sec) * 1e9 + (double)(t1.tv_nsec - t0.tv_nsec))
+                / (double)lookups;
+    printf("%-9s keys=%d  %6.1f ns/GET  dTLB-miss/GET: ", argc > 1 ? argv[1] : "off",
+           keys, ns);
+    if (fd >= 0) printf("%.3f", (double)misses / (double)lookups);
+    else         printf("n/a (no PMU access)");
+    printf("  AnonHugePages: %ld kB  (found %llu)\n", anon_huge_kb(),
+           (unsigned long long)sink);
+
+    storage_destroy(&st);
+    slab_destroy();
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../src/bin_proto.h"
+#include "../src/aof_batch.h"
+#include "../src/slab_alloc.h"
+#include "check.h"
+
+static char   req[1 << 16];
+static size_t req_len;
+
+static void put_frame(uint8_t op, uint16_t count, const void *payload, size_t len)
+{
+    bin_header_t h = { .len = (uint32_t)len, .op = op, .status = 0, .count = count };
+    memcpy(req + req_len, &h, sizeof h);
+    memcpy(req + req_len + sizeof h, payload, len);
+    req_len += sizeof h + len;
+}
+
+/* the response frame at *off, advancing past it */
+static const char *next_frame(const proto_buf_t *out, size_t *off, bin_header_t *h)
+{
+    CHECK(out->len - *off >= sizeof *h, "short response at %zu", *off);
+    memcpy(h, out->data + *off, sizeof *h);
+    const char *payload = out->data + *off + sizeof *h;
+    *off += sizeof *h + h->len;
+    CHECK(*off <= out->len, "response payload past the end");
+    return payload;
+}
+
+int main(void)
+{
+    const char *aof = "bin_proto_test.aof";
+    unlink(aof);
+    slab_init();
+    Storage st; storage_init(&st);
+    AOF_init(aof, 1024, 10);
+    bin_proto_init(&st);
+
+    /* pipelined: multi-set, multi-get (one id missing), ping, junk op */
+    bin_user_t users[3];
+    memset(users, 0, sizeof users);
+    for (int i = 0; i < 3; i++) {
+        users[i].id = 10 + i;
+        snprintf(users[i].name, sizeof users[i].name, "user_%d", 10 + i);
+    }
+    int32_t ids[3] = { 11, 99, 12 };
+    put_frame(BIN_OP_SET, 3, users, sizeof users);
+    put_frame(BIN_OP_GET, 3, ids, sizeof ids);
+    put_frame(BIN_OP_PING, 0, NULL, 0);
+    put_frame(77, 0, NULL, 0);
+    put_frame(BIN_OP_GET, 2, ids, sizeof ids);      /* count does not match len */
+
+    /* split anywhere: only whole frames are consumed */
+    proto_buf_t out = { 0 };
+    size_t done = 0;
+    for (size_t cut = 1; done < req_len; cut += 37) {
+        size_t end = cut < req_len ? cut : req_len;
+        ssize_t used = bin_proto_process(req + done, end - done, &out);
+        CHECK(used >= 0, "process failed at %zu", done);
+        done += (size_t)used;
+    }
+
+    size_t off = 0;
+    bin_header_t h;
+    next_frame(&out, &off, &h);
+    CHECK(h.op == BIN_OP_SET && h.status == BIN_OK && h.count == 3 && h.len == 0, "SET reply");
+
+    const char *p = next_frame(&out, &off, &h);
+    CHECK(h.op == BIN_OP_GET && h.status == BIN_OK && h.count == 3 &&
+          h.len == 3 * sizeof(bin_entry_t), "GET reply header");
+    bin_entry_t e[3];
+    memcpy(e, p, sizeof e);
+    CHECK(e[0].id == 11 && e[0].found && strcmp(e[0].name, "user_11") == 0, "GET 11");
+    CHECK(e[1].id == 99 && !e[1].found && e[1].name[0] == '\0', "GET 99 (missing)");
+    CHECK(e[2].id == 12 && e[2].found && strcmp(e[2].name, "user_12") == 0, "GET 12");
+
+    next_frame(&out, &off, &h);
+    CHECK(h.op == BIN_OP_PING && h.status == BIN_OK, "PING reply");
+    next_frame(&out, &off, &h);
+    CHECK(h.op == 77 && h.status == BIN_ERR_FRAME, "unknown op");
+    next_frame(&out, &off, &h);
+    CHECK(h.op == BIN_OP_GET && h.status == BIN_ERR_FRAME, "count/len mismatch");
+    CHECK(off == out.len, "%zu stray response bytes", out.len - off);
+
+    /* a frame too long to buffer ends the connection */
+    req_len = 0;
+    bin_header_t huge = { .len = (uint32_t)BIN_MAX_FRAME, .op = BIN_OP_SET, .count = 1 };
+    memcpy(req, &huge, sizeof huge);
+    out.len = 0;
+    CHECK(bin_proto_process(req, sizeof huge, &out) == -1, "oversized frame accepted");
+
+    /* the SET went through the AOF: a replay sees the same users */
+    AOF_shutdown();
+    Storage replay; storage_init(&replay);
+    AOF_init(aof, 1024, 10);
+    AOF_load(&replay);
+    AOF_shutdown();
+    User u;
+    CHECK(replay.size == 3, "replayed %zu users", replay.size);
+    CHECK(storage_get(&replay, 10, &u, sizeof u) && strcmp(u.name, "user_10") == 0, "replay 10");
+
+    free(out.data);
+    unlink(aof);
+    puts("✓ binary protocol frames OK");
+    return 0;
+}
@@ -0,0 +1,12 @@
+// check.h – the unit tests' assertion
+#ifndef TESTS_CHECK_H
+#define TESTS_CHECK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/// Print "FAIL <printf-style message>" and exit(1) unless `cond` holds
+#define CHECK(cond, ...) do { if (!(cond)) { \
+    printf("FAIL " __VA_ARGS__); printf("\n"); exit(1); } } while (0)
+
+#endif // TESTS_CHECK_H
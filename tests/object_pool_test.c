@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../src/object_pool.h"
+#include "check.h"
+
+typedef struct { int dirty; } item_t;
+
+static int made, destroyed, resets;
+
+static void *make(void)         { made++; return calloc(1, sizeof(item_t)); }
+static void  destroy(void *p)   { destroyed++; free(p); }
+static void  reset(void *p)     { resets++; ((item_t *)p)->dirty = 0; }
+
+int main(void) {
+    object_pool_t *pool = object_pool_create(4, make, destroy);
+    object_pool_set_reset(pool, reset);
+
+    /* pre-warming never exceeds the cap */
+    CHECK(object_pool_prewarm(pool, 10) == 4, "prewarm filled past cap");
+    CHECK(made == 4, "prewarm made %d", made);
+
+    /* idle items are hits, the fifth get is a miss */
+    item_t *it[6];
+    for (int i = 0; i < 6; i++) it[i] = object_pool_get(pool);
+    object_pool_stats_t s;
+    object_pool_stats(pool, &s);
+    CHECK(s.hits == 4 && s.misses == 2 && s.idle == 0,
+          "hits %llu misses %llu idle %d",
+          (unsigned long long)s.hits, (unsigned long long)s.misses, s.idle);
+
+    /* released items come back clean; past the cap they are destroyed */
+    for (int i = 0; i < 6; i++) { it[i]->dirty = 1; object_pool_release(pool, it[i]); }
+    object_pool_stats(pool, &s);
+    CHECK(s.idle == 4 && s.drops == 2 && destroyed == 2 && resets == 4,
+          "idle %d drops %llu destroyed %d resets %d",
+          s.idle, (unsigned long long)s.drops, destroyed, resets);
+    CHECK(s.high_water == 4 && s.capacity == 4, "high water %d", s.high_water);
+    for (int i = 0; i < 4; i++) {
+        item_t *x = object_pool_get(pool);
+        CHECK(x->dirty == 0, "reused item not reset");
+        object_pool_release(pool, x);
+    }
+
+    object_pool_destroy(pool);
+    CHECK(destroyed == made, "leaked %d items", made - destroyed);
+    printf("✓ object pool reuse/cap OK\n");
+    return 0;
+}
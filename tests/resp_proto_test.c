@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../src/resp_proto.h"
+#include "../src/user.h"
+#include "../src/aof_batch.h"
+#include "../src/slab_alloc.h"
+#include "check.h"
+
+/* feed `req` cut every `step` bytes; every byte must end up consumed */
+static void run(const char *req, size_t step, proto_buf_t *out)
+{
+    size_t len = strlen(req), done = 0;
+    out->len = 0;
+    for (size_t cut = step; done < len; cut += step) {
+        size_t end = cut < len ? cut : len;
+        ssize_t used = resp_proto_process(req + done, end - done, out);
+        CHECK(used >= 0, "process failed at %zu", done);
+        done += (size_t)used;
+        CHECK(end < len || done == len, "%zu bytes left unparsed", len - done);
+    }
+}
+
+static void expect(const proto_buf_t *out, const char *want, const char *what)
+{
+    CHECK(out->len == strlen(want) && memcmp(out->data, want, out->len) == 0,
+          "%s: got \"%.*s\"", what, (int)out->len, out->data);
+}
+
+int main(void)
+{
+    const char *aof = "resp_proto_test.aof";
+    unlink(aof);
+    slab_init();
+    Storage st; storage_init(&st);
+    AOF_init(aof, 1024, 10);
+    resp_proto_init(&st);
+    proto_buf_t out = { 0 };
+
+    /* pipelined multibulk, split at every size from 1 byte up */
+    const char *req =
+        "*3\r\n$3\r\nSET\r\n$6\r\nuser:1\r\n$5\r\nalice\r\n"
+        "*5\r\n$4\r\nmset\r\n$16\r\nkey:000000000002\r\n$3\r\nbob\r\n$1\r\n3\r\n$5\r\ncarol\r\n"
+        "*2\r\n$3\r\nGET\r\n$1\r\n1\r\n"
+        "*4\r\n$4\r\nMGET\r\n$6\r\nuser:2\r\n$2\r\n99\r\n$1\r\n3\r\n"
+        "*1\r\n$4\r\nPING\r\n"
+        "*2\r\n$3\r\nGET\r\n$4\r\nnope\r\n"
+        "*1\r\n$5\r\nFLUSH\r\n";
+    const char *want =
+        "+OK\r\n"
+        "+OK\r\n"
+        "$5\r\nalice\r\n"
+        "*3\r\n$3\r\nbob\r\n$-1\r\n$5\r\ncarol\r\n"
+        "+PONG\r\n"
+        "-ERR key must end in a user id (0..2147483647)\r\n"
+        "-ERR unknown command 'FLUSH'\r\n";
+    for (size_t step = 1; step <= strlen(req); step++) {
+        run(req, step, &out);
+        expect(&out, want, "pipelined commands");
+    }
+
+    /* inline commands, as typed into telnet */
+    run("get 3\r\nPING hi\nDEL 1 2 99\r\nget 1\r\n", 5, &out);
+    expect(&out, "$5\r\ncarol\r\n$2\r\nhi\r\n:2\r\n$-1\r\n", "inline commands");
+
+    /* SCAN walks the whole table; only user 3 is left */
+    run("*4\r\n$4\r\nSCAN\r\n$1\r\n0\r\n$5\r\nCOUNT\r\n$4\r\n1000\r\n", 1000, &out);
+    expect(&out, "*2\r\n$1\r\n0\r\n*1\r\n$1\r\n3\r\n", "SCAN");
+
+    /* values longer than a user name are refused, not truncated */
+    run("SET 5 aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\r\nGET 5\r\n",
+        1000, &out);
+    expect(&out, "-ERR value longer than 63 bytes\r\n$-1\r\n", "long value");
+
+    /* protocol errors and QUIT close the connection */
+    out.len = 0;
+    CHECK(resp_proto_process("*1\r\n$x\r\n", 9, &out) == -1, "bad bulk length accepted");
+    out.len = 0;
+    CHECK(resp_proto_process("*1\r\n$99999999\r\n", 16, &out) == -1, "oversized bulk accepted");
+    out.len = 0;
+    CHECK(resp_proto_process("QUIT\r\nPING\r\n", 12, &out) == -1, "QUIT kept the connection");
+    expect(&out, "+OK\r\n", "QUIT reply");
+
+    /* the DEL went through the AOF: a replay sees only user 3 */
+    AOF_shutdown();
+    Storage replay; storage_init(&replay);
+    AOF_init(aof, 1024, 10);
+    AOF_load(&replay);
+    AOF_shutdown();
+    User u;
+    CHECK(replay.size == 1, "replayed %zu users", replay.size);
+    CHECK(storage_get(&replay, 3, &u, sizeof u) && strcmp(u.name, "carol") == 0, "replay 3");
+    CHECK(!storage_get(&replay, 1, &u, sizeof u), "deleted user 1 came back");
+
+    free(out.data);
+    unlink(aof);
+    puts("✓ RESP commands OK");
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../src/slab_alloc.h"
+
+#define THREADS 8
+#ifndef ROUNDS
+#define ROUNDS  100000
+#endif
+#define RING    1024
+
+/* producer/consumer rings: every block is freed by a different thread */
+static void *volatile ring[THREADS][RING];
+
+static void *worker(void *arg)
+{
+    int      me   = (int)(intptr_t)arg;
+    int      peer = (me + 1) % THREADS;
+    unsigned seed = (unsigned)me * 2654435761u;
+
+    for (int i = 0; i < ROUNDS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        size_t sz = 8 + (seed >> 8) % 6000;     /* some hit the huge class */
+        unsigned char *p = slab_alloc(sz);
+        if (slab_usable_size(p) < sz) {
+            printf("FAIL usable size %zu < %zu\n", slab_usable_size(p), sz);
+            exit(1);
+        }
+        memset(p, me + 1, sz);
+        p[0] = (unsigned char)(sz & 0xff);
+        p[1] = (unsigned char)(sz >> 8);
+
+        /* hand it to the peer's slot; free whatever was parked there */
+        unsigned char *old = __atomic_exchange_n(&ring[peer][i % RING], p,
+                                                 __ATOMIC_ACQ_REL);
+        if (old) {
+            size_t osz = old[0] | (size_t)old[1] << 8;
+            for (size_t k = 2; k < osz; k++)
+                if (old[k] != old[osz - 1]) {
+                    printf("FAIL corrupted block (thread %d)\n", me);
+                    exit(1);
+                }
+            slab_free(old);
+        }
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    slab_init();
+
+    /* hysteresis: empty pages go back only after N idle passes, minus a reserve */
+    enum { SPIKE = 20000 };
+    static void *spike[SPIKE];
+    for (int i = 0; i < SPIKE; i++) spike[i] = slab_alloc(100);
+    for (int i = 0; i < SPIKE; i++) slab_free(spike[i]);
+    if (slab_trim(3) || slab_trim(3)) { puts("FAIL trim ignored hysteresis"); return 1; }
+    size_t back = slab_trim(3);
+    slab_stats_t s0;
+    slab_stats(&s0);
+    if (!back || s0.cls[6].pages != 1) {       /* 112-byte class keeps one */
+        printf("FAIL spike trim: released %zu, %zu pages left\n", back, s0.cls[6].pages);
+        return 1;
+    }
+
+    pthread_t th[THREADS];
+    for (int r = 0; r < 2; r++) {           /* 2nd round adopts abandoned pages */
+        for (int t = 0; t < THREADS; t++)
+            pthread_create(&th[t], NULL, worker, (void *)(intptr_t)t);
+        for (int t = 0; t < THREADS; t++)
+            pthread_join(th[t], NULL);
+    }
+    for (int t = 0; t < THREADS; t++)
+        for (int i = 0; i < RING; i++)
+            slab_free(ring[t][i]);
+
+    /* everything is free and its owners have exited: trim returns it all */
+    slab_stats_t s;
+    slab_stats(&s);
+    for (unsigned c = 0; c < s.nclasses; c++)
+        if (s.cls[c].live_blocks) {
+            printf("FAIL %zu live blocks in class %zu\n",
+                   s.cls[c].live_blocks, s.cls[c].block_size);
+            return 1;
+        }
+    size_t released = slab_trim(1);
+    slab_stats(&s);
+    for (unsigned c = 0; c < s.nclasses; c++)
+        if (s.cls[c].pages != (c == 6)) {  /* only main's reserve page */
+            puts("FAIL pages left after trim"); return 1;
+        }
+    if (!released || s.pages_idle != released || s.huge_blocks) {
+        puts("FAIL trim accounting"); return 1;
+    }
+    slab_destroy();
+    puts("✓ slab cross-thread alloc/free OK");
+    return 0;
+}
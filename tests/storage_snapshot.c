@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/storage.h"
+#include "../src/slab_alloc.h"
+
+#define N 20000
+
+/* what the snapshot reader saw, indexed by id */
+static int seen_val[4 * N];
+static int seen_cnt[4 * N];
+
+static void collect_cb(int id, const void *data, size_t size, void *ud)
+{
+    (void)ud;
+    if (!data) { seen_cnt[id]++; seen_val[id] = -2; return; }  /* tombstone */
+    if (size != sizeof(int)) return;
+    seen_cnt[id]++;
+    memcpy(&seen_val[id], data, sizeof(int));
+}
+
+int main(void)
+{
+    slab_init();
+    Storage st; storage_init(&st);
+    for (int id = 0; id < N; id++) {
+        int v = id * 10;
+        storage_save(&st, id, &v, sizeof v);
+    }
+
+    if (storage_snapshot_begin(&st) != 0) { puts("FAIL begin"); return 1; }
+    if (storage_snapshot_begin(&st) == 0) { puts("FAIL overlap allowed"); return 1; }
+
+    /* interleave reader steps with writes that overwrite, delete and
+       insert enough new keys to force several rehashes mid-snapshot */
+    int step = 0, more = 1, next_new = N;
+    while (more) {
+        more = storage_snapshot_step(&st, collect_cb, NULL, 97);
+        int v = -1;
+        storage_save(&st, (step * 7) % N, &v, sizeof v);
+        storage_remove(&st, (step * 13 + 5) % N);
+        for (int k = 0; k < 8; k++, next_new++)
+            storage_save(&st, next_new, &next_new, sizeof next_new);
+        step++;
+    }
+    storage_snapshot_end(&st);
+
+    for (int id = 0; id < 4 * N; id++) {
+        int want_cnt = id < N;
+        if (seen_cnt[id] != want_cnt ||
+            (want_cnt && seen_val[id] != id * 10)) {
+            printf("FAIL id %d seen %d× value %d\n", id, seen_cnt[id], seen_val[id]);
+            return 1;
+        }
+    }
+
+    /* live table still reflects the writes */
+    int v;
+    if (!storage_get(&st, next_new - 1, &v, sizeof v) || v != next_new - 1) {
+        puts("FAIL live view"); return 1;
+    }
+    printf("✓ point-in-time snapshot OK (%d steps, %d live inserts)\n",
+           step, next_new - N);
+
+    /* delta: only keys touched since the last checkpoint, removals as tombstones */
+    storage_dirty_reset(&st);
+    memset(seen_cnt, 0, sizeof seen_cnt);
+    v = 42;
+    storage_save(&st, 3, &v, sizeof v);
+    storage_save(&st, 3, &v, sizeof v);             /* dedup'd */
+    storage_save(&st, 4 * N - 1, &v, sizeof v);     /* new key  */
+    storage_remove(&st, next_new - 2);
+    if (storage_dirty_count(&st) != 3) { puts("FAIL dirty count"); return 1; }
+
+    size_t nk;
+    int *keys = storage_dirty_take(&st, &nk);
+    if (nk != 3 || storage_dirty_count(&st) != 0) { puts("FAIL dirty take"); return 1; }
+    storage_snapshot_begin_keys(&st, keys, nk);
+    storage_save(&st, 3, &(int){7}, sizeof(int));   /* after begin: not seen */
+    while (storage_snapshot_step(&st, collect_cb, NULL, 1)) {}
+    storage_snapshot_end(&st);
+
+    if (seen_cnt[3] != 1 || seen_val[3] != 42 ||
+        seen_cnt[4 * N - 1] != 1 || seen_cnt[next_new - 2] != 1 || seen_val[next_new - 2] != -2) {
+        puts("FAIL delta snapshot"); return 1;
+    }
+    if (storage_dirty_count(&st) != 1) { puts("FAIL next interval"); return 1; }
+
+    /* removed, then saved again in the same interval (a rehash between):
+       the key is listed once */
+    storage_dirty_reset(&st);
+    storage_remove(&st, 3);
+    for (int id = 4 * N; id < 6 * N; id++) storage_save(&st, id, &id, sizeof id);
+    storage_save(&st, 3, &v, sizeof v);
+    if (storage_dirty_count(&st) != 2 * N + 1) {
+        printf("FAIL re-save listed twice (%zu dirty)\n", storage_dirty_count(&st)); return 1;
+    }
+
+    storage_destroy(&st);
+    puts("✓ delta snapshot OK");
+
+    /* save/remove churn over new ids, checkpointed now and then:
+       tombstones count toward the load factor and are purged, so lookups
+       still meet EMPTY slots and the table does not keep growing */
+    Storage ch; storage_init(&ch);
+    for (int id = 0; id < 100000; id++) {
+        storage_save(&ch, id, &id, sizeof id);
+        storage_remove(&ch, id);
+        if (id % 1000 == 999) storage_dirty_reset(&ch);
+    }
+    size_t empty = 0;
+    for (size_t i = 0; i < ch.capacity; i++)
+        empty += (ch.flags[i] & BUCKET_STATE) == BUCKET_EMPTY;
+    if (ch.size != 0 || empty == 0 || ch.capacity > 4096) {
+        printf("FAIL churn: %zu empty of %zu\n", empty, ch.capacity); return 1;
+    }
+    storage_destroy(&ch);
+
+    /* SCAN cursor: every key present throughout is seen, across rehashes */
+    Storage sc; storage_init(&sc);
+    for (int id = 0; id < N; id++) storage_save(&sc, id, &id, sizeof id);
+    memset(seen_cnt, 0, sizeof seen_cnt);
+    size_t cursor = 0;
+    int calls = 0;
+    next_new = N;
+    do {
+        cursor = storage_scan(&sc, cursor, 5, collect_cb, NULL);
+        for (int k = 0; k < 4 && next_new < 4 * N; k++, next_new++)
+            storage_save(&sc, next_new, &next_new, sizeof next_new);
+        calls++;
+    } while (cursor != 0);
+    for (int id = 0; id < N; id++) {
+        if (seen_cnt[id] < 1) { printf("FAIL scan missed %d\n", id); return 1; }
+    }
+    storage_destroy(&sc);
+    printf("✓ resize-safe scan OK (%d calls, table grew to %d keys)\n", calls, next_new);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../src/timer_wheel.h"
+#include "check.h"
+
+typedef struct {
+    timer_wheel_entry_t timer;   /* first member: the entry is the object */
+    int                 fired_at;
+} conn_t;
+
+static timer_wheel_t wheel;
+static int tick_no;
+
+static void on_expire(timer_wheel_entry_t *e) { ((conn_t *)e)->fired_at = tick_no; }
+
+int main(void) {
+    timer_wheel_init(&wheel, 100);
+    static conn_t c[4];
+
+    timer_wheel_schedule(&wheel, &c[0].timer, 250, on_expire);     /* 3 ticks */
+    timer_wheel_schedule(&wheel, &c[1].timer, 100 * (TIMER_WHEEL_SLOTS + 2), on_expire);
+    timer_wheel_schedule(&wheel, &c[2].timer, 500, on_expire);
+    timer_wheel_schedule(&wheel, &c[3].timer, 0, on_expire);       /* next tick */
+    CHECK(wheel.pending == 4, "pending %llu", (unsigned long long)wheel.pending);
+
+    /* re-arming moves the deadline; cancel twice is harmless */
+    timer_wheel_schedule(&wheel, &c[2].timer, 700, on_expire);
+    timer_wheel_cancel(&wheel, &c[3].timer);
+    timer_wheel_cancel(&wheel, &c[3].timer);
+    CHECK(!timer_wheel_pending(&c[3].timer), "cancelled entry still pending");
+
+    for (tick_no = 1; tick_no <= TIMER_WHEEL_SLOTS + 3; tick_no++)
+        timer_wheel_tick(&wheel);
+
+    CHECK(c[0].fired_at == 3, "c0 fired at %d", c[0].fired_at);
+    CHECK(c[2].fired_at == 7, "c2 fired at %d", c[2].fired_at);
+    CHECK(c[3].fired_at == 0, "cancelled c3 fired");
+    /* same slot as tick 2, but one lap later */
+    CHECK(c[1].fired_at == TIMER_WHEEL_SLOTS + 2, "c1 fired at %d", c[1].fired_at);
+    CHECK(wheel.pending == 0, "pending %llu", (unsigned long long)wheel.pending);
+
+    puts("✓ timer wheel deadlines/laps/cancel OK");
+    return 0;
+}